@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace love
+{
+    // Buffer allocator for Data objects. Requests up to MAX_POOLED_SIZE are rounded up to a
+    // power-of-two size class and recycled through a per-thread cache backed by shared freelists,
+    // so short-lived buffers rarely reach the system allocator. Larger requests go straight to it.
+    class Allocator
+    {
+      public:
+        // Every block is aligned to MIN_ALIGNMENT. Blocks of SIMD_ALIGNMENT bytes or more, and
+        // all large blocks, are aligned to SIMD_ALIGNMENT.
+        static constexpr size_t MIN_ALIGNMENT  = 16;
+        static constexpr size_t SIMD_ALIGNMENT = 64;
+
+        static constexpr size_t MIN_CLASS_SIZE  = 16;
+        static constexpr size_t MAX_POOLED_SIZE = 64 * 1024;
+
+        struct Stats
+        {
+            uint64_t allocations;
+            uint64_t cacheHits;
+            uint64_t largeAllocations;
+            uint64_t bytesInUse;
+            uint64_t bytesCached;
+        };
+
+        // Throws love::Exception when out of memory. Unless `clear` is set the contents are
+        // unspecified, and may hold whatever a previous user of the block left there.
+        static void* allocate(size_t size, bool clear = false);
+
+        // `size` must be the size that was passed to allocate().
+        static void deallocate(void* block, size_t size);
+
+        static Stats getStats();
+
+        // Returns the blocks cached by the shared freelists and the calling thread to the system.
+        static void trim();
+    };
+} // namespace love
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace love
+{
+    // A fixed set of worker threads for splitting CPU-bound work (hashing, compression) into
+    // independent pieces. Workers are started on first use and joined at exit.
+    class ThreadPool
+    {
+      public:
+        using Task = std::function<void(size_t index)>;
+
+        static ThreadPool& getInstance();
+
+        ~ThreadPool();
+
+        // Number of threads that run tasks, including the calling thread.
+        size_t getConcurrency() const
+        {
+            return this->workers.size() + 1;
+        }
+
+        // Runs task(0) .. task(count - 1), blocking until all have finished. The calling thread
+        // takes part. The first exception thrown by a task is rethrown here once the rest are
+        // done. Calls made from inside a task run serially.
+        void parallelFor(size_t count, const Task& task);
+
+      private:
+        // Lives on the submitting thread's stack for the duration of parallelFor.
+        struct Job
+        {
+            const Task* task;
+            size_t count;
+            std::atomic<size_t> nextIndex;
+            size_t workers;
+            std::exception_ptr exception;
+        };
+
+        ThreadPool(size_t workerCount);
+
+        void workerMain();
+
+        void runTasks(Job& job);
+
+        std::vector<std::thread> workers;
+
+        std::mutex mutex;
+        std::mutex submitMutex;
+        std::condition_variable wakeCondition;
+        std::condition_variable doneCondition;
+
+        Job* job;
+        uint64_t generation;
+        bool stopping;
+    };
+} // namespace love
@@ -47,16 +47,44 @@ namespace love
             size_t length;
         };
 
+        // Owns every table converted from one Lua value, allocated from shared chunks and freed
+        // together once no Variant refers to any of them. Variants stored inside one of its
+        // tables refer to their nested tables without a reference of their own, which would
+        // keep it alive forever, but copies of them always take one.
         class SharedTable : public Object
         {
           public:
-            SharedTable()
-            {}
+            struct Table
+            {
+                // Values of the keys 1 to arrayLength, where missing ones are nil.
+                Variant* array;
+                size_t arrayLength;
+
+                // Every other key.
+                std::pair<Variant, Variant>* pairs;
+                size_t pairCount;
+
+                SharedTable* shared;
+                Table* next;
+            };
+
+            SharedTable();
+
+            virtual ~SharedTable();
+
+            Table* newTable(size_t arrayLength);
 
-            virtual ~SharedTable()
-            {}
+            // Moves `count` pairs into storage owned by `table`.
+            void setPairs(Table* table, std::pair<Variant, Variant>* pairs, size_t count);
 
-            std::vector<std::pair<Variant, Variant>> pairs;
+          private:
+            void* allocate(size_t size);
+
+            std::vector<std::pair<char*, size_t>> chunks;
+            char* cursor;
+            size_t remaining;
+
+            Table* tables;
         };
 
         union Data
@@ -66,7 +94,11 @@ namespace love
             SharedString* string;
             void* userdata;
             Proxy proxy;
-            SharedTable* table;
+            struct
+            {
+                SharedTable* shared;
+                const SharedTable::Table* table;
+            } table;
             struct
             {
                 char str[MAX_SMALL_STRING_LENGTH];
@@ -88,16 +120,20 @@ namespace love
 
         Variant(void* lightuserdata);
 
-        Variant(SharedTable* table);
+        // Retains `shared` unless it is nullptr, which is only for Variants stored inside a
+        // table of the same SharedTable. Copies retain the table's SharedTable either way.
+        Variant(SharedTable* shared, const SharedTable::Table* table);
 
         Variant(const Variant& other);
 
-        Variant(Variant&& other);
+        Variant(Variant&& other) noexcept;
 
         ~Variant();
 
         Variant& operator=(const Variant& other);
 
+        Variant& operator=(Variant&& other) noexcept;
+
         Type getType() const
         {
             return this->type;
@@ -7,8 +7,28 @@
 
 namespace love
 {
+    enum Base64Alphabet
+    {
+        // RFC 4648 section 4: '+' and '/', padded with '='.
+        BASE64_STANDARD,
+        // RFC 4648 section 5: '-' and '_', written without padding.
+        BASE64_URL
+    };
+
+    // Number of characters b64_encode produces, including line breaks.
+    size_t b64_encoded_size(size_t sourceLength, size_t lineLength,
+                            Base64Alphabet alphabet = BASE64_STANDARD);
+
+    // Writes exactly b64_encoded_size() characters to `destination`.
+    void b64_encode_into(const char* source, size_t sourceLength, size_t lineLength,
+                         char* destination, Base64Alphabet alphabet = BASE64_STANDARD);
+
     char* b64_encode(const char* source, size_t sourceLength, size_t lineLength,
-                     size_t& destinationLength);
+                     size_t& destinationLength, Base64Alphabet alphabet = BASE64_STANDARD);
 
-    char* b64_decode(const char* source, size_t sourceLength, size_t& size);
+    // Lenient decoding skips every character outside the alphabet, including misplaced padding.
+    // Strict decoding only allows line breaks besides the alphabet, requires correct padding
+    // (optional for BASE64_URL) and throws on anything else.
+    char* b64_decode(const char* source, size_t sourceLength, size_t& size,
+                     Base64Alphabet alphabet = BASE64_STANDARD, bool strict = false);
 } // namespace love
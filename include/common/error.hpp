@@ -9,6 +9,7 @@ namespace love
 
 // General
 #define E_OUT_OF_MEMORY "Out of memory."
+#define E_TABLE_CYCLE   "Tables that contain themselves cannot be {}."
 // Filesystem
 #define E_PHYSFS_NOT_INITIALIZED     "PHYSFS is not initialized."
 #define E_DATA_NOT_WRITTEN           "Data could not be written."
@@ -31,10 +32,49 @@ namespace love
     "Offset and size arguments must fit within the given Data's size."
 #define E_DATAVIEW_INVALID_SIZE           "DataView size mn ust be greater than 0."
 #define E_HASH_FUNCTION_NOT_SUPPORTED     "Hash function not supported by "
+#define E_HASHER_ALREADY_FINISHED         "Hasher has already been finished."
 #define E_INVALID_COMPRESSION_FORMAT_LZ4  "Invalid format (expecting LZ4)."
 #define E_COULD_NOT_LZ4_DECOMPRESS_DATA   "Could not decompress LZ4-compressed data."
 #define E_INVALID_COMPRESSION_FORMAT_ZLIB "Invalid format (expecting zlib or gzip)."
+#define E_COULD_NOT_ZLIB_DECOMPRESS_DATA  "Could not decompress zlib/gzip-compressed data."
+#define E_INVALID_COMPRESSION_FORMAT_ZSTD "Invalid format (expecting zstd)."
+#define E_DICTIONARY_NOT_SUPPORTED        "The {} format does not support compression dictionaries."
+#define E_DICTIONARY_FORMAT_MISMATCH      "Compression dictionary was made for a different format."
+#define E_COMPRESSION_STREAM_FINISHED     "Compression stream has already been finished."
+#define E_COMPRESSED_STREAM_TRUNCATED     "Compressed data ended before the end of the stream."
+#define E_DECOMPRESS_DESTINATION_TOO_SMALL \
+    "Decompressed data does not fit in the destination."
 #define E_DATA_PACK_OFFSET_FORMAT_PARAMS \
     "The given byte offset and pack format parameters do not fit within the ByteData's size."
 #define E_DATA_SIZE_MUST_BE_POSITIVE "Data size must be a positive number."
+#define E_INVALID_BASE64_CHARACTER   "Invalid base64 character at offset {}."
+#define E_INVALID_BASE64_PADDING     "Invalid or missing base64 padding."
+#define E_INVALID_HEX_CHARACTER      "Invalid hex character at offset {}."
+#define E_INVALID_HEX_LENGTH         "Hex input has an odd number of digits."
+#define E_ENCODE_DESTINATION_TOO_SMALL \
+    "Encoded data does not fit in the destination."
+#define E_ENCODE_SOURCE_OVERLAPS "Encoded data cannot overwrite the data being encoded."
+#define E_INVALID_RECORD_LAYOUT         "The key must fit within the record stride."
+#define E_TOO_MANY_RECORDS              "Too many records to sort."
+#define E_INVALID_PACK_OPTION           "Invalid format option '{}'."
+#define E_PACK_INTEGER_SIZE             "Integral size ({}) out of limits [1,{}]."
+#define E_PACK_MISSING_CHAR_SIZE        "Missing size for format option 'c'."
+#define E_PACK_INVALID_ALIGN_OPTION     "Invalid next option for format option 'X'."
+#define E_PACK_ALIGNMENT_NOT_POWER_OF_2 "Format asks for alignment not power of 2."
+#define E_PACK_FORMAT_TOO_LARGE         "Format result too large."
+#define E_TABLE_ELEMENT_NOT_NUMBER      "Expected a number at index %d of the table."
+#define E_ARRAYS_PARTIALLY_OVERLAP      "The target must not partially overlap a source array."
+#define E_UNPACK_DATA_TOO_SHORT \
+    "The given byte offset and pack format do not fit within the Data's size."
+#define E_UNPACK_INTEGER_TOO_LARGE "%d-byte integer does not fit into 64 bits."
+#define E_SERIALIZE_UNSUPPORTED_TYPE \
+    "Only nil, booleans, numbers, strings and tables can be serialized."
+#define E_SERIALIZE_TOO_DEEP      "Tables nested more than {} levels deep cannot be serialized."
+#define E_SERIALIZED_DATA_INVALID "Invalid or corrupted serialized data."
+#define E_JSON_SYNTAX             "Invalid JSON at offset {}."
+#define E_JSON_TOO_DEEP           "JSON cannot be nested more than {} levels deep."
+#define E_JSON_TOO_LARGE          "JSON text must be smaller than 4 GB."
+#define E_JSON_INVALID_NUMBER     "NaN and infinity cannot be encoded as JSON."
+#define E_JSON_INVALID_KEY        "JSON object keys must be strings or numbers."
+#define E_JSON_UNSUPPORTED_TYPE   "Values of type {} cannot be encoded as JSON."
 } // namespace love
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stddef.h>
+
+namespace love
+{
+    // Writes exactly sourceLength * 2 characters to `destination`.
+    void hex_encode_into(const char* source, size_t sourceLength, char* destination,
+                         bool uppercase = false);
+
+    char* hex_encode(const char* source, size_t sourceLength, size_t& destinationLength,
+                     bool uppercase = false);
+
+    // Accepts either case and an optional "0x" prefix. Lenient decoding reads invalid characters
+    // as 0 and an odd final digit as the high nibble. Strict decoding throws on both, naming the
+    // offset of the first invalid character.
+    char* hex_decode(const char* source, size_t sourceLength, size_t& size, bool strict = false);
+} // namespace love
@@ -19,7 +19,6 @@ extern "C"
 
 #include <algorithm>
 #include <exception>
-#include <set>
 #include <span>
 
 #include <cstdarg>
@@ -217,8 +216,7 @@ namespace love
 
     void luax_pushvariant(lua_State* L, const Variant& v);
 
-    Variant luax_checkvariant(lua_State* L, int index, bool allowuserdata = true,
-                              std::set<const void*>* tableSet = nullptr);
+    Variant luax_checkvariant(lua_State* L, int index, bool allowuserdata = true);
 
     int luax_convobj(lua_State* L, int index, const char* module, const char* function);
 
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <bitset>
+#include <string_view>
 
 #include <stdint.h>
 
@@ -11,41 +11,94 @@ namespace love
       public:
         static constexpr uint32_t MAX_TYPES = 0x80;
 
-        Type(const char* name, Type* parent);
+        // Every type exposed to Lua. IDs and ancestry are fixed at compile time, so each Type is
+        // constant-initialized and isA() is a single bit test with no lazy setup.
+        enum Id
+        {
+            ID_INVALID,
+            ID_OBJECT,
+            ID_DATA,
+            ID_BYTE_DATA,
+            ID_CHAINED_DATA,
+            ID_COMPRESSED_DATA,
+            ID_COMPRESSION_DICTIONARY,
+            ID_COMPRESSION_STREAM,
+            ID_DATA_VIEW,
+            ID_FILE,
+            ID_FILE_DATA,
+            ID_HASHER,
+            ID_MODULE,
+            ID_PACK_FORMAT,
+            ID_STREAM,
+            ID_MAX_ENUM
+        };
+
+        // The only record of each type's parent.
+        static constexpr Id getParentId(Id id)
+        {
+            switch (id)
+            {
+                case ID_DATA:
+                case ID_COMPRESSION_STREAM:
+                case ID_HASHER:
+                case ID_MODULE:
+                case ID_PACK_FORMAT:
+                case ID_STREAM:
+                    return ID_OBJECT;
+                case ID_BYTE_DATA:
+                case ID_CHAINED_DATA:
+                case ID_COMPRESSED_DATA:
+                case ID_COMPRESSION_DICTIONARY:
+                case ID_DATA_VIEW:
+                case ID_FILE_DATA:
+                    return ID_DATA;
+                case ID_FILE:
+                    return ID_STREAM;
+                default:
+                    return ID_INVALID;
+            }
+        }
+
+        constexpr Type(const char* name, Id id) :
+            name(name),
+            id(id),
+            bits {}
+        {
+            for (Id type = id; type != ID_INVALID; type = getParentId(type))
+                this->bits[type / 64] |= (uint64_t)1 << (type % 64);
+        }
 
         Type(const Type&) = delete;
 
-        static Type* byName(const char* name);
+        static Type* byName(std::string_view name);
 
+        // Makes the type and its ancestors available to byName(). Ancestors are always one of
+        // the base types every other derives from.
         void initialize();
 
-        uint32_t getId();
+        constexpr uint32_t getId() const
+        {
+            return this->id;
+        }
 
         const char* getName() const;
 
-        bool isA(const uint32_t& id)
+        constexpr bool isA(uint32_t id) const
         {
-            if (!this->initialized)
-                this->initialize();
-
-            return this->bits[id];
+            return (this->bits[id / 64] >> (id % 64)) & 1;
         }
 
-        bool isA(const Type& other)
+        constexpr bool isA(const Type& other) const
         {
-            if (!this->initialized)
-                this->initialize();
-
-            return this->bits[other.id];
+            return this->isA(other.id);
         }
 
       private:
         const char* const name;
-        Type* const parent;
-
-        uint32_t id;
-        bool initialized;
 
-        std::bitset<MAX_TYPES> bits;
+        const uint32_t id;
+        uint64_t bits[MAX_TYPES / 64];
     };
+
+    static_assert(Type::ID_MAX_ENUM <= Type::MAX_TYPES);
 } // namespace love
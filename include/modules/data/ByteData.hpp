@@ -28,9 +28,12 @@ namespace love
         size_t getSize() const override;
 
       private:
-        void create();
+        void create(bool clear = false);
 
         char* data;
         size_t size;
+
+        // Buffers handed over by the owning constructor came from new[], not the Allocator.
+        bool adopted;
     };
 } // namespace love
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "common/Data.hpp"
+#include "common/StrongRef.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace love
+{
+    // A sequence of byte ranges in other Data objects, read as if it were one buffer. Appending
+    // and slicing only copy references, and everything but getData() reads the segments in place.
+    class ChainedData : public Data
+    {
+      public:
+        static Type type;
+
+        struct Segment
+        {
+            StrongRef<Data> data;
+            size_t offset;
+            size_t size;
+
+            const char* getBytes() const
+            {
+                return (const char*)this->data->getData() + this->offset;
+            }
+        };
+
+        ChainedData();
+
+        ChainedData(const ChainedData& other);
+
+        virtual ~ChainedData();
+
+        ChainedData* clone() const override;
+
+        // Copies the segments into one buffer on every call, so it always matches what the
+        // other methods read. The buffer is reused until the chain grows; the one from before
+        // the latest append stays valid too, and older ones are freed. Returns nullptr while the
+        // chain is empty.
+        void* getData() const override;
+
+        size_t getSize() const override;
+
+        void append(Data* data, size_t offset, size_t size);
+
+        // Appends the other chain's segments rather than the chain itself, so chains never nest
+        // and a chain can be appended to itself.
+        void append(ChainedData* chain, size_t offset, size_t size);
+
+        ChainedData* slice(size_t offset, size_t size) const;
+
+        const std::vector<Segment>& getSegments() const;
+
+        // Copies every segment into `destination`, which must hold getSize() bytes.
+        void copyTo(char* destination) const;
+
+        // Calls function(bytes, size) for each segment in order.
+        template<typename Function>
+        void forEachSegment(Function function) const
+        {
+            for (const auto& segment : this->segments)
+                function(segment.getBytes(), segment.size);
+        }
+
+      private:
+        // Calls function(segment, start, length) for the part of each segment that overlaps
+        // [offset, offset + size) of the chain.
+        template<typename Function>
+        void forEachRange(size_t offset, size_t size, Function function) const
+        {
+            for (const auto& segment : this->segments)
+            {
+                if (size == 0)
+                    break;
+
+                if (offset >= segment.size)
+                {
+                    offset -= segment.size;
+                    continue;
+                }
+
+                size_t length = std::min(segment.size - offset, size);
+                function(segment, offset, length);
+
+                offset = 0;
+                size -= length;
+            }
+        }
+
+        void grow(size_t size);
+
+        std::vector<Segment> segments;
+        size_t size;
+
+        mutable char* flattened;
+        mutable std::mutex flattenMutex;
+
+        // The buffer from before the chain last grew, and its size.
+        char* retired;
+        size_t retiredSize;
+    };
+} // namespace love
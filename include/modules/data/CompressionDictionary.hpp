@@ -0,0 +1,42 @@
+#pragma once
+
+#include "common/Data.hpp"
+#include "modules/data/misc/Compressor.hpp"
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace love
+{
+    // A preset dictionary for compressing many small, similar inputs. Its data is the dictionary
+    // content, which is what both sides need to agree on.
+    class CompressionDictionary : public Data
+    {
+      public:
+        static Type type;
+
+        CompressionDictionary(Compressor::Format format, const void* data, size_t size);
+
+        CompressionDictionary(Compressor::Format format,
+                              const std::vector<std::string_view>& samples);
+
+        CompressionDictionary(const CompressionDictionary& other);
+
+        virtual ~CompressionDictionary();
+
+        Compressor::Format getFormat() const;
+
+        Compressor::Dictionary& getDictionary() const;
+
+        CompressionDictionary* clone() const override;
+
+        void* getData() const override;
+
+        size_t getSize() const override;
+
+      private:
+        // Copies share the prepared state; none of it changes once it has been set up.
+        std::shared_ptr<Compressor::Dictionary> dictionary;
+    };
+} // namespace love
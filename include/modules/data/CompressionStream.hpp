@@ -0,0 +1,50 @@
+#pragma once
+
+#include "common/Object.hpp"
+#include "modules/data/misc/Compressor.hpp"
+
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace love
+{
+    class CompressionStream : public Object
+    {
+      public:
+        static Type type;
+
+        enum Mode
+        {
+            MODE_COMPRESS,
+            MODE_DECOMPRESS,
+            MODE_MAX_ENUM
+        };
+
+        CompressionStream(Mode mode, Compressor::Format format, int level = -1);
+
+        virtual ~CompressionStream();
+
+        Mode getMode() const;
+
+        Compressor::Format getFormat() const;
+
+        // The returned bytes stay valid until the next call on this stream.
+        std::string_view push(const char* input, size_t size);
+
+        std::string_view finish();
+
+        // clang-format off
+        STRINGMAP_DECLARE(modes, Mode,
+            { "compress",   MODE_COMPRESS   },
+            { "decompress", MODE_DECOMPRESS }
+        );
+        // clang-format on
+
+      private:
+        Mode mode;
+        Compressor::Format format;
+        std::unique_ptr<Compressor::Stream> stream;
+        std::vector<char> output;
+    };
+} // namespace love
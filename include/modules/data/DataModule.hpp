@@ -1,16 +1,23 @@
 #pragma once
 
 #include "common/Module.hpp"
+#include "common/Variant.hpp"
 
 #include "modules/data/ByteData.hpp"
+#include "modules/data/ChainedData.hpp"
 #include "modules/data/CompressedData.hpp"
+#include "modules/data/CompressionDictionary.hpp"
+#include "modules/data/CompressionStream.hpp"
 #include "modules/data/DataView.hpp"
+#include "modules/data/Hasher.hpp"
+#include "modules/data/PackFormat.hpp"
 #include "modules/data/misc/HashFunction.hpp"
 
 #include "utility/map.hpp"
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace love
 {
@@ -19,6 +26,7 @@ namespace love
         enum EncodeFormat
         {
             ENCODE_BASE64,
+            ENCODE_BASE64URL,
             ENCODE_HEX,
             ENCODE_MAX_ENUM
         };
@@ -31,18 +39,39 @@ namespace love
         };
 
         CompressedData* compress(Compressor::Format format, const char* bytes, size_t size,
-                                 int level = -1);
+                                 int level = -1, CompressionDictionary* dictionary = nullptr);
 
-        char* decompress(CompressedData* data, size_t& size);
+        // Streams the segments through the compressor instead of flattening the chain. The
+        // lz4 block format and dictionaries need one buffer, so those flatten it.
+        CompressedData* compress(Compressor::Format format, ChainedData* chain, int level = -1,
+                                 CompressionDictionary* dictionary = nullptr);
+
+        char* decompress(CompressedData* data, size_t& size,
+                         CompressionDictionary* dictionary = nullptr);
 
         char* decompress(Compressor::Format format, const char* bytes, size_t size,
-                         size_t& rawSize);
+                         size_t& rawSize, CompressionDictionary* dictionary = nullptr);
+
+        // Returns the number of bytes written to `destination`.
+        size_t decompressInto(CompressedData* data, char* destination, size_t capacity);
 
+        size_t decompressInto(Compressor::Format format, const char* bytes, size_t size,
+                              char* destination, size_t capacity);
+
+        // `uppercase` only applies to hex.
         char* encode(EncodeFormat format, const void* source, size_t size,
-                     size_t& destinationLength, size_t lineLength = 0);
+                     size_t& destinationLength, size_t lineLength = 0, bool uppercase = false);
+
+        // Returns the number of characters written to `destination`. Throws when they would
+        // overwrite any of the source.
+        size_t encodeInto(EncodeFormat format, const void* source, size_t size,
+                          char* destination, size_t capacity, size_t lineLength = 0,
+                          bool uppercase = false);
 
+        // Strict decoding throws on characters that do not belong to the format instead of
+        // skipping them.
         char* decode(EncodeFormat format, const char* source, size_t size,
-                     size_t& destinationLength);
+                     size_t& destinationLength, bool strict = false);
 
         std::string hash(HashFunction::Function function, Data* input);
 
@@ -53,10 +82,25 @@ namespace love
         void hash(HashFunction::Function function, const char* input, uint64_t size,
                   HashFunction::Value& output);
 
+        void hash(HashFunction::Function function, ChainedData* input, HashFunction::Value& output);
+
+        // Hashes every input, spreading the work over the thread pool. Small inputs of similar
+        // size are grouped so they can share SIMD lanes.
+        void hashBatch(HashFunction::Function function, const char* const* inputs,
+                       const uint64_t* sizes, HashFunction::Value* outputs, size_t count);
+
+        // Appends the binary encoding of a value, described in Serializer.hpp, to `output`. It
+        // is compressed unless `format` is FORMAT_MAX_ENUM.
+        void serialize(const Variant& value, std::vector<char>& output,
+                       Compressor::Format format = Compressor::FORMAT_MAX_ENUM, int level = -1);
+
+        Variant deserialize(const char* bytes, size_t size);
+
         // clang-format off
         STRINGMAP_DECLARE(encodeFormats, EncodeFormat,
-            { "base64", ENCODE_BASE64 },
-            { "hex",    ENCODE_HEX    }
+            { "base64",    ENCODE_BASE64    },
+            { "base64url", ENCODE_BASE64URL },
+            { "hex",       ENCODE_HEX       }
         );
 
         STRINGMAP_DECLARE(containerTypes, ContainerType,
@@ -76,10 +120,26 @@ namespace love
 
         DataView* newDataView(Data* data, size_t offset, size_t size) const;
 
-        ByteData* newByteData(size_t size) const;
+        ChainedData* newChainedData() const;
+
+        ByteData* newByteData(size_t size, bool clear = true) const;
 
         ByteData* newByteData(const void* data, size_t size) const;
 
         ByteData* newByteData(void* data, size_t size, bool own) const;
+
+        Hasher* newHasher(HashFunction::Function function) const;
+
+        PackFormat* newPackFormat(const char* format) const;
+
+        CompressionStream* newCompressionStream(Compressor::Format format, int level) const;
+
+        CompressionStream* newDecompressionStream(Compressor::Format format) const;
+
+        CompressionDictionary* newCompressionDictionary(Compressor::Format format,
+                                                        const void* data, size_t size) const;
+
+        CompressionDictionary* newCompressionDictionary(
+            Compressor::Format format, const std::vector<std::string_view>& samples) const;
     };
 } // namespace love
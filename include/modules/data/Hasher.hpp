@@ -0,0 +1,29 @@
+#pragma once
+
+#include "common/Object.hpp"
+#include "modules/data/misc/HashFunction.hpp"
+
+#include <memory>
+
+namespace love
+{
+    class Hasher : public Object
+    {
+      public:
+        static Type type;
+
+        Hasher(HashFunction::Function function);
+
+        virtual ~Hasher();
+
+        HashFunction::Function getFunction() const;
+
+        void update(const char* input, uint64_t length);
+
+        void finish(HashFunction::Value& output);
+
+      private:
+        HashFunction::Function function;
+        std::unique_ptr<HashFunction::Context> context;
+    };
+} // namespace love
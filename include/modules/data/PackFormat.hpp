@@ -0,0 +1,86 @@
+#pragma once
+
+#include "common/Object.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+namespace love
+{
+    // A format string in the syntax of string.pack, parsed once into the fields it describes so
+    // records can be packed and unpacked without reparsing it. Alignment is relative to the start
+    // of each record rather than to the start of the Data holding it.
+    class PackFormat : public Object
+    {
+      public:
+        static Type type;
+
+        static constexpr size_t MAX_INTEGER_SIZE = 16;
+
+        enum FieldType
+        {
+            FIELD_INT,
+            FIELD_UINT,
+            FIELD_FLOAT,
+            FIELD_CHARS,
+            FIELD_STRING,
+            FIELD_ZSTRING,
+            FIELD_PADDING,
+            FIELD_MAX_ENUM
+        };
+
+        struct Field
+        {
+            FieldType type;
+            bool little;
+            // Power of two the start of the field is padded to, or 1.
+            size_t align;
+            // The length prefix of FIELD_STRING, and nothing for FIELD_ZSTRING.
+            size_t size;
+        };
+
+        PackFormat(const char* format);
+
+        virtual ~PackFormat();
+
+        const std::string& getFormat() const;
+
+        const std::vector<Field>& getFields() const;
+
+        // The number of values in each record, which is every field but padding.
+        size_t getValueCount() const;
+
+        bool isFixedSize() const;
+
+        // The size of every record, when the format is fixed-size.
+        size_t getSize() const;
+
+        static size_t getPadding(size_t position, size_t align)
+        {
+            return (0 - position) & (align - 1);
+        }
+
+        // Sign-extends `value` when `negative` is set and the field is wider than 8 bytes.
+        static void packInteger(char* destination, uint64_t value, bool negative, size_t size,
+                                bool little);
+
+        // Returns false when the field is wider than 8 bytes and the value does not fit in 64.
+        static bool unpackInteger(const char* source, size_t size, bool little, bool isSigned,
+                                  uint64_t& value);
+
+        static void packFloat(char* destination, double value, size_t size, bool little);
+
+        static double unpackFloat(const char* source, size_t size, bool little);
+
+      private:
+        std::string format;
+        std::vector<Field> fields;
+
+        size_t valueCount;
+        size_t size;
+        bool fixedSize;
+    };
+} // namespace love
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "utility/map.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace love
+{
+    // Element-wise math over arrays of numbers stored in Data. Callers check bounds; these only
+    // see pointers and element counts. Pointers need no particular alignment. A target may be
+    // the same array as one of the sources, but must not partially overlap one.
+    //
+    // Integer results saturate to the range of the element type, and numbers converted to an
+    // integer type are rounded to the nearest integer, halves away from zero.
+    class ArrayKernels
+    {
+      public:
+        enum ElementType
+        {
+            ELEMENT_FLOAT32,
+            ELEMENT_INT16,
+            ELEMENT_INT32,
+            ELEMENT_UINT32,
+            ELEMENT_UINT8,
+            ELEMENT_MAX_ENUM
+        };
+
+        enum Operation
+        {
+            OPERATION_ADD,
+            OPERATION_SUBTRACT,
+            OPERATION_MULTIPLY,
+            OPERATION_MAX_ENUM
+        };
+
+        enum Reduction
+        {
+            REDUCTION_SUM,
+            REDUCTION_MIN,
+            REDUCTION_MAX,
+            REDUCTION_MAX_ENUM
+        };
+
+        // An array of the element type being operated on, or a number used for every element
+        // when `array` is nullptr. Numbers are used as they are, so only the result of an
+        // integer operation is rounded and saturated.
+        struct Operand
+        {
+            const void* array;
+            double scalar;
+        };
+
+        static size_t getElementSize(ElementType type);
+
+        static void fill(ElementType type, void* target, size_t count, double value);
+
+        // target = a <operation> b
+        static void apply(Operation operation, ElementType type, void* target, const Operand& a,
+                          const Operand& b, size_t count);
+
+        // target = a * b + c, saturating only once for integers.
+        static void fma(ElementType type, void* target, const Operand& a, const Operand& b,
+                        const Operand& c, size_t count);
+
+        static void clamp(ElementType type, void* target, size_t count, double low, double high);
+
+        // target = source * scale + bias, computed in double precision when either type is a
+        // 32-bit integer and in single precision otherwise.
+        static void convert(ElementType targetType, void* target, ElementType sourceType,
+                            const void* source, size_t count, double scale, double bias);
+
+        // Conversions from and to arrays of doubles, such as numbers read from Lua tables.
+        static void fromNumbers(ElementType type, void* target, const double* source,
+                                size_t count);
+
+        static void toNumbers(ElementType type, double* target, const void* source, size_t count);
+
+        // Sums of float32 arrays are accumulated in double precision. `count` must not be 0.
+        static double reduce(Reduction reduction, ElementType type, const void* source,
+                             size_t count);
+
+        // Accumulated in double precision for the 32-bit types, and in 64-bit integers for the
+        // smaller ones.
+        static double dot(ElementType type, const void* a, const void* b, size_t count);
+
+        // Stable radix sort of `count` records of `stride` bytes, ordered by the key at
+        // `keyOffset` in each. Floats order as -inf < ... < -0 < +0 < ... < inf, with NaNs at
+        // either end depending on their sign bit. `count` must be below 2^32.
+        static void sort(ElementType type, void* records, size_t count, size_t stride,
+                         size_t keyOffset);
+
+        // Returns the index of the first record in a sorted array whose key is not less than
+        // `value`, or `count` if there is none.
+        static size_t search(ElementType type, const void* records, size_t count, size_t stride,
+                             size_t keyOffset, double value, bool& found);
+
+        // clang-format off
+        STRINGMAP_DECLARE(elementTypes, ElementType,
+            { "float32", ELEMENT_FLOAT32 },
+            { "int16",   ELEMENT_INT16   },
+            { "int32",   ELEMENT_INT32   },
+            { "uint32",  ELEMENT_UINT32  },
+            { "uint8",   ELEMENT_UINT8   }
+        );
+        // clang-format on
+    };
+} // namespace love
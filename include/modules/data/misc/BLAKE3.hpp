@@ -0,0 +1,576 @@
+#pragma once
+
+#include "common/Exception.hpp"
+#include "common/ThreadPool.hpp"
+
+#include "modules/data/misc/HashFunction.hpp"
+#include "modules/data/misc/MultiBuffer.hpp"
+
+#include <bit>
+#include <cstring>
+#include <memory>
+
+namespace love
+{
+    // BLAKE3 in its default (unkeyed) hash mode with a 32-byte output. Full chunks and parent
+    // nodes are compressed four at a time in SIMD lanes, and large subtrees are split across
+    // the thread pool.
+    class BLAKE3 : public HashFunction
+    {
+      private:
+        static constexpr size_t BLOCK_SIZE = 64;
+        static constexpr size_t CHUNK_SIZE = 1024;
+        static constexpr size_t MAX_DEPTH  = 54;
+
+        // Subtrees at least this large are hashed on the thread pool, in pieces of at least
+        // PARALLEL_PIECE_SIZE bytes.
+        static constexpr size_t PARALLEL_MIN_SIZE   = 128 * 1024;
+        static constexpr size_t PARALLEL_PIECE_SIZE = 32 * 1024;
+
+        // Subtrees up to this many chunks are hashed into a flat array and then reduced.
+        static constexpr size_t LEAF_CHUNKS = 16;
+
+        enum Flags
+        {
+            FLAG_CHUNK_START = 1 << 0,
+            FLAG_CHUNK_END   = 1 << 1,
+            FLAG_PARENT      = 1 << 2,
+            FLAG_ROOT        = 1 << 3
+        };
+
+        static constexpr uint32_t IV[8] = {
+            0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+            0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19,
+        };
+
+        // Message word order for each of the seven rounds.
+        static constexpr uint8_t schedule[7][16] = {
+            { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+            { 2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8 },
+            { 3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1 },
+            { 10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6 },
+            { 12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4 },
+            { 9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7 },
+            { 11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13 },
+        };
+
+        using ChainingValue = uint32_t[8];
+
+        template<typename T>
+        static void mix(T* state, int a, int b, int c, int d, T x, T y)
+        {
+            state[a] = state[a] + state[b] + x;
+            state[d] = rightrot(state[d] ^ state[a], 16);
+            state[c] = state[c] + state[d];
+            state[b] = rightrot(state[b] ^ state[c], 12);
+            state[a] = state[a] + state[b] + y;
+            state[d] = rightrot(state[d] ^ state[a], 8);
+            state[c] = state[c] + state[d];
+            state[b] = rightrot(state[b] ^ state[c], 7);
+        }
+
+        // Works on single words or on Lanes, one message per lane.
+        template<typename T>
+        static void rounds(T* state, const T* words)
+        {
+            for (int round = 0; round < 7; round++)
+            {
+                const uint8_t* order = schedule[round];
+
+                mix(state, 0, 4, 8, 12, words[order[0]], words[order[1]]);
+                mix(state, 1, 5, 9, 13, words[order[2]], words[order[3]]);
+                mix(state, 2, 6, 10, 14, words[order[4]], words[order[5]]);
+                mix(state, 3, 7, 11, 15, words[order[6]], words[order[7]]);
+
+                mix(state, 0, 5, 10, 15, words[order[8]], words[order[9]]);
+                mix(state, 1, 6, 11, 12, words[order[10]], words[order[11]]);
+                mix(state, 2, 7, 8, 13, words[order[12]], words[order[13]]);
+                mix(state, 3, 4, 9, 14, words[order[14]], words[order[15]]);
+            }
+        }
+
+        static void compress(const uint32_t cv[8], const uint32_t words[16], uint64_t counter,
+                             uint32_t length, uint32_t flags, uint32_t output[16])
+        {
+            uint32_t state[16] = {
+                cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+                IV[0], IV[1], IV[2], IV[3], (uint32_t)counter, (uint32_t)(counter >> 32),
+                length, flags,
+            };
+
+            rounds(state, words);
+
+            for (int index = 0; index < 8; index++)
+            {
+                output[index]     = state[index] ^ state[index + 8];
+                output[index + 8] = state[index + 8] ^ cv[index];
+            }
+        }
+
+        static void parent(const uint32_t left[8], const uint32_t right[8], uint32_t output[8])
+        {
+            uint32_t words[16];
+            std::memcpy(words, left, 32);
+            std::memcpy(words + 8, right, 32);
+
+            uint32_t full[16];
+            compress(IV, words, 0, BLOCK_SIZE, FLAG_PARENT, full);
+            std::memcpy(output, full, 32);
+        }
+
+        // Hashes `count` whole chunks starting at chunk index `counter`.
+        static void hashChunks(const uint8_t* input, size_t count, uint64_t counter,
+                               ChainingValue* output)
+        {
+            size_t index = 0;
+
+            for (; index + MultiBuffer::LANE_COUNT <= count; index += MultiBuffer::LANE_COUNT)
+            {
+                Lanes cv[8];
+                for (int word = 0; word < 8; word++)
+                    cv[word] = Lanes {} + IV[word];
+
+                Lanes counterLow {}, counterHigh {};
+                for (size_t lane = 0; lane < MultiBuffer::LANE_COUNT; lane++)
+                {
+                    uint64_t chunk    = counter + index + lane;
+                    counterLow[lane]  = (uint32_t)chunk;
+                    counterHigh[lane] = (uint32_t)(chunk >> 32);
+                }
+
+                for (size_t block = 0; block < CHUNK_SIZE / BLOCK_SIZE; block++)
+                {
+                    Lanes words[16];
+                    for (size_t lane = 0; lane < MultiBuffer::LANE_COUNT; lane++)
+                    {
+                        const uint8_t* bytes = input + (index + lane) * CHUNK_SIZE;
+                        bytes += block * BLOCK_SIZE;
+
+                        for (int word = 0; word < 16; word++)
+                            words[word][lane] = load32le(bytes + word * 4);
+                    }
+
+                    uint32_t flags = 0;
+                    if (block == 0)
+                        flags |= FLAG_CHUNK_START;
+                    if (block == CHUNK_SIZE / BLOCK_SIZE - 1)
+                        flags |= FLAG_CHUNK_END;
+
+                    Lanes state[16] = {
+                        cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+                        Lanes {} + IV[0], Lanes {} + IV[1], Lanes {} + IV[2], Lanes {} + IV[3],
+                        counterLow, counterHigh, Lanes {} + (uint32_t)BLOCK_SIZE, Lanes {} + flags,
+                    };
+
+                    rounds(state, words);
+
+                    for (int word = 0; word < 8; word++)
+                        cv[word] = state[word] ^ state[word + 8];
+                }
+
+                for (size_t lane = 0; lane < MultiBuffer::LANE_COUNT; lane++)
+                {
+                    for (int word = 0; word < 8; word++)
+                        output[index + lane][word] = cv[word][lane];
+                }
+            }
+
+            for (; index < count; index++)
+            {
+                ChunkState chunk(counter + index);
+                chunk.update(input + index * CHUNK_SIZE, CHUNK_SIZE);
+                chunk.getOutput().getChainingValue(output[index]);
+            }
+        }
+
+        // Combines children[2i] and children[2i + 1] into output[i]. May run in place.
+        static void hashParents(const ChainingValue* children, size_t count, ChainingValue* output)
+        {
+            size_t index = 0;
+
+            for (; index + MultiBuffer::LANE_COUNT <= count; index += MultiBuffer::LANE_COUNT)
+            {
+                Lanes words[16];
+                for (size_t lane = 0; lane < MultiBuffer::LANE_COUNT; lane++)
+                {
+                    const uint32_t* left  = children[(index + lane) * 2];
+                    const uint32_t* right = children[(index + lane) * 2 + 1];
+
+                    for (int word = 0; word < 8; word++)
+                    {
+                        words[word][lane]     = left[word];
+                        words[word + 8][lane] = right[word];
+                    }
+                }
+
+                Lanes state[16];
+                for (int word = 0; word < 8; word++)
+                    state[word] = Lanes {} + IV[word];
+
+                for (int word = 0; word < 4; word++)
+                    state[word + 8] = Lanes {} + IV[word];
+
+                state[12] = Lanes {};
+                state[13] = Lanes {};
+                state[14] = Lanes {} + (uint32_t)BLOCK_SIZE;
+                state[15] = Lanes {} + (uint32_t)FLAG_PARENT;
+
+                rounds(state, words);
+
+                for (size_t lane = 0; lane < MultiBuffer::LANE_COUNT; lane++)
+                {
+                    for (int word = 0; word < 8; word++)
+                        output[index + lane][word] = state[word][lane] ^ state[word + 8][lane];
+                }
+            }
+
+            for (; index < count; index++)
+                parent(children[index * 2], children[index * 2 + 1], output[index]);
+        }
+
+        // Chaining value of a complete subtree; `chunks` is a power of two.
+        static void hashSubtree(const uint8_t* input, size_t chunks, uint64_t counter,
+                                uint32_t output[8])
+        {
+            if (chunks <= LEAF_CHUNKS)
+            {
+                ChainingValue values[LEAF_CHUNKS];
+                hashChunks(input, chunks, counter, values);
+
+                for (; chunks > 1; chunks /= 2)
+                    hashParents(values, chunks / 2, values);
+
+                std::memcpy(output, values[0], 32);
+                return;
+            }
+
+            size_t half = chunks / 2;
+            ChainingValue children[2];
+
+            hashSubtree(input, half, counter, children[0]);
+            hashSubtree(input + half * CHUNK_SIZE, half, counter + half, children[1]);
+
+            parent(children[0], children[1], output);
+        }
+
+        // The two children of a complete subtree of at least two chunks. The subtree's own
+        // node is left to the caller, since it may turn out to be the root.
+        static void hashSubtreeChildren(const uint8_t* input, size_t chunks, uint64_t counter,
+                                        ChainingValue* children)
+        {
+            auto& pool = ThreadPool::getInstance();
+
+            if (chunks * CHUNK_SIZE < PARALLEL_MIN_SIZE || pool.getConcurrency() == 1)
+            {
+                size_t half = chunks / 2;
+
+                hashSubtree(input, half, counter, children[0]);
+                hashSubtree(input + half * CHUNK_SIZE, half, counter + half, children[1]);
+
+                return;
+            }
+
+            size_t pieces = 2;
+            while (pieces < pool.getConcurrency() * 4 &&
+                   (chunks / (pieces * 2)) * CHUNK_SIZE >= PARALLEL_PIECE_SIZE)
+            {
+                pieces *= 2;
+            }
+
+            size_t pieceChunks = chunks / pieces;
+            std::unique_ptr<ChainingValue[]> values(new ChainingValue[pieces]);
+
+            pool.parallelFor(pieces, [&](size_t piece) {
+                const uint8_t* start = input + piece * pieceChunks * CHUNK_SIZE;
+                hashSubtree(start, pieceChunks, counter + piece * pieceChunks, values[piece]);
+            });
+
+            for (; pieces > 2; pieces /= 2)
+                hashParents(values.get(), pieces / 2, values.get());
+
+            std::memcpy(children, values.get(), sizeof(ChainingValue) * 2);
+        }
+
+        // The inputs to a node's compression, kept so the root can be finalised differently.
+        class Output
+        {
+          public:
+            Output(const uint32_t cv[8], const uint32_t words[16], uint64_t counter,
+                   uint32_t length, uint32_t flags) :
+                counter(counter),
+                length(length),
+                flags(flags)
+            {
+                std::memcpy(this->cv, cv, sizeof(this->cv));
+                std::memcpy(this->words, words, sizeof(this->words));
+            }
+
+            void getChainingValue(uint32_t output[8]) const
+            {
+                uint32_t full[16];
+                compress(this->cv, this->words, this->counter, this->length, this->flags, full);
+                std::memcpy(output, full, 32);
+            }
+
+            void getRoot(Value& output) const
+            {
+                uint32_t full[16];
+                compress(this->cv, this->words, 0, this->length, this->flags | FLAG_ROOT, full);
+
+                for (int index = 0; index < 32; index++)
+                    output.data[index] = (full[index / 4] >> (index % 4 * 8)) & 0xFF;
+
+                output.size = 32;
+            }
+
+            static Output fromParent(const uint32_t left[8], const uint32_t right[8])
+            {
+                uint32_t words[16];
+                std::memcpy(words, left, 32);
+                std::memcpy(words + 8, right, 32);
+
+                return Output(IV, words, 0, BLOCK_SIZE, FLAG_PARENT);
+            }
+
+          private:
+            uint32_t cv[8];
+            uint32_t words[16];
+            uint64_t counter;
+            uint32_t length;
+            uint32_t flags;
+        };
+
+        class ChunkState
+        {
+          public:
+            ChunkState(uint64_t counter) : counter(counter)
+            {
+                this->reset(counter);
+            }
+
+            void reset(uint64_t counter)
+            {
+                std::memcpy(this->cv, IV, sizeof(this->cv));
+                this->counter    = counter;
+                this->buffered   = 0;
+                this->compressed = 0;
+            }
+
+            size_t getLength() const
+            {
+                return this->compressed * BLOCK_SIZE + this->buffered;
+            }
+
+            uint64_t getCounter() const
+            {
+                return this->counter;
+            }
+
+            void update(const uint8_t* input, size_t length)
+            {
+                while (length > 0)
+                {
+                    // The last block of a chunk is only compressed once we know it is the last.
+                    if (this->buffered == BLOCK_SIZE)
+                    {
+                        uint32_t words[16];
+                        for (int word = 0; word < 16; word++)
+                            words[word] = load32le(this->block + word * 4);
+
+                        uint32_t full[16];
+                        compress(this->cv, words, this->counter, BLOCK_SIZE, this->getStartFlag(),
+                                 full);
+
+                        std::memcpy(this->cv, full, sizeof(this->cv));
+                        this->compressed++;
+                        this->buffered = 0;
+                    }
+
+                    size_t copy = std::min(BLOCK_SIZE - this->buffered, length);
+                    std::memcpy(this->block + this->buffered, input, copy);
+
+                    this->buffered += copy;
+                    input += copy;
+                    length -= copy;
+                }
+            }
+
+            Output getOutput() const
+            {
+                uint8_t padded[BLOCK_SIZE] {};
+                std::memcpy(padded, this->block, this->buffered);
+
+                uint32_t words[16];
+                for (int word = 0; word < 16; word++)
+                    words[word] = load32le(padded + word * 4);
+
+                uint32_t flags = this->getStartFlag() | FLAG_CHUNK_END;
+                return Output(this->cv, words, this->counter, (uint32_t)this->buffered, flags);
+            }
+
+          private:
+            uint32_t getStartFlag() const
+            {
+                return this->compressed == 0 ? FLAG_CHUNK_START : 0;
+            }
+
+            uint32_t cv[8];
+            uint64_t counter;
+            uint8_t block[BLOCK_SIZE];
+            size_t buffered;
+            size_t compressed;
+        };
+
+      public:
+        // Whole subtrees are hashed straight from the input; only the chunk that might be the
+        // last one is buffered. Completed subtrees wait on a stack of chaining values and are
+        // merged lazily, since the final merge has to carry the root flag.
+        class Context : public HashFunction::Context
+        {
+          public:
+            Context(Function function) : HashFunction::Context(function), chunk(0), stackSize(0)
+            {}
+
+            void update(const char* input, uint64_t length) override
+            {
+                const uint8_t* bytes = (const uint8_t*)input;
+
+                if (this->chunk.getLength() > 0)
+                {
+                    uint64_t space = CHUNK_SIZE - this->chunk.getLength();
+                    size_t copy    = (size_t)std::min(space, length);
+                    this->chunk.update(bytes, copy);
+
+                    bytes += copy;
+                    length -= copy;
+
+                    if (length == 0)
+                        return;
+
+                    uint32_t cv[8];
+                    this->chunk.getOutput().getChainingValue(cv);
+
+                    uint64_t counter = this->chunk.getCounter();
+                    this->push(cv, counter);
+                    this->chunk.reset(counter + 1);
+                }
+
+                while (length > CHUNK_SIZE)
+                {
+                    uint64_t counter = this->chunk.getCounter();
+                    uint64_t size    = std::bit_floor(length);
+
+                    // A subtree has to start at a multiple of its own size.
+                    while (((size - 1) & (counter * CHUNK_SIZE)) != 0)
+                        size /= 2;
+
+                    size_t chunks = (size_t)(size / CHUNK_SIZE);
+
+                    if (chunks == 1)
+                    {
+                        ChainingValue cv;
+                        hashChunks(bytes, 1, counter, &cv);
+                        this->push(cv, counter);
+                    }
+                    else
+                    {
+                        ChainingValue children[2];
+                        hashSubtreeChildren(bytes, chunks, counter, children);
+
+                        this->push(children[0], counter);
+                        this->push(children[1], counter + chunks / 2);
+                    }
+
+                    this->chunk.reset(counter + chunks);
+
+                    bytes += size;
+                    length -= size;
+                }
+
+                if (length > 0)
+                {
+                    this->chunk.update(bytes, (size_t)length);
+                    this->merge(this->chunk.getCounter());
+                }
+            }
+
+            void finalize(Value& output) override
+            {
+                if (this->stackSize == 0)
+                    return this->chunk.getOutput().getRoot(output);
+
+                size_t remaining = this->stackSize;
+                Output node      = this->chunk.getOutput();
+
+                if (this->chunk.getLength() == 0)
+                {
+                    remaining -= 2;
+                    node = Output::fromParent(this->stack[remaining], this->stack[remaining + 1]);
+                }
+
+                while (remaining > 0)
+                {
+                    uint32_t cv[8];
+                    node.getChainingValue(cv);
+
+                    remaining--;
+                    node = Output::fromParent(this->stack[remaining], cv);
+                }
+
+                node.getRoot(output);
+            }
+
+          private:
+            // Collapses finished subtrees until one entry is left per set bit in `chunks`.
+            void merge(uint64_t chunks)
+            {
+                size_t target = (size_t)std::popcount(chunks);
+
+                while (this->stackSize > target)
+                {
+                    this->stackSize--;
+
+                    uint32_t* left = this->stack[this->stackSize - 1];
+                    parent(left, this->stack[this->stackSize], left);
+                }
+            }
+
+            void push(const uint32_t cv[8], uint64_t counter)
+            {
+                this->merge(counter);
+
+                std::memcpy(this->stack[this->stackSize], cv, 32);
+                this->stackSize++;
+            }
+
+            ChunkState chunk;
+            ChainingValue stack[MAX_DEPTH + 1];
+            size_t stackSize;
+        };
+
+        bool isSupported(Function function) const override
+        {
+            return function == FUNCTION_BLAKE3;
+        }
+
+        HashFunction::Context* newContext(Function function) const override
+        {
+            if (!this->isSupported(function))
+                throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "BLAKE3 implementation.");
+
+            return new Context(function);
+        }
+
+        void hash(Function function, const char* input, uint64_t length,
+                  Value& output) const override
+        {
+            if (!this->isSupported(function))
+                throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "BLAKE3 implementation.");
+
+            Context context(function);
+
+            context.update(input, length);
+            context.finalize(output);
+        }
+    } blake3;
+} // namespace love
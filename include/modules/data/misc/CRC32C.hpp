@@ -0,0 +1,127 @@
+#pragma once
+
+#include "common/Exception.hpp"
+
+#include "modules/data/misc/HashFunction.hpp"
+#include "modules/data/misc/HashKernels.hpp"
+
+#include <array>
+
+namespace love
+{
+    // Slice-by-8 lookup tables for a reflected CRC-32 polynomial.
+    constexpr std::array<std::array<uint32_t, 256>, 8> makeCRC32Table(uint32_t polynomial)
+    {
+        std::array<std::array<uint32_t, 256>, 8> table {};
+
+        for (uint32_t index = 0; index < 256; index++)
+        {
+            uint32_t crc = index;
+            for (int bit = 0; bit < 8; bit++)
+                crc = (crc >> 1) ^ (polynomial & (0 - (crc & 1)));
+
+            table[0][index] = crc;
+        }
+
+        for (uint32_t index = 0; index < 256; index++)
+        {
+            for (size_t slice = 1; slice < 8; slice++)
+            {
+                uint32_t previous   = table[slice - 1][index];
+                table[slice][index] = (previous >> 8) ^ table[0][previous & 0xFF];
+            }
+        }
+
+        return table;
+    }
+
+    // CRC-32C (Castagnoli), reflected, as used by iSCSI, ext4 and SSE4.2.
+    class CRC32C : public HashFunction
+    {
+      private:
+        static constexpr auto table = makeCRC32Table(0x82F63B78);
+
+      public:
+        CRC32C() : kernel(kernels::getCRC32CKernel())
+        {
+            if (this->kernel == nullptr)
+                this->kernel = update;
+        }
+
+        // Slice-by-8. `crc` is the running, non-inverted value.
+        static uint32_t update(uint32_t crc, const uint8_t* bytes, uint64_t length)
+        {
+            for (; length >= 8; length -= 8, bytes += 8)
+            {
+                uint32_t low  = load32le(bytes) ^ crc;
+                uint32_t high = load32le(bytes + 4);
+
+                crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^
+                      table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+                      table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^
+                      table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+            }
+
+            for (; length > 0; length--, bytes++)
+                crc = (crc >> 8) ^ table[0][(crc ^ *bytes) & 0xFF];
+
+            return crc;
+        }
+
+        class Context : public HashFunction::Context
+        {
+          public:
+            Context(Function function, kernels::CRC32CFunction kernel) :
+                HashFunction::Context(function),
+                kernel(kernel)
+            {}
+
+            void update(const char* input, uint64_t length) override
+            {
+                this->crc = this->kernel(this->crc, (const uint8_t*)input, length);
+            }
+
+            void finalize(Value& output) override
+            {
+                uint32_t value = ~this->crc;
+
+                for (int index = 0; index < 4; index++)
+                    output.data[index] = (value >> (24 - index * 8)) & 0xFF;
+
+                output.size = 4;
+            }
+
+          private:
+            kernels::CRC32CFunction kernel;
+            uint32_t crc = 0xFFFFFFFF;
+        };
+
+        bool isSupported(Function function) const override
+        {
+            return function == FUNCTION_CRC32C;
+        }
+
+        HashFunction::Context* newContext(Function function) const override
+        {
+            if (!this->isSupported(function))
+                throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "CRC32C implementation.");
+
+            return new Context(function, this->kernel);
+        }
+
+        void hash(Function function, const char* input, uint64_t length,
+                  Value& output) const override
+        {
+            if (!this->isSupported(function))
+                throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "CRC32C implementation.");
+
+            Context context(function, this->kernel);
+
+            context.update(input, length);
+            context.finalize(output);
+        }
+
+      private:
+        kernels::CRC32CFunction kernel;
+    } crc32c;
+} // namespace love
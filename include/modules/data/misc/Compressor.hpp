@@ -1,8 +1,13 @@
 #pragma once
 
+#include "common/Exception.hpp"
 #include "utility/map.hpp"
 
+#include <cstdint>
+#include <cstring>
+#include <new>
 #include <stddef.h>
+#include <vector>
 
 namespace love
 {
@@ -12,14 +17,80 @@ namespace love
         enum Format
         {
             FORMAT_LZ4,
+            FORMAT_LZ4FRAME,
             FORMAT_GZIP,
             FORMAT_ZLIB,
             FORMAT_DEFLATE,
+            FORMAT_ZSTD,
             FORMAT_MAX_ENUM
         };
 
+        // Incremental compression or decompression state. Each call appends whatever output
+        // is ready, so neither the whole input nor the whole output has to be held at once.
+        class Stream
+        {
+          public:
+            Stream(Format format) : format(format)
+            {}
+
+            virtual ~Stream()
+            {}
+
+            Format getFormat() const
+            {
+                return this->format;
+            }
+
+            virtual void push(const char* input, size_t size, std::vector<char>& output) = 0;
+
+            // Flushes the remaining output. Decompression throws if the input stopped early.
+            virtual void finish(std::vector<char>& output) = 0;
+
+          protected:
+            Format format;
+        };
+
+        // A preset dictionary for one format, along with whatever state the format can prepare
+        // from it ahead of time so that each call using it starts quickly.
+        class Dictionary
+        {
+          public:
+            Dictionary(Format format, const char* content, size_t size) :
+                format(format),
+                content(content, content + size)
+            {}
+
+            virtual ~Dictionary()
+            {}
+
+            Format getFormat() const
+            {
+                return this->format;
+            }
+
+            const std::vector<char>& getContent() const
+            {
+                return this->content;
+            }
+
+          protected:
+            Format format;
+            std::vector<char> content;
+        };
+
+        // How often the per-thread library contexts were reused rather than set up again, and
+        // roughly how much allocation that avoided.
+        struct Stats
+        {
+            uint64_t contextsCreated;
+            uint64_t contextsReused;
+            uint64_t bytesSaved;
+        };
+
         static Compressor* getCompressor(Format format);
 
+        static Stats getStats();
+
         virtual ~Compressor()
         {}
 
@@ -29,19 +100,123 @@ namespace love
         virtual char* decompress(Format format, const char* data, size_t dataSize,
                                  size_t& decompressedSize) = 0;
 
+        // Decompresses into memory the caller owns instead of a new allocation. Returns the
+        // number of bytes written, and throws if they would not fit in `capacity`.
+        virtual size_t decompressInto(Format format, const char* data, size_t dataSize,
+                                      char* destination, size_t capacity) = 0;
+
+        virtual char* compress(Format format, Dictionary& dictionary, const char* data,
+                               size_t dataSize, int level, size_t& compressedSize) = 0;
+
+        virtual char* decompress(Format format, Dictionary& dictionary, const char* data,
+                                 size_t dataSize, size_t& decompressedSize) = 0;
+
+        // Uses `content` as the dictionary as it is, trimmed to what the format can reference.
+        virtual Dictionary* newDictionary(Format format, const char* content, size_t size) = 0;
+
+        // Builds a dictionary from example inputs. By default the samples are simply joined,
+        // with the last ones closest to the data and so the cheapest to reference.
+        virtual Dictionary* trainDictionary(Format format, const char* const* samples,
+                                            const size_t* sizes, size_t count)
+        {
+            std::vector<char> content;
+
+            for (size_t index = 0; index < count; index++)
+                content.insert(content.end(), samples[index], samples[index] + sizes[index]);
+
+            return this->newDictionary(format, content.data(), content.size());
+        }
+
+        virtual Stream* newCompressionStream(Format format, int level) = 0;
+
+        virtual Stream* newDecompressionStream(Format format) = 0;
+
         virtual bool isSupported(Format format) const = 0;
 
         // clang-format off
         STRINGMAP_DECLARE(formats, Format,
-            { "lz4",     FORMAT_LZ4     },
-            { "gzip",    FORMAT_GZIP    },
-            { "zlib",    FORMAT_ZLIB    },
-            { "deflate", FORMAT_DEFLATE }
+            { "lz4",      FORMAT_LZ4      },
+            { "lz4frame", FORMAT_LZ4FRAME },
+            { "gzip",     FORMAT_GZIP     },
+            { "zlib",     FORMAT_ZLIB     },
+            { "deflate",  FORMAT_DEFLATE  },
+            { "zstd",     FORMAT_ZSTD     }
         );
         // clang-format on
 
       protected:
+        // Streams grow their output buffer by this much at a time.
+        static constexpr size_t STREAM_CHUNK_SIZE = 64 * 1024;
+
         Compressor()
         {}
+
+        static void countCreated();
+
+        static void countReused(size_t size);
+
+        // Keeps one library context for the calling thread between calls, freed when the thread
+        // exits, so that each call only pays for a reset. `SizeOf` gives what a fresh context
+        // would have allocated.
+        template<typename T, auto Free, auto SizeOf>
+        class ThreadContext
+        {
+          public:
+            ~ThreadContext()
+            {
+                if (this->context != nullptr)
+                    Free(this->context);
+            }
+
+            // Returns the context this thread already has, or nullptr if it has none yet.
+            T* get()
+            {
+                if (this->context != nullptr)
+                    countReused(SizeOf(this->context));
+
+                return this->context;
+            }
+
+            T* set(T* context)
+            {
+                if (context == nullptr)
+                    throw love::Exception(E_OUT_OF_MEMORY);
+
+                this->context = context;
+                countCreated();
+
+                return context;
+            }
+
+          private:
+            T* context = nullptr;
+        };
+
+        static void throwDictionaryNotSupported(Format format)
+        {
+            std::string_view name {};
+            getConstant(format, name);
+
+            throw love::Exception(E_DICTIONARY_NOT_SUPPORTED, name);
+        }
+
+        static char* copyOutput(const std::vector<char>& output, size_t& size)
+        {
+            char* bytes = nullptr;
+
+            try
+            {
+                bytes = new char[output.size()];
+            }
+            catch (std::bad_alloc&)
+            {
+                throw love::Exception(E_OUT_OF_MEMORY);
+            }
+
+            std::memcpy(bytes, output.data(), output.size());
+            size = output.size();
+
+            return bytes;
+        }
     };
 } // namespace love
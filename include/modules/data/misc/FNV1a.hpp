@@ -0,0 +1,70 @@
+#pragma once
+
+#include "common/Exception.hpp"
+
+#include "modules/data/misc/HashFunction.hpp"
+
+namespace love
+{
+    class FNV1a : public HashFunction
+    {
+      private:
+        static constexpr uint32_t OFFSET_BASIS = 0x811C9DC5;
+        static constexpr uint32_t PRIME        = 0x01000193;
+
+      public:
+        class Context : public HashFunction::Context
+        {
+          public:
+            Context(Function function) : HashFunction::Context(function)
+            {}
+
+            void update(const char* input, uint64_t length) override
+            {
+                const uint8_t* bytes = (const uint8_t*)input;
+                uint32_t hash        = this->hash;
+
+                for (uint64_t index = 0; index < length; index++)
+                    hash = (hash ^ bytes[index]) * PRIME;
+
+                this->hash = hash;
+            }
+
+            void finalize(Value& output) override
+            {
+                for (int index = 0; index < 4; index++)
+                    output.data[index] = (this->hash >> (24 - index * 8)) & 0xFF;
+
+                output.size = 4;
+            }
+
+          private:
+            uint32_t hash = OFFSET_BASIS;
+        };
+
+        bool isSupported(Function function) const override
+        {
+            return function == FUNCTION_FNV1A32;
+        }
+
+        HashFunction::Context* newContext(Function function) const override
+        {
+            if (!this->isSupported(function))
+                throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "FNV-1a implementation.");
+
+            return new Context(function);
+        }
+
+        void hash(Function function, const char* input, uint64_t length,
+                  Value& output) const override
+        {
+            if (!this->isSupported(function))
+                throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "FNV-1a implementation.");
+
+            Context context(function);
+
+            context.update(input, length);
+            context.finalize(output);
+        }
+    } fnv1a;
+} // namespace love
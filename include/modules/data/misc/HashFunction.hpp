@@ -5,6 +5,8 @@
 
 #include "utility/map.hpp"
 
+#include <cstring>
+
 namespace love
 {
     inline uint32_t leftrot(uint32_t x, uint8_t amount)
@@ -29,6 +31,23 @@ namespace love
         return r == 0 ? a : a + (n - r);
     }
 
+    inline uint32_t load32le(const uint8_t* bytes)
+    {
+        return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) |
+               ((uint32_t)bytes[3] << 24);
+    }
+
+    inline uint32_t load32be(const uint8_t* bytes)
+    {
+        return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) |
+               ((uint32_t)bytes[2] << 8) | (uint32_t)bytes[3];
+    }
+
+    inline uint64_t load64be(const uint8_t* bytes)
+    {
+        return ((uint64_t)load32be(bytes) << 32) | (uint64_t)load32be(bytes + 4);
+    }
+
     class HashFunction
     {
       public:
@@ -40,38 +59,182 @@ namespace love
             FUNCTION_SHA256,
             FUNCTION_SHA384,
             FUNCTION_SHA512,
+            FUNCTION_XXH3_64,
+            FUNCTION_XXH3_128,
+            FUNCTION_XXH64,
+            FUNCTION_CRC32C,
+            FUNCTION_FNV1A32,
+            FUNCTION_BLAKE3,
             FUNCTION_MAX_ENUM
         };
 
+        enum Backend
+        {
+            BACKEND_SCALAR,
+            BACKEND_ARMV8,
+            BACKEND_SHANI,
+            BACKEND_MAX_ENUM
+        };
+
         struct Value
         {
             char data[0x40];
             size_t size;
         };
 
+        // Incremental hashing state; input is consumed as it arrives.
+        class Context
+        {
+          public:
+            virtual ~Context()
+            {}
+
+            virtual void update(const char* input, uint64_t length) = 0;
+
+            virtual void finalize(Value& output) = 0;
+
+            Function getFunction() const
+            {
+                return this->function;
+            }
+
+          protected:
+            Context(Function function) : function(function)
+            {}
+
+            Function function;
+        };
+
         static HashFunction* getHashFunction(Function function);
 
+        // The instruction set used for SHA-1 and SHA-2 (32-bit) compression.
+        static Backend getBackend();
+
         virtual ~HashFunction()
         {}
 
+        // The caller owns the returned context.
+        virtual Context* newContext(Function function) const = 0;
+
         virtual void hash(Function function, const char* input, uint64_t length,
-                          Value& output) const = 0;
+                          Value& output) const;
+
+        // Hashes `count` independent inputs. Implementations may interleave them in SIMD lanes.
+        virtual void hashMany(Function function, const char* const* inputs,
+                              const uint64_t* lengths, Value* outputs, size_t count) const;
 
         virtual bool isSupported(Function function) const = 0;
 
         // clang-format off
         STRINGMAP_DECLARE(hashFunctions, Function,
-            { "md5",    FUNCTION_MD5    },
-            { "sha1",   FUNCTION_SHA1   },
-            { "sha224", FUNCTION_SHA224 },
-            { "sha256", FUNCTION_SHA256 },
-            { "sha384", FUNCTION_SHA384 },
-            { "sha512", FUNCTION_SHA512 }
+            { "md5",      FUNCTION_MD5      },
+            { "sha1",     FUNCTION_SHA1     },
+            { "sha224",   FUNCTION_SHA224   },
+            { "sha256",   FUNCTION_SHA256   },
+            { "sha384",   FUNCTION_SHA384   },
+            { "sha512",   FUNCTION_SHA512   },
+            { "xxh3_64",  FUNCTION_XXH3_64  },
+            { "xxh3_128", FUNCTION_XXH3_128 },
+            { "xxh64",    FUNCTION_XXH64    },
+            { "crc32c",   FUNCTION_CRC32C   },
+            { "fnv1a32",  FUNCTION_FNV1A32  },
+            { "blake3",   FUNCTION_BLAKE3   }
+        );
+
+        STRINGMAP_DECLARE(backends, Backend,
+            { "scalar", BACKEND_SCALAR },
+            { "armv8",  BACKEND_ARMV8  },
+            { "shani",  BACKEND_SHANI  }
         );
         // clang-format on
 
       protected:
         HashFunction()
         {}
+
+        // Full blocks are compressed in place; only a partial tail block is buffered.
+        template<size_t BlockSize>
+        class BlockContext : public Context
+        {
+          public:
+            void update(const char* input, uint64_t length) override
+            {
+                const uint8_t* bytes = (const uint8_t*)input;
+                this->totalLength += length;
+
+                if (this->buffered > 0)
+                {
+                    size_t copy = (size_t)std::min<uint64_t>(BlockSize - this->buffered, length);
+                    std::memcpy(this->buffer + this->buffered, bytes, copy);
+
+                    this->buffered += copy;
+                    bytes += copy;
+                    length -= copy;
+
+                    if (this->buffered < BlockSize)
+                        return;
+
+                    this->processBlocks(this->buffer, 1);
+                    this->buffered = 0;
+                }
+
+                if (length >= BlockSize)
+                {
+                    uint64_t count = length / BlockSize;
+                    this->processBlocks(bytes, count);
+
+                    bytes += count * BlockSize;
+                    length -= count * BlockSize;
+                }
+
+                if (length > 0)
+                {
+                    std::memcpy(this->buffer, bytes, (size_t)length);
+                    this->buffered = (size_t)length;
+                }
+            }
+
+          protected:
+            static constexpr size_t LENGTH_SIZE = BlockSize == 128 ? 16 : 8;
+
+            BlockContext(Function function) : Context(function), buffered(0), totalLength(0)
+            {}
+
+            virtual void processBlocks(const uint8_t* blocks, uint64_t count) = 0;
+
+            // Appends the 0x80 terminator, zero padding and the message bit length.
+            void pad(bool bigEndian)
+            {
+                uint64_t bitLength = this->totalLength * 8;
+
+                this->buffer[this->buffered++] = 0x80;
+
+                if (this->buffered > BlockSize - LENGTH_SIZE)
+                {
+                    std::memset(this->buffer + this->buffered, 0, BlockSize - this->buffered);
+                    this->processBlocks(this->buffer, 1);
+                    this->buffered = 0;
+                }
+
+                std::memset(this->buffer + this->buffered, 0, BlockSize - this->buffered);
+
+                for (int index = 0; index < 8; index++)
+                {
+                    uint8_t byte = (bitLength >> (index * 8)) & 0xFF;
+
+                    if (bigEndian)
+                        this->buffer[BlockSize - 1 - index] = byte;
+                    else
+                        this->buffer[BlockSize - LENGTH_SIZE + index] = byte;
+                }
+
+                this->processBlocks(this->buffer, 1);
+                this->buffered = 0;
+            }
+
+            uint8_t buffer[BlockSize];
+            size_t buffered;
+            uint64_t totalLength;
+        };
     };
 } // namespace love
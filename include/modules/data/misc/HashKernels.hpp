@@ -0,0 +1,37 @@
+#pragma once
+
+#include "modules/data/misc/HashFunction.hpp"
+
+#if defined(__aarch64__) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2))
+    #define LOVE_HASH_ARMV8
+#endif
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define LOVE_HASH_SHANI
+    #define LOVE_HASH_SSE42
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+    #define LOVE_HASH_ARMV8_CRC
+#endif
+
+namespace love
+{
+    namespace kernels
+    {
+        using CompressFunction = void (*)(uint32_t* state, const uint8_t* blocks, uint64_t count);
+
+        using CRC32CFunction = uint32_t (*)(uint32_t crc, const uint8_t* bytes, uint64_t length);
+
+        // Probes the CPU once; returns BACKEND_SCALAR when no extension is usable.
+        HashFunction::Backend detectBackend();
+
+        // Returns nullptr if the backend has no kernel for this function.
+        CompressFunction getSHA1Kernel(HashFunction::Backend backend);
+
+        CompressFunction getSHA256Kernel(HashFunction::Backend backend);
+
+        // Returns nullptr if the CPU has no CRC-32C instructions.
+        CRC32CFunction getCRC32CKernel();
+    } // namespace kernels
+} // namespace love
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace love
+{
+    // JSON parsing in two stages. The first finds every structural character outside strings
+    // and the start of every other token, 64 bytes at a time. The second checks that those
+    // form valid JSON and reduces them to a list of values in document order, where each
+    // object and array records how many members it has, so callers can build their result
+    // with one pass and the right sizes. Numbers and strings are only checked when read.
+    class Json
+    {
+      public:
+        static constexpr int MAX_DEPTH = 512;
+
+        enum ScalarType
+        {
+            SCALAR_NULL,
+            SCALAR_FALSE,
+            SCALAR_TRUE,
+            SCALAR_NUMBER,
+            SCALAR_MAX_ENUM
+        };
+
+        // A value, or the key of an object member, starting at `position`. An object's count is
+        // its number of members, which follow it as key and value pairs. An array's is its
+        // number of elements. A string's is the position of its closing quote, and a number or
+        // literal's is where the next token begins.
+        struct Token
+        {
+            uint32_t position;
+            uint32_t count;
+        };
+
+        // Throws when the text is not valid JSON, apart from the contents of numbers, literals
+        // and strings, which are checked by parseScalar and parseString.
+        static void tokenize(const char* json, size_t size, std::vector<Token>& tokens);
+
+        static ScalarType parseScalar(const char* json, const Token& token, double& number);
+
+        // Returns the string's contents, pointing into `json` when there is nothing to unescape
+        // and into `scratch` otherwise.
+        static std::string_view parseString(const char* json, const Token& token,
+                                            std::string& scratch);
+
+        // Parses a JSON number without depending on the locale. Returns nullptr when there is
+        // no valid number at `begin`, or a pointer just past it.
+        static const char* parseNumber(const char* begin, const char* end, double& number);
+
+        static void writeString(std::string& output, const char* string, size_t length);
+
+        // Returns false for NaN and infinities, which JSON cannot represent.
+        static bool writeNumber(std::string& output, double number);
+    };
+} // namespace love
@@ -3,22 +3,829 @@
 #include "modules/data/misc/Compressor.hpp"
 
 #include "common/Exception.hpp"
+#include "common/ThreadPool.hpp"
 #include "common/int.hpp"
 
+#include <algorithm>
+#include <bit>
 #include <cstring>
+#include <mutex>
+#include <vector>
 
 #include <lz4.h>
+#include <lz4frame.h>
 #include <lz4hc.h>
 
 namespace love
 {
     class LZ4Compressor : public Compressor
     {
+      private:
+        // Writes the standard LZ4 frame format, which the lz4 command line tool can read.
+        class FrameCompressStream : public Stream
+        {
+          public:
+            FrameCompressStream(int level) :
+                Stream(FORMAT_LZ4FRAME),
+                context(nullptr),
+                started(false)
+            {
+                this->preferences.compressionLevel = level > 8 ? LZ4HC_CLEVEL_DEFAULT : 0;
+
+                // Independent blocks let decompress() split the frame across threads.
+                this->preferences.frameInfo.blockMode           = LZ4F_blockIndependent;
+                this->preferences.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+
+                if (LZ4F_isError(LZ4F_createCompressionContext(&this->context, LZ4F_VERSION)))
+                    throw love::Exception(E_OUT_OF_MEMORY);
+            }
+
+            virtual ~FrameCompressStream()
+            {
+                LZ4F_freeCompressionContext(this->context);
+            }
+
+            void push(const char* input, size_t size, std::vector<char>& output) override
+            {
+                this->begin(output);
+
+                while (size > 0)
+                {
+                    size_t piece = std::min(size, STREAM_CHUNK_SIZE);
+                    size_t bound = LZ4F_compressBound(piece, &this->preferences);
+
+                    size_t offset = output.size();
+                    output.resize(offset + bound);
+
+                    size_t written = LZ4F_compressUpdate(this->context, output.data() + offset,
+                                                         bound, input, piece, nullptr);
+
+                    this->check(written);
+                    output.resize(offset + written);
+
+                    input += piece;
+                    size -= piece;
+                }
+            }
+
+            void finish(std::vector<char>& output) override
+            {
+                this->begin(output);
+
+                size_t bound  = LZ4F_compressBound(0, &this->preferences);
+                size_t offset = output.size();
+                output.resize(offset + bound);
+
+                size_t written = LZ4F_compressEnd(this->context, output.data() + offset, bound,
+                                                  nullptr);
+
+                this->check(written);
+                output.resize(offset + written);
+            }
+
+          private:
+            void begin(std::vector<char>& output)
+            {
+                if (this->started)
+                    return;
+
+                size_t offset = output.size();
+                output.resize(offset + LZ4F_HEADER_SIZE_MAX);
+
+                size_t written = LZ4F_compressBegin(this->context, output.data() + offset,
+                                                    LZ4F_HEADER_SIZE_MAX, &this->preferences);
+
+                this->check(written);
+                output.resize(offset + written);
+
+                this->started = true;
+            }
+
+            void check(size_t result)
+            {
+                if (LZ4F_isError(result))
+                    throw love::Exception("Could not LZ4-compress data.");
+            }
+
+            LZ4F_cctx* context;
+            LZ4F_preferences_t preferences {};
+            bool started;
+        };
+
+        class FrameDecompressStream : public Stream
+        {
+          public:
+            FrameDecompressStream() : Stream(FORMAT_LZ4FRAME), context(nullptr), ended(false)
+            {
+                if (LZ4F_isError(LZ4F_createDecompressionContext(&this->context, LZ4F_VERSION)))
+                    throw love::Exception(E_OUT_OF_MEMORY);
+            }
+
+            virtual ~FrameDecompressStream()
+            {
+                LZ4F_freeDecompressionContext(this->context);
+            }
+
+            // Anything after the end of the first frame is ignored.
+            void push(const char* input, size_t size, std::vector<char>& output) override
+            {
+                while (!this->ended)
+                {
+                    size_t offset = output.size();
+                    output.resize(offset + STREAM_CHUNK_SIZE);
+
+                    size_t produced = STREAM_CHUNK_SIZE;
+                    size_t consumed = size;
+
+                    size_t hint = LZ4F_decompress(this->context, output.data() + offset, &produced,
+                                                  input, &consumed, nullptr);
+
+                    output.resize(offset + produced);
+
+                    if (LZ4F_isError(hint))
+                        throw love::Exception(E_COULD_NOT_LZ4_DECOMPRESS_DATA);
+
+                    input += consumed;
+                    size -= consumed;
+
+                    if (hint == 0)
+                        this->ended = true;
+                    else if (size == 0 && produced < STREAM_CHUNK_SIZE)
+                        break;
+                }
+            }
+
+            void finish(std::vector<char>&) override
+            {
+                if (!this->ended)
+                    throw love::Exception(E_COMPRESSED_STREAM_TRUNCATED);
+            }
+
+          private:
+            LZ4F_dctx* context;
+            bool ended;
+        };
+
+        static constexpr uint32_t FRAME_MAGIC = 0x184D2204;
+
+        enum FrameFlags
+        {
+            FRAME_VERSION           = 1 << 6,
+            FRAME_BLOCK_INDEPENDENT = 1 << 5,
+            FRAME_BLOCK_CHECKSUM    = 1 << 4,
+            FRAME_CONTENT_SIZE      = 1 << 3,
+            FRAME_CONTENT_CHECKSUM  = 1 << 2,
+            FRAME_DICTIONARY_ID     = 1 << 0
+        };
+
+        static constexpr uint32_t BLOCK_UNCOMPRESSED = 0x80000000;
+
+        // Header checksums and content checksums in the frame format are XXH32.
+        static uint32_t xxh32(const uint8_t* input, size_t length, uint32_t seed = 0)
+        {
+            constexpr uint32_t PRIME1 = 0x9E3779B1, PRIME2 = 0x85EBCA77, PRIME3 = 0xC2B2AE3D;
+            constexpr uint32_t PRIME4 = 0x27D4EB2F, PRIME5 = 0x165667B1;
+
+            const uint8_t* end = input + length;
+            uint32_t hash      = 0;
+
+            if (length >= 16)
+            {
+                uint32_t lanes[4] = { seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1 };
+
+                for (; end - input >= 16; input += 16)
+                {
+                    for (int lane = 0; lane < 4; lane++)
+                    {
+                        uint32_t value = lanes[lane] + readLE32(input + lane * 4) * PRIME2;
+                        lanes[lane]    = std::rotl(value, 13) * PRIME1;
+                    }
+                }
+
+                hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) +
+                       std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+            }
+            else
+                hash = seed + PRIME5;
+
+            hash += (uint32_t)length;
+
+            for (; end - input >= 4; input += 4)
+                hash = std::rotl(hash + readLE32(input) * PRIME3, 17) * PRIME4;
+
+            for (; input < end; input++)
+                hash = std::rotl(hash + *input * PRIME5, 11) * PRIME1;
+
+            hash ^= hash >> 15;
+            hash *= PRIME2;
+            hash ^= hash >> 13;
+            hash *= PRIME3;
+            hash ^= hash >> 16;
+
+            return hash;
+        }
+
+        static uint32_t readLE32(const uint8_t* bytes)
+        {
+            return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+        }
+
+        static void writeLE32(uint8_t* bytes, uint32_t value)
+        {
+            for (int index = 0; index < 4; index++)
+                bytes[index] = (uint8_t)(value >> (index * 8));
+        }
+
+        static size_t getBlockSize(int blockSizeID)
+        {
+            return (size_t)1 << (8 + 2 * blockSizeID);
+        }
+
+        // Largest block size that still gives each thread a few blocks. Blocks stop at 1 MB even
+        // though the format allows 4 MB, since larger ones fall out of cache and run slower.
+        static int chooseBlockSizeID(size_t dataSize, size_t concurrency)
+        {
+            size_t blocks = concurrency > 1 ? concurrency * 4 : 1;
+
+            for (int id = LZ4F_max1MB; id > LZ4F_max64KB; id--)
+            {
+                if (dataSize / blocks >= getBlockSize(id))
+                    return id;
+            }
+
+            return LZ4F_max64KB;
+        }
+
+        static size_t getStreamSize(const LZ4_stream_t*)
+        {
+            return sizeof(LZ4_stream_t);
+        }
+
+        static size_t getStreamHCSize(const LZ4_streamHC_t*)
+        {
+            return sizeof(LZ4_streamHC_t);
+        }
+
+        static size_t getDecompressionContextSize(const LZ4F_dctx*)
+        {
+            // Roughly what LZ4F allocates for its block buffers, for the 64 KB blocks most
+            // frames use.
+            return 2 * 64 * 1024;
+        }
+
+        // LZ4_compress_default clears a 16 KB state on every call, and LZ4_compress_HC allocates
+        // a 256 KB one. A stream kept per thread only needs a fast reset between inputs.
+        static LZ4_stream_t* getThreadStream()
+        {
+            thread_local ThreadContext<LZ4_stream_t, LZ4_freeStream, getStreamSize> context;
+
+            if (LZ4_stream_t* stream = context.get())
+            {
+                LZ4_resetStream_fast(stream);
+                return stream;
+            }
+
+            return context.set(LZ4_createStream());
+        }
+
+        static LZ4_streamHC_t* getThreadStreamHC()
+        {
+            thread_local ThreadContext<LZ4_streamHC_t, LZ4_freeStreamHC, getStreamHCSize> context;
+
+            LZ4_streamHC_t* stream = context.get();
+
+            if (stream == nullptr)
+                stream = context.set(LZ4_createStreamHC());
+
+            LZ4_resetStreamHC_fast(stream, LZ4HC_CLEVEL_DEFAULT);
+            return stream;
+        }
+
+        static int compressData(const char* source, char* destination, int size, int capacity,
+                                int level)
+        {
+            if (level > 8)
+            {
+                LZ4_streamHC_t* stream = getThreadStreamHC();
+                return LZ4_compress_HC_continue(stream, source, destination, size, capacity);
+            }
+
+            LZ4_stream_t* stream = getThreadStream();
+            return LZ4_compress_fast_continue(stream, source, destination, size, capacity, 1);
+        }
+
+        // Returns the block's size word; blocks that do not shrink are stored as they are.
+        static uint32_t compressBlock(const char* source, int size, char* destination,
+                                      int capacity, int level)
+        {
+            int result = compressData(source, destination, size, capacity, level);
+
+            if (result > 0 && result < size)
+                return (uint32_t)result;
+
+            std::memcpy(destination, source, size);
+            return (uint32_t)size | BLOCK_UNCOMPRESSED;
+        }
+
+        // Writes a frame of independent blocks. With worker threads, every block is compressed
+        // into its own worst-case slot and the slots are then packed together in order.
+        char* compressFrame(const char* data, size_t dataSize, int level, size_t& compressedSize)
+        {
+            auto& pool       = ThreadPool::getInstance();
+            int blockSizeID  = chooseBlockSizeID(dataSize, pool.getConcurrency());
+            size_t blockSize = getBlockSize(blockSizeID);
+            size_t blocks    = (dataSize + blockSize - 1) / blockSize;
+
+            const size_t headerSize = 4 + 2 + 8 + 1;
+            size_t slotSize         = 4 + (size_t)LZ4_compressBound((int)blockSize);
+            size_t maxSize          = headerSize + blocks * slotSize + 4 + 4;
+
+            uint8_t* bytes = nullptr;
+
+            try
+            {
+                bytes = new uint8_t[maxSize];
+            }
+            catch (std::bad_alloc&)
+            {
+                throw love::Exception(E_OUT_OF_MEMORY);
+            }
+
+            writeLE32(bytes, FRAME_MAGIC);
+            bytes[4] = FRAME_VERSION | FRAME_BLOCK_INDEPENDENT | FRAME_CONTENT_SIZE |
+                       FRAME_CONTENT_CHECKSUM;
+            bytes[5] = (uint8_t)(blockSizeID << 4);
+
+            writeLE32(bytes + 6, (uint32_t)dataSize);
+            writeLE32(bytes + 10, (uint32_t)((uint64_t)dataSize >> 32));
+
+            bytes[14] = (uint8_t)(xxh32(bytes + 4, 10) >> 8);
+
+            uint8_t* position = bytes + headerSize;
+            int capacity      = (int)slotSize - 4;
+
+            auto getBlock = [&](size_t index, int& size) {
+                size = (int)std::min(blockSize, dataSize - index * blockSize);
+                return data + index * blockSize;
+            };
+
+            if (pool.getConcurrency() == 1)
+            {
+                // Nothing to pack afterwards if the blocks are written in order.
+                for (size_t index = 0; index < blocks; index++)
+                {
+                    int size           = 0;
+                    const char* source = getBlock(index, size);
+                    char* destination  = (char*)position + 4;
+
+                    uint32_t header = compressBlock(source, size, destination, capacity, level);
+                    writeLE32(position, header);
+
+                    position += 4 + (header & ~BLOCK_UNCOMPRESSED);
+                }
+            }
+            else
+            {
+                std::vector<uint32_t> headers(blocks);
+                uint8_t* slots = position;
+
+                try
+                {
+                    pool.parallelFor(blocks, [&](size_t index) {
+                        int size           = 0;
+                        const char* source = getBlock(index, size);
+                        char* destination  = (char*)slots + index * slotSize + 4;
+
+                        headers[index] = compressBlock(source, size, destination, capacity, level);
+                    });
+                }
+                catch (...)
+                {
+                    delete[] bytes;
+                    throw;
+                }
+
+                for (size_t index = 0; index < blocks; index++)
+                {
+                    size_t size = headers[index] & ~BLOCK_UNCOMPRESSED;
+
+                    writeLE32(position, headers[index]);
+                    std::memmove(position + 4, slots + index * slotSize + 4, size);
+
+                    position += 4 + size;
+                }
+            }
+
+            writeLE32(position, 0);
+            writeLE32(position + 4, xxh32((const uint8_t*)data, dataSize));
+            position += 8;
+
+            compressedSize = (size_t)(position - bytes);
+
+            if ((double)maxSize / (double)compressedSize >= 1.2)
+            {
+                char* shrunk = new (std::nothrow) char[compressedSize];
+
+                if (shrunk)
+                {
+                    std::memcpy(shrunk, bytes, compressedSize);
+                    delete[] bytes;
+                    return shrunk;
+                }
+            }
+
+            return (char*)bytes;
+        }
+
+        // An LZ4 sequence emits at most 255 bytes for each byte it takes up, so no compressed
+        // block decodes to more than this many times its size.
+        static constexpr size_t MAX_EXPANSION = 255;
+
+        struct FrameBlock
+        {
+            const uint8_t* data;
+            uint32_t size;
+            bool compressed;
+            size_t rawSize;
+
+            // Where the block is decoded to, and how much it may write there.
+            size_t offset;
+            size_t bound;
+        };
+
+        struct FrameLayout
+        {
+            uint8_t flags;
+            size_t blockSize;
+            uint64_t contentSize;
+            std::vector<FrameBlock> blocks;
+            const uint8_t* checksum;
+        };
+
+        // Finds the blocks of a frame of independent blocks, which can be decoded on the thread
+        // pool. Returns false for anything else (linked blocks, dictionaries, skippable frames),
+        // which has to be streamed.
+        static bool readFrame(const char* data, size_t dataSize, FrameLayout& layout)
+        {
+            const uint8_t* bytes = (const uint8_t*)data;
+            const uint8_t* end   = bytes + dataSize;
+
+            if (dataSize < 7 || readLE32(bytes) != FRAME_MAGIC)
+                return false;
+
+            uint8_t flags = bytes[4];
+
+            if ((flags & 0xC0) != FRAME_VERSION || !(flags & FRAME_BLOCK_INDEPENDENT) ||
+                (flags & FRAME_DICTIONARY_ID))
+            {
+                return false;
+            }
+
+            size_t descriptorSize = 2 + ((flags & FRAME_CONTENT_SIZE) ? 8 : 0);
+            const uint8_t* cursor = bytes + 4 + descriptorSize + 1;
+
+            if (cursor > end)
+                throw love::Exception(E_COMPRESSED_STREAM_TRUNCATED);
+
+            if (bytes[4 + descriptorSize] != (uint8_t)(xxh32(bytes + 4, descriptorSize) >> 8))
+                throw love::Exception(E_COULD_NOT_LZ4_DECOMPRESS_DATA);
+
+            int blockSizeID = (bytes[5] >> 4) & 0x07;
+
+            if (blockSizeID < LZ4F_max64KB)
+                throw love::Exception(E_COULD_NOT_LZ4_DECOMPRESS_DATA);
+
+            layout.flags       = flags;
+            layout.blockSize   = getBlockSize(blockSizeID);
+            layout.contentSize = 0;
+            layout.blocks.clear();
+
+            if (flags & FRAME_CONTENT_SIZE)
+                layout.contentSize = readLE32(bytes + 6) | ((uint64_t)readLE32(bytes + 10) << 32);
+
+            bool checksums = flags & FRAME_BLOCK_CHECKSUM;
+
+            while (true)
+            {
+                if (end - cursor < 4)
+                    throw love::Exception(E_COMPRESSED_STREAM_TRUNCATED);
+
+                uint32_t header = readLE32(cursor);
+                cursor += 4;
+
+                if (header == 0)
+                    break;
+
+                FrameBlock block { cursor, header & ~BLOCK_UNCOMPRESSED,
+                                   !(header & BLOCK_UNCOMPRESSED), 0, 0, 0 };
+
+                if (block.size > layout.blockSize)
+                    throw love::Exception(E_COULD_NOT_LZ4_DECOMPRESS_DATA);
+
+                if ((size_t)(end - cursor) < block.size + (checksums ? 4 : 0))
+                    throw love::Exception(E_COMPRESSED_STREAM_TRUNCATED);
+
+                layout.blocks.push_back(block);
+                cursor += block.size + (checksums ? 4 : 0);
+            }
+
+            if ((flags & FRAME_CONTENT_CHECKSUM) && end - cursor < 4)
+                throw love::Exception(E_COMPRESSED_STREAM_TRUNCATED);
+
+            layout.checksum = cursor;
+            return true;
+        }
+
+        // Gives every block a full block size of room. Returns the space all of them take up.
+        static size_t placeFullBlocks(FrameLayout& layout)
+        {
+            for (size_t index = 0; index < layout.blocks.size(); index++)
+            {
+                layout.blocks[index].offset = index * layout.blockSize;
+                layout.blocks[index].bound  = layout.blockSize;
+            }
+
+            return layout.blocks.size() * layout.blockSize;
+        }
+
+        // Gives every block only as much room as its input can decode to, so that the space a
+        // frame asks for stays proportional to its size.
+        static size_t placeBoundedBlocks(FrameLayout& layout)
+        {
+            size_t offset = 0;
+
+            for (FrameBlock& block : layout.blocks)
+            {
+                block.offset = offset;
+                block.bound  = block.size;
+
+                if (block.compressed)
+                    block.bound = std::min(layout.blockSize, (size_t)block.size * MAX_EXPANSION);
+
+                offset += block.bound;
+            }
+
+            return offset;
+        }
+
+        // Each block is decoded into the slot it was placed in, and the slots are then packed
+        // together. Only the last slot may be cut short by `capacity`.
+        static size_t decodeFrame(FrameLayout& layout, char* destination, size_t capacity)
+        {
+            bool checksums = layout.flags & FRAME_BLOCK_CHECKSUM;
+
+            auto decompressBlock = [&](size_t index) {
+                FrameBlock& block = layout.blocks[index];
+                char* slot        = destination + block.offset;
+                size_t slotSize   = std::min(block.bound, capacity - block.offset);
+
+                if (checksums && readLE32(block.data + block.size) != xxh32(block.data, block.size))
+                    throw love::Exception(E_COULD_NOT_LZ4_DECOMPRESS_DATA);
+
+                if (!block.compressed)
+                {
+                    if (block.size > slotSize)
+                        throw love::Exception(E_COULD_NOT_LZ4_DECOMPRESS_DATA);
+
+                    std::memcpy(slot, block.data, block.size);
+                    block.rawSize = block.size;
+                    return;
+                }
+
+                int result = LZ4_decompress_safe((const char*)block.data, slot, (int)block.size,
+                                                 (int)slotSize);
+
+                if (result < 0)
+                    throw love::Exception(E_COULD_NOT_LZ4_DECOMPRESS_DATA);
+
+                block.rawSize = (size_t)result;
+            };
+
+            ThreadPool::getInstance().parallelFor(layout.blocks.size(), decompressBlock);
+
+            // Blocks that fill their slots don't move.
+            size_t rawSize = 0;
+
+            for (const FrameBlock& block : layout.blocks)
+            {
+                if (rawSize != block.offset)
+                    std::memmove(destination + rawSize, destination + block.offset, block.rawSize);
+
+                rawSize += block.rawSize;
+            }
+
+            bool valid = true;
+
+            if (layout.flags & FRAME_CONTENT_SIZE)
+                valid = layout.contentSize == rawSize;
+
+            if (valid && (layout.flags & FRAME_CONTENT_CHECKSUM))
+                valid = readLE32(layout.checksum) == xxh32((const uint8_t*)destination, rawSize);
+
+            if (!valid)
+                throw love::Exception(E_COULD_NOT_LZ4_DECOMPRESS_DATA);
+
+            return rawSize;
+        }
+
+        char* decompressFrame(const char* data, size_t dataSize, size_t& decompressedSize)
+        {
+            FrameLayout layout {};
+
+            if (!readFrame(data, dataSize, layout))
+                return this->decompressFrameStream(data, dataSize, decompressedSize);
+
+            // A recorded content size is used as is when the input could hold it and it fills
+            // every block but the last. Otherwise each block only gets what it can decode to.
+            size_t fullBlocks = layout.blocks.empty() ? 0 : layout.blocks.size() - 1;
+            size_t capacity   = 0;
+
+            if ((layout.flags & FRAME_CONTENT_SIZE) &&
+                layout.contentSize / MAX_EXPANSION <= dataSize &&
+                layout.contentSize >= fullBlocks * layout.blockSize)
+            {
+                placeFullBlocks(layout);
+                capacity = (size_t)layout.contentSize;
+            }
+            else
+                capacity = placeBoundedBlocks(layout);
+
+            char* rawBytes = nullptr;
+
+            try
+            {
+                rawBytes = new char[std::max<size_t>(capacity, 1)];
+            }
+            catch (std::bad_alloc&)
+            {
+                throw love::Exception(E_OUT_OF_MEMORY);
+            }
+
+            try
+            {
+                decompressedSize = decodeFrame(layout, rawBytes, capacity);
+
+                // Blocks rarely decode to their whole bound, so don't hold on to the rest.
+                if (decompressedSize < capacity)
+                {
+                    char* trimmed = new char[std::max<size_t>(decompressedSize, 1)];
+                    std::memcpy(trimmed, rawBytes, decompressedSize);
+
+                    delete[] rawBytes;
+                    rawBytes = trimmed;
+                }
+            }
+            catch (std::bad_alloc&)
+            {
+                delete[] rawBytes;
+                throw love::Exception(E_OUT_OF_MEMORY);
+            }
+            catch (...)
+            {
+                delete[] rawBytes;
+                throw;
+            }
+
+            return rawBytes;
+        }
+
+        // Frames that state their size and fill every block but the last are decoded in place,
+        // in parallel. Anything else goes through a per-thread LZ4F context, which writes
+        // straight into the destination.
+        static size_t decompressFrameInto(const char* data, size_t dataSize, char* destination,
+                                          size_t capacity)
+        {
+            thread_local FrameLayout layout {};
+
+            if (readFrame(data, dataSize, layout) && (layout.flags & FRAME_CONTENT_SIZE))
+            {
+                if (layout.contentSize > capacity)
+                    throw love::Exception(E_DECOMPRESS_DESTINATION_TOO_SMALL);
+
+                size_t fullBlocks = layout.blocks.empty() ? 0 : layout.blocks.size() - 1;
+
+                if (layout.contentSize >= fullBlocks * layout.blockSize)
+                {
+                    placeFullBlocks(layout);
+                    return decodeFrame(layout, destination, capacity);
+                }
+            }
+
+            using DecompressionContext = ThreadContext<LZ4F_dctx, LZ4F_freeDecompressionContext,
+                                                       getDecompressionContextSize>;
+            thread_local DecompressionContext threadContext;
+
+            LZ4F_dctx* context = threadContext.get();
+
+            if (context != nullptr)
+                LZ4F_resetDecompressionContext(context);
+            else
+            {
+                if (LZ4F_isError(LZ4F_createDecompressionContext(&context, LZ4F_VERSION)))
+                    throw love::Exception(E_OUT_OF_MEMORY);
+
+                threadContext.set(context);
+            }
+
+            LZ4F_decompressOptions_t options {};
+            options.stableDst = 1;
+
+            size_t written = 0;
+
+            while (true)
+            {
+                size_t produced = capacity - written;
+                size_t consumed = dataSize;
+
+                size_t hint = LZ4F_decompress(context, destination + written, &produced, data,
+                                              &consumed, &options);
+
+                if (LZ4F_isError(hint))
+                    throw love::Exception(E_COULD_NOT_LZ4_DECOMPRESS_DATA);
+
+                written += produced;
+                data += consumed;
+                dataSize -= consumed;
+
+                if (hint == 0)
+                    return written;
+                else if (produced == 0 && consumed == 0)
+                {
+                    if (written == capacity)
+                        throw love::Exception(E_DECOMPRESS_DESTINATION_TOO_SMALL);
+
+                    throw love::Exception(E_COMPRESSED_STREAM_TRUNCATED);
+                }
+            }
+        }
+
+        char* decompressFrameStream(const char* data, size_t dataSize, size_t& decompressedSize)
+        {
+            std::vector<char> output;
+            output.reserve(decompressedSize);
+
+            FrameDecompressStream stream;
+            stream.push(data, dataSize, output);
+            stream.finish(output);
+
+            return copyOutput(output, decompressedSize);
+        }
+
+        // Keeps the dictionary already loaded into a stream. Loading it hashes every position,
+        // which takes longer than compressing a small input; copying the loaded state does not.
+        class LZ4Dictionary : public Dictionary
+        {
+          public:
+            static constexpr size_t MAX_SIZE = 64 * 1024;
+
+            LZ4Dictionary(const char* content, size_t size) :
+                Dictionary(FORMAT_LZ4, content + size - std::min(size, MAX_SIZE),
+                           std::min(size, MAX_SIZE))
+            {
+                LZ4_initStream(&this->stream, sizeof(this->stream));
+                LZ4_loadDict(&this->stream, this->content.data(), (int)this->content.size());
+            }
+
+            virtual ~LZ4Dictionary()
+            {
+                LZ4_freeStreamHC(this->streamHC);
+            }
+
+            const LZ4_stream_t& getStream() const
+            {
+                return this->stream;
+            }
+
+            // Most dictionaries are never used at high levels, so this one is made on demand.
+            const LZ4_streamHC_t* getStreamHC()
+            {
+                std::call_once(this->streamHCFlag, [this] {
+                    this->streamHC = LZ4_createStreamHC();
+
+                    if (this->streamHC == nullptr)
+                        return;
+
+                    LZ4_resetStreamHC_fast(this->streamHC, LZ4HC_CLEVEL_DEFAULT);
+                    LZ4_loadDictHC(this->streamHC, this->content.data(), (int)this->content.size());
+                });
+
+                return this->streamHC;
+            }
+
+          private:
+            LZ4_stream_t stream;
+
+            std::once_flag streamHCFlag;
+            LZ4_streamHC_t* streamHC = nullptr;
+        };
+
       public:
         char* compress(Compressor::Format format, const char* data, size_t dataSize, int level,
                        size_t& compressedSize) override
         {
-            if (format != Compressor::FORMAT_LZ4)
+            if (format == Compressor::FORMAT_LZ4FRAME)
+                return this->compressFrame(data, dataSize, level, compressedSize);
+            else if (format != Compressor::FORMAT_LZ4)
                 throw love::Exception(E_INVALID_COMPRESSION_FORMAT_LZ4);
 
             if (dataSize > LZ4_MAX_INPUT_SIZE)
@@ -48,12 +855,16 @@ namespace love
 
             int compSize = 0;
 
-            // clang-format off
-            if (level > 8)
-                compSize = LZ4_compress_HC(data, compressedBytes + headerSize, (int)dataSize, (int)maxDestinationSize, LZ4HC_CLEVEL_DEFAULT);
-            else
-                compSize = LZ4_compress_default(data, compressedBytes + headerSize, (int)dataSize, (int)maxDestinationSize);
-            // clang-format on
+            try
+            {
+                compSize = compressData(data, compressedBytes + headerSize, (int)dataSize,
+                                        maxDestinationSize, level);
+            }
+            catch (love::Exception&)
+            {
+                delete[] compressedBytes;
+                throw;
+            }
 
             if (compSize <= 0)
             {
@@ -81,7 +892,9 @@ namespace love
         char* decompress(Compressor::Format format, const char* data, size_t dataSize,
                          size_t& decompressedSize) override
         {
-            if (format != Compressor::FORMAT_LZ4)
+            if (format == Compressor::FORMAT_LZ4FRAME)
+                return this->decompressFrame(data, dataSize, decompressedSize);
+            else if (format != Compressor::FORMAT_LZ4)
                 throw love::Exception(E_INVALID_COMPRESSION_FORMAT_LZ4);
 
             const size_t headerSize = sizeof(uint32_t);
@@ -131,9 +944,204 @@ namespace love
             return rawBytes;
         }
 
+        size_t decompressInto(Compressor::Format format, const char* data, size_t dataSize,
+                              char* destination, size_t capacity) override
+        {
+            if (format == Compressor::FORMAT_LZ4FRAME)
+                return decompressFrameInto(data, dataSize, destination, capacity);
+            else if (format != Compressor::FORMAT_LZ4)
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_LZ4);
+
+            const size_t headerSize = sizeof(uint32_t);
+
+            if (dataSize < headerSize)
+                throw love::Exception("Invalid LZ4-compressed data size.");
+
+#if defined(__LOVE_BIG_ENDIAN__)
+            uint32_t rawSize = swap_uint32(*(uint32_t*)data);
+#else
+            uint32_t rawSize = *(uint32_t*)data;
+#endif
+
+            if (rawSize > capacity)
+                throw love::Exception(E_DECOMPRESS_DESTINATION_TOO_SMALL);
+
+            // clang-format off
+            int result = LZ4_decompress_safe(data + headerSize, destination, (int)dataSize - (int)headerSize, (int)rawSize);
+            // clang-format on
+
+            if (result < 0)
+                throw love::Exception(E_COULD_NOT_LZ4_DECOMPRESS_DATA);
+
+            return (size_t)result;
+        }
+
+        Stream* newCompressionStream(Compressor::Format format, int level) override
+        {
+            if (format != Compressor::FORMAT_LZ4FRAME)
+                throw love::Exception("Only the lz4frame format can be streamed.");
+
+            return new FrameCompressStream(level);
+        }
+
+        Stream* newDecompressionStream(Compressor::Format format) override
+        {
+            if (format != Compressor::FORMAT_LZ4FRAME)
+                throw love::Exception("Only the lz4frame format can be streamed.");
+
+            return new FrameDecompressStream();
+        }
+
+        char* compress(Compressor::Format format, Dictionary& dictionary, const char* data,
+                       size_t dataSize, int level, size_t& compressedSize) override
+        {
+            if (format == Compressor::FORMAT_LZ4FRAME)
+                throwDictionaryNotSupported(format);
+            else if (format != Compressor::FORMAT_LZ4)
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_LZ4);
+
+            if (dataSize > LZ4_MAX_INPUT_SIZE)
+                throw love::Exception("Data is too large for LZ4 compressor.");
+
+            auto& lz4Dictionary = (LZ4Dictionary&)dictionary;
+
+            const size_t headerSize = sizeof(uint32_t);
+
+            int maxDestinationSize = LZ4_compressBound((int)dataSize);
+            size_t maxSize         = headerSize + (size_t)maxDestinationSize;
+
+            char* compressedBytes = nullptr;
+
+            try
+            {
+                compressedBytes = new char[maxSize];
+            }
+            catch (std::bad_alloc&)
+            {
+                throw love::Exception(E_OUT_OF_MEMORY);
+            }
+
+#if defined(__LOVE_BIG_ENDIAN__)
+            *(uint32_t*)compressedBytes = swap_uint32((uint32_t)dataSize);
+#else
+            *(uint32_t*)compressedBytes = (uint32_t)dataSize;
+#endif
+
+            int compSize = 0;
+
+            try
+            {
+                // The thread's stream is overwritten with the prepared one, so its reset is moot.
+                if (level > 8)
+                {
+                    LZ4_streamHC_t* stream         = getThreadStreamHC();
+                    const LZ4_streamHC_t* prepared = lz4Dictionary.getStreamHC();
+
+                    if (prepared)
+                    {
+                        *stream = *prepared;
+
+                        // clang-format off
+                        compSize = LZ4_compress_HC_continue(stream, data, compressedBytes + headerSize, (int)dataSize, maxDestinationSize);
+                        // clang-format on
+                    }
+                }
+                else
+                {
+                    LZ4_stream_t* stream = getThreadStream();
+                    *stream              = lz4Dictionary.getStream();
+
+                    // clang-format off
+                    compSize = LZ4_compress_fast_continue(stream, data, compressedBytes + headerSize, (int)dataSize, maxDestinationSize, 1);
+                    // clang-format on
+                }
+            }
+            catch (love::Exception&)
+            {
+                delete[] compressedBytes;
+                throw;
+            }
+
+            if (compSize <= 0)
+            {
+                delete[] compressedBytes;
+                throw love::Exception("Could not LZ4-compress data.");
+            }
+
+            if ((double)maxSize / (double)(compSize + headerSize) >= 1.2)
+            {
+                char* bytes = new (std::nothrow) char[compSize + headerSize];
+
+                if (bytes)
+                {
+                    std::memcpy(bytes, compressedBytes, compSize + headerSize);
+                    delete[] compressedBytes;
+                    compressedBytes = bytes;
+                }
+            }
+
+            compressedSize = (size_t)compSize + headerSize;
+            return compressedBytes;
+        }
+
+        char* decompress(Compressor::Format format, Dictionary& dictionary, const char* data,
+                         size_t dataSize, size_t& decompressedSize) override
+        {
+            if (format == Compressor::FORMAT_LZ4FRAME)
+                throwDictionaryNotSupported(format);
+            else if (format != Compressor::FORMAT_LZ4)
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_LZ4);
+
+            const auto& content     = dictionary.getContent();
+            const size_t headerSize = sizeof(uint32_t);
+            char* rawBytes          = nullptr;
+
+            if (dataSize < headerSize)
+                throw love::Exception("Invalid LZ4-compressed data size.");
+
+#if defined(__LOVE_BIG_ENDIAN__)
+            uint32_t rawSize = swap_uint32(*(uint32_t*)data);
+#else
+            uint32_t rawSize = *(uint32_t*)data;
+#endif
+
+            try
+            {
+                rawBytes = new char[std::max<uint32_t>(rawSize, 1)];
+            }
+            catch (std::bad_alloc&)
+            {
+                throw love::Exception(E_OUT_OF_MEMORY);
+            }
+
+            // clang-format off
+            int result = LZ4_decompress_safe_usingDict(data + headerSize, rawBytes, (int)dataSize - (int)headerSize, (int)rawSize, content.data(), (int)content.size());
+            // clang-format on
+
+            if (result < 0)
+            {
+                delete[] rawBytes;
+                throw love::Exception(E_COULD_NOT_LZ4_DECOMPRESS_DATA);
+            }
+
+            decompressedSize = (size_t)result;
+            return rawBytes;
+        }
+
+        Dictionary* newDictionary(Compressor::Format format, const char* content,
+                                  size_t size) override
+        {
+            if (format == Compressor::FORMAT_LZ4FRAME)
+                throwDictionaryNotSupported(format);
+            else if (format != Compressor::FORMAT_LZ4)
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_LZ4);
+
+            return new LZ4Dictionary(content, size);
+        }
+
         bool isSupported(Compressor::Format format) const override
         {
-            return format == Compressor::FORMAT_LZ4;
+            return format == Compressor::FORMAT_LZ4 || format == Compressor::FORMAT_LZ4FRAME;
         }
     };
 } // namespace love
@@ -3,14 +3,18 @@
 #include "common/Exception.hpp"
 
 #include "modules/data/misc/HashFunction.hpp"
+#include "modules/data/misc/MultiBuffer.hpp"
 
 #include <cstring>
+#include <memory>
 
 namespace love
 {
     class MD5 : public HashFunction
     {
       private:
+        static constexpr uint32_t initial[4] = { 0X67452301, 0XEFCDAB89, 0X98BADCFE, 0X10325476 };
+
         static constexpr uint8_t shifts[64] = {
             7,  12, 17, 22, 7,  12, 17, 22, 7,  12, 17, 22, 7,  12, 17, 22, 5,  9,  14, 20, 5,  9,
             14, 20, 5,  9,  14, 20, 5,  9,  14, 20, 4,  11, 16, 23, 4,  11, 16, 23, 4,  11, 16, 23,
@@ -31,40 +35,18 @@ namespace love
         };
 
       public:
-        bool isSupported(Function function) const override
+        static void compress(uint32_t state[4], const uint8_t* blocks, uint64_t count)
         {
-            return function == FUNCTION_MD5;
-        }
-
-        void hash(Function function, const char* input, uint64_t length,
-                  Value& output) const override
-        {
-            if (!this->isSupported(function))
-                throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "MD5 implementation.");
-
-            uint32_t a0 = 0X67452301;
-            uint32_t b0 = 0XEFCDAB89;
-            uint32_t c0 = 0X98BADCFE;
-            uint32_t d0 = 0X10325476;
-
-            uint64_t paddedLength = extend_multiple(length + 1 + 8, 64);
-            uint32_t* padded      = new uint32_t[paddedLength / 4];
-
-            std::memcpy(padded, input, (size_t)length);
-            std::memset(((uint8_t*)padded) + length, 0, (size_t)(paddedLength - length));
-            *(((uint8_t*)padded) + length) = 0x80;
-
-            uint64_t bitLength = length * 8;
-            std::memcpy(((uint8_t*)padded) + paddedLength - 8, &bitLength, 8);
-
-            for (uint64_t i = 0; i < paddedLength / 4; i += 16)
+            for (uint64_t block = 0; block < count; block++, blocks += 64)
             {
-                uint32_t* chunk = &padded[i];
-
-                uint32_t A = a0;
-                uint32_t B = b0;
-                uint32_t C = c0;
-                uint32_t D = d0;
+                uint32_t chunk[16];
+                for (int j = 0; j < 16; j++)
+                    chunk[j] = load32le(blocks + j * 4);
+
+                uint32_t A = state[0];
+                uint32_t B = state[1];
+                uint32_t C = state[2];
+                uint32_t D = state[3];
                 uint32_t F;
                 uint32_t g;
 
@@ -98,19 +80,124 @@ namespace love
                     A = temp;
                 }
 
-                a0 += A;
-                b0 += B;
-                c0 += C;
-                d0 += D;
+                state[0] += A;
+                state[1] += B;
+                state[2] += C;
+                state[3] += D;
             }
+        }
 
-            delete[] padded;
+        // Same rounds as compress(), one block from each of four messages.
+        static void compressLanes(Lanes state[4], const Lanes words[16])
+        {
+            Lanes A = state[0];
+            Lanes B = state[1];
+            Lanes C = state[2];
+            Lanes D = state[3];
+            Lanes F;
+            int g;
+
+            for (int j = 0; j < 64; j++)
+            {
+                if (j < 16)
+                {
+                    F = (B & C) | (~B & D);
+                    g = j;
+                }
+                else if (j < 32)
+                {
+                    F = (D & B) | (~D & C);
+                    g = (5 * j + 1) % 16;
+                }
+                else if (j < 48)
+                {
+                    F = B ^ C ^ D;
+                    g = (3 * j + 5) % 16;
+                }
+                else
+                {
+                    F = C ^ (B | ~D);
+                    g = (7 * j) % 16;
+                }
+
+                Lanes temp = D;
+                D          = C;
+                C          = B;
+                B += leftrot(A + F + constants[j] + words[g], shifts[j]);
+                A = temp;
+            }
+
+            state[0] += A;
+            state[1] += B;
+            state[2] += C;
+            state[3] += D;
+        }
+
+        class Context : public BlockContext<64>
+        {
+          public:
+            Context(Function function) : BlockContext(function)
+            {}
+
+            void finalize(Value& output) override
+            {
+                this->pad(false);
 
-            memcpy(&output.data[0], &a0, 4);
-            memcpy(&output.data[4], &b0, 4);
-            memcpy(&output.data[8], &c0, 4);
-            memcpy(&output.data[12], &d0, 4);
-            output.size = 16;
+                for (int index = 0; index < 16; index += 4)
+                {
+                    output.data[index + 0] = (this->state[index / 4] >> 0) & 0xFF;
+                    output.data[index + 1] = (this->state[index / 4] >> 8) & 0xFF;
+                    output.data[index + 2] = (this->state[index / 4] >> 16) & 0xFF;
+                    output.data[index + 3] = (this->state[index / 4] >> 24) & 0xFF;
+                }
+
+                output.size = 16;
+            }
+
+          protected:
+            void processBlocks(const uint8_t* blocks, uint64_t count) override
+            {
+                compress(this->state, blocks, count);
+            }
+
+          private:
+            uint32_t state[4] = { initial[0], initial[1], initial[2], initial[3] };
+        };
+
+        bool isSupported(Function function) const override
+        {
+            return function == FUNCTION_MD5;
+        }
+
+        HashFunction::Context* newContext(Function function) const override
+        {
+            if (!this->isSupported(function))
+                throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "MD5 implementation.");
+
+            return new Context(function);
+        }
+
+        void hashMany(Function function, const char* const* inputs, const uint64_t* lengths,
+                      Value* outputs, size_t count) const override
+        {
+            if (!this->isSupported(function))
+                throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "MD5 implementation.");
+
+            std::unique_ptr<uint32_t[][4]> states(new uint32_t[count][4]);
+
+            MultiBuffer::hash<4>(initial, false, inputs, lengths, count, compressLanes,
+                                 states.get());
+
+            for (size_t message = 0; message < count; message++)
+            {
+                for (int index = 0; index < 16; index++)
+                {
+                    uint32_t word                = states[message][index / 4];
+                    outputs[message].data[index] = (word >> (index % 4 * 8)) & 0xFF;
+                }
+
+                outputs[message].size = 16;
+            }
         }
     } md5;
 } // namespace love
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "modules/data/misc/HashFunction.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace love
+{
+    // Four 32-bit lanes, each belonging to a different message. The compiler lowers these to
+    // NEON or SSE2 registers.
+    typedef uint32_t Lanes __attribute__((vector_size(16)));
+
+    inline Lanes leftrot(Lanes x, uint8_t amount)
+    {
+        return (x << amount) | (x >> (32 - amount));
+    }
+
+    inline Lanes rightrot(Lanes x, uint8_t amount)
+    {
+        return (x >> amount) | (x << (32 - amount));
+    }
+
+    // Runs up to LANE_COUNT messages through a lane-parallel compression function at once.
+    // This pays off for hash functions without dedicated instructions, where a single
+    // message leaves most of the vector unit idle.
+    class MultiBuffer
+    {
+      public:
+        static constexpr size_t LANE_COUNT = 4;
+        static constexpr size_t BLOCK_SIZE = 64;
+
+        template<size_t StateWords, typename Compress>
+        static void hash(const uint32_t* initial, bool bigEndian, const char* const* inputs,
+                         const uint64_t* lengths, size_t count, Compress compress,
+                         uint32_t (*states)[StateWords])
+        {
+            for (size_t first = 0; first < count; first += LANE_COUNT)
+            {
+                size_t lanes = std::min(LANE_COUNT, count - first);
+
+                Message messages[LANE_COUNT];
+                uint64_t maxBlocks = 0;
+
+                // Idle lanes repeat the first message; their results are discarded.
+                for (size_t lane = 0; lane < LANE_COUNT; lane++)
+                {
+                    size_t index = first + (lane < lanes ? lane : 0);
+                    messages[lane].init(inputs[index], lengths[index], bigEndian);
+                    maxBlocks = std::max(maxBlocks, messages[lane].blocks);
+                }
+
+                Lanes state[StateWords];
+                for (size_t word = 0; word < StateWords; word++)
+                {
+                    uint32_t value = initial[word];
+                    state[word]    = Lanes { value, value, value, value };
+                }
+
+                for (uint64_t block = 0; block < maxBlocks; block++)
+                {
+                    const uint8_t* pointers[LANE_COUNT];
+                    for (size_t lane = 0; lane < LANE_COUNT; lane++)
+                        pointers[lane] = messages[lane].getBlock(block);
+
+                    Lanes words[16];
+                    for (size_t word = 0; word < 16; word++)
+                    {
+                        for (size_t lane = 0; lane < LANE_COUNT; lane++)
+                        {
+                            const uint8_t* bytes = pointers[lane] + word * 4;
+                            words[word][lane]    = bigEndian ? load32be(bytes) : load32le(bytes);
+                        }
+                    }
+
+                    compress(state, words);
+
+                    for (size_t lane = 0; lane < lanes; lane++)
+                    {
+                        if (messages[lane].blocks != block + 1)
+                            continue;
+
+                        for (size_t word = 0; word < StateWords; word++)
+                            states[first + lane][word] = state[word][lane];
+                    }
+                }
+            }
+        }
+
+      private:
+        // A message viewed as its whole blocks followed by one or two padded tail blocks.
+        struct Message
+        {
+            void init(const char* input, uint64_t length, bool bigEndian)
+            {
+                this->data       = (const uint8_t*)input;
+                this->fullBlocks = length / BLOCK_SIZE;
+
+                size_t remainder = (size_t)(length % BLOCK_SIZE);
+                size_t tailSize  = remainder + 9 <= BLOCK_SIZE ? BLOCK_SIZE : BLOCK_SIZE * 2;
+
+                std::memset(this->tail, 0, tailSize);
+                std::memcpy(this->tail, this->data + this->fullBlocks * BLOCK_SIZE, remainder);
+                this->tail[remainder] = 0x80;
+
+                uint64_t bitLength = length * 8;
+                for (int index = 0; index < 8; index++)
+                {
+                    uint8_t byte = (bitLength >> (index * 8)) & 0xFF;
+
+                    if (bigEndian)
+                        this->tail[tailSize - 1 - index] = byte;
+                    else
+                        this->tail[tailSize - 8 + index] = byte;
+                }
+
+                this->blocks = this->fullBlocks + tailSize / BLOCK_SIZE;
+            }
+
+            // Lanes that have finished keep re-reading their last block.
+            const uint8_t* getBlock(uint64_t block) const
+            {
+                block = std::min(block, this->blocks - 1);
+
+                if (block < this->fullBlocks)
+                    return this->data + block * BLOCK_SIZE;
+
+                return this->tail + (block - this->fullBlocks) * BLOCK_SIZE;
+            }
+
+            const uint8_t* data;
+            uint64_t fullBlocks;
+            uint64_t blocks;
+            uint8_t tail[BLOCK_SIZE * 2];
+        };
+    };
+} // namespace love
@@ -3,8 +3,11 @@
 #include "common/Exception.hpp"
 
 #include "modules/data/misc/HashFunction.hpp"
+#include "modules/data/misc/HashKernels.hpp"
+#include "modules/data/misc/MultiBuffer.hpp"
 
 #include <cstring>
+#include <memory>
 
 namespace love
 {
@@ -35,50 +38,20 @@ namespace love
         };
 
       public:
-        bool isSupported(Function function) const override
+        SHA256() : kernel(kernels::getSHA256Kernel(getBackend()))
         {
-            return function == FUNCTION_SHA256 || function == FUNCTION_SHA224;
+            if (this->kernel == nullptr)
+                this->kernel = compress;
         }
 
-        void hash(Function function, const char* input, uint64_t length,
-                  Value& output) const override
+        static void compress(uint32_t state[8], const uint8_t* blocks, uint64_t count)
         {
-            if (!this->isSupported(function))
-                throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "SHA-224/SHA-256 implementation.");
-
-            uint64_t paddedLength = extend_multiple(length + 1 + 8, 64);
-            uint32_t* padded      = new uint32_t[paddedLength / 4];
-
-            std::memcpy(padded, input, length);
-            std::memset(((uint8_t*)padded) + length, 0, paddedLength - length);
-            *(((uint8_t*)padded) + length) = 0x80;
-
-            uint64_t bitLength = length * 8;
-            for (int index = 0; index < 8; ++index)
-            {
-                const uint64_t length = (bitLength >> (56 - index * 8)) & 0xFF;
-                *(((uint8_t*)padded) + (paddedLength - 8) + index) = length;
-            }
-
-            uint32_t intermediate[8] {};
-            if (function == FUNCTION_SHA224)
-                std::memcpy(intermediate, initial224, sizeof(intermediate));
-            else
-                std::memcpy(intermediate, initial256, sizeof(intermediate));
-
             uint32_t words[64] {};
-            for (uint64_t index = 0; index < paddedLength / 4; index += 16)
-            {
-                uint32_t* chunk = &padded[index];
 
+            for (uint64_t block = 0; block < count; block++, blocks += 64)
+            {
                 for (int j = 0; j < 16; j++)
-                {
-                    char* c = (char*)&words[j];
-                    c[0]    = (chunk[j] >> 24) & 0xFF;
-                    c[1]    = (chunk[j] >> 16) & 0xFF;
-                    c[2]    = (chunk[j] >> 8) & 0xFF;
-                    c[3]    = (chunk[j] >> 0) & 0xFF;
-                }
+                    words[j] = load32be(blocks + j * 4);
 
                 // clang-format off
                 for (int j = 16; j < 64; j++)
@@ -89,14 +62,14 @@ namespace love
                 }
                 // clang-format on
 
-                uint32_t A = intermediate[0];
-                uint32_t B = intermediate[1];
-                uint32_t C = intermediate[2];
-                uint32_t D = intermediate[3];
-                uint32_t E = intermediate[4];
-                uint32_t F = intermediate[5];
-                uint32_t G = intermediate[6];
-                uint32_t H = intermediate[7];
+                uint32_t A = state[0];
+                uint32_t B = state[1];
+                uint32_t C = state[2];
+                uint32_t D = state[3];
+                uint32_t E = state[4];
+                uint32_t F = state[5];
+                uint32_t G = state[6];
+                uint32_t H = state[7];
 
                 // clang-format off
                 for (int j = 0; j < 64; j++)
@@ -118,31 +91,158 @@ namespace love
                 }
                 // clang-format on
 
-                intermediate[0] += A;
-                intermediate[1] += B;
-                intermediate[2] += C;
-                intermediate[3] += D;
-                intermediate[4] += E;
-                intermediate[5] += F;
-                intermediate[6] += G;
-                intermediate[7] += H;
+                state[0] += A;
+                state[1] += B;
+                state[2] += C;
+                state[3] += D;
+                state[4] += E;
+                state[5] += F;
+                state[6] += G;
+                state[7] += H;
+            }
+        }
+
+        // Same rounds as compress(), one block from each of four messages.
+        static void compressLanes(Lanes state[8], const Lanes words[16])
+        {
+            Lanes schedule[64];
+            for (int j = 0; j < 16; j++)
+                schedule[j] = words[j];
+
+            // clang-format off
+            for (int j = 16; j < 64; j++)
+            {
+                Lanes sigma0 = rightrot(schedule[j-15], 7) ^ rightrot(schedule[j-15], 18) ^ (schedule[j-15] >> 3);
+                Lanes sigma1 = rightrot(schedule[j-2], 17) ^ rightrot(schedule[j-2], 19) ^ (schedule[j-2] >> 10);
+                schedule[j]  = sigma0 + sigma1 + schedule[j-7] + schedule[j-16];
+            }
+            // clang-format on
+
+            Lanes A = state[0];
+            Lanes B = state[1];
+            Lanes C = state[2];
+            Lanes D = state[3];
+            Lanes E = state[4];
+            Lanes F = state[5];
+            Lanes G = state[6];
+            Lanes H = state[7];
+
+            for (int j = 0; j < 64; j++)
+            {
+                Lanes temp1 = H + constants[j] + schedule[j];
+                temp1 += rightrot(E, 6) ^ rightrot(E, 11) ^ rightrot(E, 25);
+                temp1 += (E & F) ^ (~E & G);
+                Lanes temp2 = rightrot(A, 2) ^ rightrot(A, 13) ^ rightrot(A, 22);
+                temp2 += (A & B) ^ (A & C) ^ (B & C);
+
+                H = G;
+                G = F;
+                F = E;
+                E = D + temp1;
+                D = C;
+                C = B;
+                B = A;
+                A = temp1 + temp2;
             }
 
-            delete[] padded;
+            state[0] += A;
+            state[1] += B;
+            state[2] += C;
+            state[3] += D;
+            state[4] += E;
+            state[5] += F;
+            state[6] += G;
+            state[7] += H;
+        }
 
-            int hashLength = 32;
-            if (function == FUNCTION_SHA224)
-                hashLength = 28;
+        class Context : public BlockContext<64>
+        {
+          public:
+            Context(Function function, kernels::CompressFunction kernel) :
+                BlockContext(function),
+                kernel(kernel)
+            {
+                if (function == FUNCTION_SHA224)
+                    std::memcpy(this->state, initial224, sizeof(this->state));
+                else
+                    std::memcpy(this->state, initial256, sizeof(this->state));
+            }
 
-            for (int index = 0; index < hashLength; index += 4)
+            void finalize(Value& output) override
             {
-                output.data[index + 0] = (intermediate[index / 4] >> 24) & 0xFF;
-                output.data[index + 1] = (intermediate[index / 4] >> 16) & 0xFF;
-                output.data[index + 2] = (intermediate[index / 4] >> 8) & 0xFF;
-                output.data[index + 3] = (intermediate[index / 4] >> 0) & 0xFF;
+                this->pad(true);
+
+                int hashLength = 32;
+                if (this->function == FUNCTION_SHA224)
+                    hashLength = 28;
+
+                for (int index = 0; index < hashLength; index += 4)
+                {
+                    output.data[index + 0] = (this->state[index / 4] >> 24) & 0xFF;
+                    output.data[index + 1] = (this->state[index / 4] >> 16) & 0xFF;
+                    output.data[index + 2] = (this->state[index / 4] >> 8) & 0xFF;
+                    output.data[index + 3] = (this->state[index / 4] >> 0) & 0xFF;
+                }
+
+                output.size = hashLength;
             }
 
-            output.size = hashLength;
+          protected:
+            void processBlocks(const uint8_t* blocks, uint64_t count) override
+            {
+                this->kernel(this->state, blocks, count);
+            }
+
+          private:
+            kernels::CompressFunction kernel;
+            uint32_t state[8];
+        };
+
+        bool isSupported(Function function) const override
+        {
+            return function == FUNCTION_SHA256 || function == FUNCTION_SHA224;
         }
+
+        HashFunction::Context* newContext(Function function) const override
+        {
+            if (!this->isSupported(function))
+                throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "SHA-224/SHA-256 implementation.");
+
+            return new Context(function, this->kernel);
+        }
+
+        // Only worthwhile without SHA instructions; a hardware kernel beats four scalar lanes.
+        void hashMany(Function function, const char* const* inputs, const uint64_t* lengths,
+                      Value* outputs, size_t count) const override
+        {
+            if (this->kernel != compress)
+                return HashFunction::hashMany(function, inputs, lengths, outputs, count);
+
+            if (!this->isSupported(function))
+                throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "SHA-224/SHA-256 implementation.");
+
+            bool is224              = function == FUNCTION_SHA224;
+            const uint32_t* initial = is224 ? initial224 : initial256;
+            std::unique_ptr<uint32_t[][8]> states(new uint32_t[count][8]);
+
+            MultiBuffer::hash<8>(initial, true, inputs, lengths, count, compressLanes,
+                                 states.get());
+
+            for (size_t message = 0; message < count; message++)
+            {
+                size_t hashLength = is224 ? 28 : 32;
+
+                for (size_t index = 0; index < hashLength; index++)
+                {
+                    uint32_t word                = states[message][index / 4];
+                    outputs[message].data[index] = (word >> (24 - index % 4 * 8)) & 0xFF;
+                }
+
+                outputs[message].size = hashLength;
+            }
+        }
+
+      private:
+        kernels::CompressFunction kernel;
     } sha256;
 } // namespace love
@@ -45,55 +45,14 @@ namespace love
         };
 
       public:
-        bool isSupported(Function function) const override
-        {
-            return function == FUNCTION_SHA512 || function == FUNCTION_SHA384;
-        }
-
-        void hash(Function function, const char* input, uint64_t length,
-                  Value& output) const override
+        static void compress(uint64_t state[8], const uint8_t* blocks, uint64_t count)
         {
-            if (!this->isSupported(function))
-                throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "SHA-384/SHA-512 implementation.");
-
-            uint64_t intermediates[8] {};
-            if (function == FUNCTION_SHA384)
-                std::memcpy(intermediates, initial384, sizeof(intermediates));
-            else
-                std::memcpy(intermediates, initial512, sizeof(intermediates));
-
-            uint64_t paddedLength = extend_multiple(length + 1 + 16, 128);
-            uint64_t* padded      = new uint64_t[paddedLength / 8];
-
-            std::memcpy(padded, input, length);
-            std::memset(((uint8_t*)padded) + length, 0, paddedLength - length);
-            *(((uint8_t*)padded) + length) = 0x80;
-
-            uint64_t bitLength = length * 8;
-            for (int index = 0; index < 8; ++index)
-            {
-                const uint64_t length = (bitLength >> (56 - index * 8)) & 0xFF;
-                *(((uint8_t*)padded) + (paddedLength - 8 + index)) = length;
-            }
-
             uint64_t words[80] {};
 
-            for (uint64_t index = 0; index < paddedLength / 8; index += 16)
+            for (uint64_t block = 0; block < count; block++, blocks += 128)
             {
-                uint64_t* chunk = &padded[index];
-
                 for (int j = 0; j < 16; ++j)
-                {
-                    char* c = (char*)&words[j];
-                    c[0]    = (chunk[j] >> 56) & 0xFF;
-                    c[1]    = (chunk[j] >> 48) & 0xFF;
-                    c[2]    = (chunk[j] >> 40) & 0xFF;
-                    c[3]    = (chunk[j] >> 32) & 0xFF;
-                    c[4]    = (chunk[j] >> 24) & 0xFF;
-                    c[5]    = (chunk[j] >> 16) & 0xFF;
-                    c[6]    = (chunk[j] >> 8) & 0xFF;
-                    c[7]    = (chunk[j] >> 0) & 0xFF;
-                }
+                    words[j] = load64be(blocks + j * 8);
 
                 // clang-format off
                 for (int j = 16; j < 80; ++j)
@@ -104,14 +63,14 @@ namespace love
                 }
                 // clang-format on
 
-                uint64_t A = intermediates[0];
-                uint64_t B = intermediates[1];
-                uint64_t C = intermediates[2];
-                uint64_t D = intermediates[3];
-                uint64_t E = intermediates[4];
-                uint64_t F = intermediates[5];
-                uint64_t G = intermediates[6];
-                uint64_t H = intermediates[7];
+                uint64_t A = state[0];
+                uint64_t B = state[1];
+                uint64_t C = state[2];
+                uint64_t D = state[3];
+                uint64_t E = state[4];
+                uint64_t F = state[5];
+                uint64_t G = state[6];
+                uint64_t H = state[7];
 
                 // clang-format off
                 for (int j = 0; j < 80; ++j)
@@ -132,35 +91,68 @@ namespace love
                 }
                 // clang-format on
 
-                intermediates[0] += A;
-                intermediates[1] += B;
-                intermediates[2] += C;
-                intermediates[3] += D;
-                intermediates[4] += E;
-                intermediates[5] += F;
-                intermediates[6] += G;
-                intermediates[7] += H;
+                state[0] += A;
+                state[1] += B;
+                state[2] += C;
+                state[3] += D;
+                state[4] += E;
+                state[5] += F;
+                state[6] += G;
+                state[7] += H;
+            }
+        }
+
+        class Context : public BlockContext<128>
+        {
+          public:
+            Context(Function function) : BlockContext(function)
+            {
+                if (function == FUNCTION_SHA384)
+                    std::memcpy(this->state, initial384, sizeof(this->state));
+                else
+                    std::memcpy(this->state, initial512, sizeof(this->state));
             }
 
-            delete[] padded;
+            void finalize(Value& output) override
+            {
+                this->pad(true);
+
+                int hashLength = 64;
+                if (this->function == FUNCTION_SHA384)
+                    hashLength = 48;
+
+                for (int index = 0; index < hashLength; index += 8)
+                {
+                    uint64_t word = this->state[index / 8];
 
-            int hashLength = 64;
-            if (function == FUNCTION_SHA384)
-                hashLength = 48;
+                    for (int byte = 0; byte < 8; byte++)
+                        output.data[index + byte] = (word >> (56 - byte * 8)) & 0xFF;
+                }
 
-            for (int index = 0; index < hashLength; index += 8)
+                output.size = hashLength;
+            }
+
+          protected:
+            void processBlocks(const uint8_t* blocks, uint64_t count) override
             {
-                output.data[index + 0] = (intermediates[index / 8] >> 56) & 0xFF;
-                output.data[index + 1] = (intermediates[index / 8] >> 48) & 0xFF;
-                output.data[index + 2] = (intermediates[index / 8] >> 40) & 0xFF;
-                output.data[index + 3] = (intermediates[index / 8] >> 32) & 0xFF;
-                output.data[index + 4] = (intermediates[index / 8] >> 24) & 0xFF;
-                output.data[index + 5] = (intermediates[index / 8] >> 16) & 0xFF;
-                output.data[index + 6] = (intermediates[index / 8] >> 8) & 0xFF;
-                output.data[index + 7] = (intermediates[index / 8] >> 0) & 0xFF;
+                compress(this->state, blocks, count);
             }
 
-            output.size = hashLength;
+          private:
+            uint64_t state[8];
+        };
+
+        bool isSupported(Function function) const override
+        {
+            return function == FUNCTION_SHA512 || function == FUNCTION_SHA384;
+        }
+
+        HashFunction::Context* newContext(Function function) const override
+        {
+            if (!this->isSupported(function))
+                throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "SHA-384/SHA-512 implementation.");
+
+            return new Context(function);
         }
     } sha512;
 } // namespace love
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "common/Variant.hpp"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+namespace love
+{
+    // A compact binary encoding of the values luax_checkvariant returns without userdata: nil,
+    // booleans, numbers, strings and tables of them.
+    //
+    // Every value starts with a tag byte whose low four bits are its type and whose high four
+    // hold a count (an integer, a string length, a string index or an array length) when it is
+    // below 15. Larger counts store 15 there and the rest in a varint after the tag. Numbers
+    // that are integers within +/-2^53 are stored as varints and all others as 8-byte doubles.
+    // Strings of two or more bytes are numbered in the order they first appear, and repeats of
+    // one are written as its number. A table's tag holds the length of its array part, the
+    // keys 1 to #t. It is followed by a varint count of the remaining key/value pairs, then the
+    // array values, then the pairs.
+    class Serializer
+    {
+      public:
+        static constexpr uint8_t VERSION = 1;
+
+        // Deeper tables are rejected, both when encoding and decoding.
+        static constexpr int MAX_DEPTH = 512;
+
+        // Appends the encoding of `value` to `output`.
+        static void encode(const Variant& value, std::vector<char>& output);
+
+        // Decodes a value taking up exactly `size` bytes. Throws on malformed input.
+        static Variant decode(const char* bytes, size_t size);
+
+        static void writeVarint(std::vector<char>& output, uint64_t value);
+
+        // Advances `cursor` past the varint. Returns false when it is truncated or too long.
+        static bool readVarint(const char*& cursor, const char* end, uint64_t& value);
+    };
+} // namespace love
@@ -0,0 +1,774 @@
+#pragma once
+
+#include "common/Exception.hpp"
+
+#include "modules/data/misc/HashFunction.hpp"
+
+#include <cstring>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define LOVE_XXH3_NEON
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define LOVE_XXH3_SSE2
+#endif
+
+namespace love
+{
+    inline uint64_t load64le(const uint8_t* bytes)
+    {
+        return (uint64_t)load32le(bytes) | ((uint64_t)load32le(bytes + 4) << 32);
+    }
+
+    inline uint64_t leftrot(uint64_t x, uint8_t amount)
+    {
+        return (x << amount) | (x >> (64 - amount));
+    }
+
+    inline void store64be(uint8_t* bytes, uint64_t value)
+    {
+        for (int index = 0; index < 8; index++)
+            bytes[index] = (value >> (56 - index * 8)) & 0xFF;
+    }
+
+    // XXH64 and XXH3 (64 and 128-bit) with the default secret and a zero seed.
+    // Digests are written in canonical (big endian) form.
+    class XXHash : public HashFunction
+    {
+      private:
+        static constexpr uint32_t PRIME32_1 = 0x9E3779B1;
+        static constexpr uint32_t PRIME32_2 = 0x85EBCA77;
+        static constexpr uint32_t PRIME32_3 = 0xC2B2AE3D;
+
+        static constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87;
+        static constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4F;
+        static constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9;
+        static constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63;
+        static constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5;
+
+        static constexpr uint64_t PRIME_MX1 = 0x165667919E3779F9;
+        static constexpr uint64_t PRIME_MX2 = 0x9FB21C651E98DF25;
+
+        static constexpr size_t STRIPE_SIZE       = 64;
+        static constexpr size_t SECRET_SIZE       = 192;
+        static constexpr size_t STRIPES_PER_BLOCK = (SECRET_SIZE - STRIPE_SIZE) / 8;
+        static constexpr size_t MIDSIZE_MAX       = 240;
+
+        // clang-format off
+        alignas(64) static constexpr uint8_t secret[SECRET_SIZE] = {
+            0xB8, 0xFE, 0x6C, 0x39, 0x23, 0xA4, 0x4B, 0xBE, 0x7C, 0x01, 0x81, 0x2C, 0xF7, 0x21, 0xAD, 0x1C,
+            0xDE, 0xD4, 0x6D, 0xE9, 0x83, 0x90, 0x97, 0xDB, 0x72, 0x40, 0xA4, 0xA4, 0xB7, 0xB3, 0x67, 0x1F,
+            0xCB, 0x79, 0xE6, 0x4E, 0xCC, 0xC0, 0xE5, 0x78, 0x82, 0x5A, 0xD0, 0x7D, 0xCC, 0xFF, 0x72, 0x21,
+            0xB8, 0x08, 0x46, 0x74, 0xF7, 0x43, 0x24, 0x8E, 0xE0, 0x35, 0x90, 0xE6, 0x81, 0x3A, 0x26, 0x4C,
+            0x3C, 0x28, 0x52, 0xBB, 0x91, 0xC3, 0x00, 0xCB, 0x88, 0xD0, 0x65, 0x8B, 0x1B, 0x53, 0x2E, 0xA3,
+            0x71, 0x64, 0x48, 0x97, 0xA2, 0x0D, 0xF9, 0x4E, 0x38, 0x19, 0xEF, 0x46, 0xA9, 0xDE, 0xAC, 0xD8,
+            0xA8, 0xFA, 0x76, 0x3F, 0xE3, 0x9C, 0x34, 0x3F, 0xF9, 0xDC, 0xBB, 0xC7, 0xC7, 0x0B, 0x4F, 0x1D,
+            0x8A, 0x51, 0xE0, 0x4B, 0xCD, 0xB4, 0x59, 0x31, 0xC8, 0x9F, 0x7E, 0xC9, 0xD9, 0x78, 0x73, 0x64,
+            0xEA, 0xC5, 0xAC, 0x83, 0x34, 0xD3, 0xEB, 0xC3, 0xC5, 0x81, 0xA0, 0xFF, 0xFA, 0x13, 0x63, 0xEB,
+            0x17, 0x0D, 0xDD, 0x51, 0xB7, 0xF0, 0xDA, 0x49, 0xD3, 0x16, 0x55, 0x26, 0x29, 0xD4, 0x68, 0x9E,
+            0x2B, 0x16, 0xBE, 0x58, 0x7D, 0x47, 0xA1, 0xFC, 0x8F, 0xF8, 0xB8, 0xD1, 0x7A, 0xD0, 0x31, 0xCE,
+            0x45, 0xCB, 0x3A, 0x8F, 0x95, 0x16, 0x04, 0x28, 0xAF, 0xD7, 0xFB, 0xCA, 0xBB, 0x4B, 0x40, 0x7E,
+        };
+        // clang-format on
+
+        struct Hash128
+        {
+            uint64_t low;
+            uint64_t high;
+        };
+
+        static Hash128 multiply(uint64_t lhs, uint64_t rhs)
+        {
+            unsigned __int128 product = (unsigned __int128)lhs * rhs;
+            return { (uint64_t)product, (uint64_t)(product >> 64) };
+        }
+
+        static uint64_t multiplyFold(uint64_t lhs, uint64_t rhs)
+        {
+            Hash128 product = multiply(lhs, rhs);
+            return product.low ^ product.high;
+        }
+
+        static uint64_t swap64(uint64_t x)
+        {
+            return __builtin_bswap64(x);
+        }
+
+        static uint64_t xxh64Round(uint64_t accumulator, uint64_t input)
+        {
+            accumulator += input * PRIME64_2;
+            accumulator = leftrot(accumulator, 31);
+            return accumulator * PRIME64_1;
+        }
+
+        static uint64_t xxh64Merge(uint64_t accumulator, uint64_t value)
+        {
+            accumulator ^= xxh64Round(0, value);
+            return accumulator * PRIME64_1 + PRIME64_4;
+        }
+
+        static uint64_t xxh64Avalanche(uint64_t hash)
+        {
+            hash ^= hash >> 33;
+            hash *= PRIME64_2;
+            hash ^= hash >> 29;
+            hash *= PRIME64_3;
+            hash ^= hash >> 32;
+            return hash;
+        }
+
+        // Mixes in the last 0-31 bytes of input.
+        static uint64_t xxh64Finalize(uint64_t hash, const uint8_t* bytes, size_t length)
+        {
+            for (; length >= 8; length -= 8, bytes += 8)
+            {
+                hash ^= xxh64Round(0, load64le(bytes));
+                hash = leftrot(hash, 27) * PRIME64_1 + PRIME64_4;
+            }
+
+            if (length >= 4)
+            {
+                hash ^= (uint64_t)load32le(bytes) * PRIME64_1;
+                hash = leftrot(hash, 23) * PRIME64_2 + PRIME64_3;
+                bytes += 4;
+                length -= 4;
+            }
+
+            for (; length > 0; length--, bytes++)
+            {
+                hash ^= *bytes * PRIME64_5;
+                hash = leftrot(hash, 11) * PRIME64_1;
+            }
+
+            return xxh64Avalanche(hash);
+        }
+
+        static uint64_t xxh3Avalanche(uint64_t hash)
+        {
+            hash ^= hash >> 37;
+            hash *= PRIME_MX1;
+            return hash ^ (hash >> 32);
+        }
+
+        static uint64_t xxh3Mix16(const uint8_t* input, const uint8_t* key)
+        {
+            uint64_t low  = load64le(input) ^ load64le(key);
+            uint64_t high = load64le(input + 8) ^ load64le(key + 8);
+
+            return multiplyFold(low, high);
+        }
+
+        static uint64_t xxh3Short64(const uint8_t* input, size_t length)
+        {
+            if (length > 8)
+            {
+                uint64_t bitflipLow  = load64le(secret + 24) ^ load64le(secret + 32);
+                uint64_t bitflipHigh = load64le(secret + 40) ^ load64le(secret + 48);
+
+                uint64_t low  = load64le(input) ^ bitflipLow;
+                uint64_t high = load64le(input + length - 8) ^ bitflipHigh;
+
+                return xxh3Avalanche(length + swap64(low) + high + multiplyFold(low, high));
+            }
+            else if (length >= 4)
+            {
+                uint64_t bitflip = load64le(secret + 8) ^ load64le(secret + 16);
+                uint64_t input64 = load32le(input + length - 4) + ((uint64_t)load32le(input) << 32);
+                uint64_t hash    = input64 ^ bitflip;
+
+                hash ^= leftrot(hash, 49) ^ leftrot(hash, 24);
+                hash *= PRIME_MX2;
+                hash ^= (hash >> 35) + length;
+                hash *= PRIME_MX2;
+                return hash ^ (hash >> 28);
+            }
+            else if (length > 0)
+            {
+                uint32_t combined = ((uint32_t)input[0] << 16) |
+                                    ((uint32_t)input[length >> 1] << 24) |
+                                    (uint32_t)input[length - 1] | ((uint32_t)length << 8);
+
+                uint64_t bitflip = load32le(secret) ^ load32le(secret + 4);
+                return xxh64Avalanche(combined ^ bitflip);
+            }
+
+            return xxh64Avalanche(load64le(secret + 56) ^ load64le(secret + 64));
+        }
+
+        static uint64_t xxh3Mid64(const uint8_t* input, size_t length)
+        {
+            uint64_t accumulator = length * PRIME64_1;
+
+            if (length <= 128)
+            {
+                size_t rounds = (length - 1) / 32;
+                for (size_t index = 0; index <= rounds; index++)
+                {
+                    const uint8_t* tail = input + length - 16 * (index + 1);
+
+                    accumulator += xxh3Mix16(input + 16 * index, secret + 32 * index);
+                    accumulator += xxh3Mix16(tail, secret + 32 * index + 16);
+                }
+
+                return xxh3Avalanche(accumulator);
+            }
+
+            for (size_t index = 0; index < 8; index++)
+                accumulator += xxh3Mix16(input + 16 * index, secret + 16 * index);
+
+            accumulator = xxh3Avalanche(accumulator);
+
+            uint64_t end = xxh3Mix16(input + length - 16, secret + 136 - 17);
+            for (size_t index = 8; index < length / 16; index++)
+                end += xxh3Mix16(input + 16 * index, secret + 16 * (index - 8) + 3);
+
+            return xxh3Avalanche(accumulator + end);
+        }
+
+        static Hash128 xxh3Mix32(Hash128 accumulator, const uint8_t* first, const uint8_t* second,
+                                 const uint8_t* key)
+        {
+            accumulator.low += xxh3Mix16(first, key);
+            accumulator.low ^= load64le(second) + load64le(second + 8);
+            accumulator.high += xxh3Mix16(second, key + 16);
+            accumulator.high ^= load64le(first) + load64le(first + 8);
+
+            return accumulator;
+        }
+
+        static Hash128 xxh3Short128(const uint8_t* input, size_t length)
+        {
+            if (length > 8)
+            {
+                uint64_t bitflipLow  = load64le(secret + 32) ^ load64le(secret + 40);
+                uint64_t bitflipHigh = load64le(secret + 48) ^ load64le(secret + 56);
+                uint64_t low         = load64le(input);
+                uint64_t high        = load64le(input + length - 8);
+
+                Hash128 mixed = multiply(low ^ high ^ bitflipLow, PRIME64_1);
+                mixed.low += (uint64_t)(length - 1) << 54;
+                high ^= bitflipHigh;
+                mixed.high += high + (uint64_t)(uint32_t)high * (PRIME32_2 - 1);
+                mixed.low ^= swap64(mixed.high);
+
+                Hash128 result = multiply(mixed.low, PRIME64_2);
+                result.high += mixed.high * PRIME64_2;
+
+                return { xxh3Avalanche(result.low), xxh3Avalanche(result.high) };
+            }
+            else if (length >= 4)
+            {
+                uint64_t input64 = load32le(input) + ((uint64_t)load32le(input + length - 4) << 32);
+                uint64_t bitflip = load64le(secret + 16) ^ load64le(secret + 24);
+
+                Hash128 mixed = multiply(input64 ^ bitflip, PRIME64_1 + (length << 2));
+                mixed.high += mixed.low << 1;
+                mixed.low ^= mixed.high >> 3;
+
+                mixed.low ^= mixed.low >> 35;
+                mixed.low *= PRIME_MX2;
+                mixed.low ^= mixed.low >> 28;
+
+                return { mixed.low, xxh3Avalanche(mixed.high) };
+            }
+            else if (length > 0)
+            {
+                uint32_t combinedLow = ((uint32_t)input[0] << 16) |
+                                       ((uint32_t)input[length >> 1] << 24) |
+                                       (uint32_t)input[length - 1] | ((uint32_t)length << 8);
+                uint32_t combinedHigh = leftrot(__builtin_bswap32(combinedLow), 13);
+
+                uint64_t bitflipLow  = load32le(secret) ^ load32le(secret + 4);
+                uint64_t bitflipHigh = load32le(secret + 8) ^ load32le(secret + 12);
+
+                return { xxh64Avalanche(combinedLow ^ bitflipLow),
+                         xxh64Avalanche(combinedHigh ^ bitflipHigh) };
+            }
+
+            uint64_t bitflipLow  = load64le(secret + 64) ^ load64le(secret + 72);
+            uint64_t bitflipHigh = load64le(secret + 80) ^ load64le(secret + 88);
+
+            return { xxh64Avalanche(bitflipLow), xxh64Avalanche(bitflipHigh) };
+        }
+
+        static Hash128 xxh3Mid128(const uint8_t* input, size_t length)
+        {
+            Hash128 accumulator = { length * PRIME64_1, 0 };
+
+            if (length <= 128)
+            {
+                size_t rounds = (length - 1) / 32;
+                for (size_t index = rounds + 1; index-- > 0;)
+                {
+                    const uint8_t* first  = input + 16 * index;
+                    const uint8_t* second = input + length - 16 * (index + 1);
+
+                    accumulator = xxh3Mix32(accumulator, first, second, secret + 32 * index);
+                }
+            }
+            else
+            {
+                for (size_t offset = 32; offset < 160; offset += 32)
+                {
+                    const uint8_t* first = input + offset - 32;
+                    accumulator = xxh3Mix32(accumulator, first, first + 16, secret + offset - 32);
+                }
+
+                accumulator.low  = xxh3Avalanche(accumulator.low);
+                accumulator.high = xxh3Avalanche(accumulator.high);
+
+                for (size_t offset = 160; offset <= length; offset += 32)
+                {
+                    const uint8_t* first = input + offset - 32;
+                    const uint8_t* key   = secret + 3 + offset - 160;
+                    accumulator          = xxh3Mix32(accumulator, first, first + 16, key);
+                }
+
+                const uint8_t* last = input + length - 16;
+                const uint8_t* key  = secret + 136 - 17 - 16;
+                accumulator         = xxh3Mix32(accumulator, last, last - 16, key);
+            }
+
+            uint64_t low  = accumulator.low + accumulator.high;
+            uint64_t high = accumulator.low * PRIME64_1 + accumulator.high * PRIME64_4 +
+                            length * PRIME64_2;
+
+            return { xxh3Avalanche(low), 0 - xxh3Avalanche(high) };
+        }
+
+        // Accumulates one 64-byte stripe into the eight 64-bit lanes.
+        static void accumulateStripe(uint64_t* accumulator, const uint8_t* input,
+                                     const uint8_t* key)
+        {
+#if defined(LOVE_XXH3_NEON)
+            for (size_t index = 0; index < 4; index++)
+            {
+                uint64x2_t lanes = vld1q_u64(accumulator + index * 2);
+                uint64x2_t data  = vreinterpretq_u64_u8(vld1q_u8(input + index * 16));
+                uint64x2_t keys  = vreinterpretq_u64_u8(vld1q_u8(key + index * 16));
+                uint64x2_t keyed = veorq_u64(data, keys);
+
+                lanes = vaddq_u64(lanes, vextq_u64(data, data, 1));
+                lanes = vmlal_u32(lanes, vmovn_u64(keyed), vshrn_n_u64(keyed, 32));
+
+                vst1q_u64(accumulator + index * 2, lanes);
+            }
+#elif defined(LOVE_XXH3_SSE2)
+            for (size_t index = 0; index < 4; index++)
+            {
+                __m128i* lanes = (__m128i*)accumulator + index;
+                __m128i data   = _mm_loadu_si128((const __m128i*)input + index);
+                __m128i keyed  = _mm_xor_si128(data, _mm_loadu_si128((const __m128i*)key + index));
+
+                __m128i shifted = _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1));
+                __m128i product = _mm_mul_epu32(keyed, shifted);
+                __m128i swapped = _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2));
+
+                *lanes = _mm_add_epi64(product, _mm_add_epi64(*lanes, swapped));
+            }
+#else
+            for (size_t lane = 0; lane < 8; lane++)
+            {
+                uint64_t data  = load64le(input + lane * 8);
+                uint64_t keyed = data ^ load64le(key + lane * 8);
+
+                accumulator[lane ^ 1] += data;
+                accumulator[lane] += (keyed & 0xFFFFFFFF) * (keyed >> 32);
+            }
+#endif
+        }
+
+        static void scramble(uint64_t* accumulator)
+        {
+            const uint8_t* key = secret + SECRET_SIZE - STRIPE_SIZE;
+
+#if defined(LOVE_XXH3_NEON)
+            for (size_t index = 0; index < 4; index++)
+            {
+                uint64x2_t lanes = vld1q_u64(accumulator + index * 2);
+
+                lanes = veorq_u64(lanes, vshrq_n_u64(lanes, 47));
+                lanes = veorq_u64(lanes, vreinterpretq_u64_u8(vld1q_u8(key + index * 16)));
+
+                uint64x2_t high = vshlq_n_u64(vmull_n_u32(vshrn_n_u64(lanes, 32), PRIME32_1), 32);
+                vst1q_u64(accumulator + index * 2, vmlal_n_u32(high, vmovn_u64(lanes), PRIME32_1));
+            }
+#elif defined(LOVE_XXH3_SSE2)
+            const __m128i prime = _mm_set1_epi32((int)PRIME32_1);
+
+            for (size_t index = 0; index < 4; index++)
+            {
+                __m128i* lanes = (__m128i*)accumulator + index;
+                __m128i value  = _mm_xor_si128(*lanes, _mm_srli_epi64(*lanes, 47));
+                value          = _mm_xor_si128(value, _mm_loadu_si128((const __m128i*)key + index));
+
+                __m128i shifted = _mm_shuffle_epi32(value, _MM_SHUFFLE(0, 3, 0, 1));
+                __m128i low     = _mm_mul_epu32(value, prime);
+                __m128i high    = _mm_mul_epu32(shifted, prime);
+
+                *lanes = _mm_add_epi64(low, _mm_slli_epi64(high, 32));
+            }
+#else
+            for (size_t lane = 0; lane < 8; lane++)
+            {
+                uint64_t value = accumulator[lane];
+                value ^= value >> 47;
+                value ^= load64le(key + lane * 8);
+                accumulator[lane] = value * PRIME32_1;
+            }
+#endif
+        }
+
+        // Consumes whole stripes, scrambling at the end of each block. `stripes` tracks the
+        // position within the current block.
+        static void consumeStripes(uint64_t* accumulator, size_t& stripes, const uint8_t* input,
+                                   size_t count)
+        {
+            for (size_t index = 0; index < count; index++, input += STRIPE_SIZE)
+            {
+                accumulateStripe(accumulator, input, secret + stripes * 8);
+
+                if (++stripes == STRIPES_PER_BLOCK)
+                {
+                    scramble(accumulator);
+                    stripes = 0;
+                }
+            }
+        }
+
+        static uint64_t mergeAccumulators(const uint64_t* accumulator, const uint8_t* key,
+                                          uint64_t start)
+        {
+            for (size_t index = 0; index < 4; index++)
+            {
+                uint64_t low  = accumulator[index * 2] ^ load64le(key + index * 16);
+                uint64_t high = accumulator[index * 2 + 1] ^ load64le(key + index * 16 + 8);
+                start += multiplyFold(low, high);
+            }
+
+            return xxh3Avalanche(start);
+        }
+
+        static Hash128 xxh3Merge(const uint64_t* accumulator, uint64_t length, bool wide)
+        {
+            Hash128 result {};
+            result.low = mergeAccumulators(accumulator, secret + 11, length * PRIME64_1);
+
+            if (wide)
+            {
+                const uint8_t* key = secret + SECRET_SIZE - 64 - 11;
+                result.high        = mergeAccumulators(accumulator, key, ~(length * PRIME64_2));
+            }
+
+            return result;
+        }
+
+        static void initAccumulator(uint64_t* accumulator)
+        {
+            accumulator[0] = PRIME32_3;
+            accumulator[1] = PRIME64_1;
+            accumulator[2] = PRIME64_2;
+            accumulator[3] = PRIME64_3;
+            accumulator[4] = PRIME64_4;
+            accumulator[5] = PRIME32_2;
+            accumulator[6] = PRIME64_5;
+            accumulator[7] = PRIME32_1;
+        }
+
+        static Hash128 xxh3Long(const uint8_t* input, uint64_t length, bool wide)
+        {
+            alignas(16) uint64_t accumulator[8];
+            initAccumulator(accumulator);
+
+            size_t stripes = 0;
+            consumeStripes(accumulator, stripes, input, (size_t)((length - 1) / STRIPE_SIZE));
+
+            const uint8_t* last = input + length - STRIPE_SIZE;
+            accumulateStripe(accumulator, last, secret + SECRET_SIZE - STRIPE_SIZE - 7);
+
+            return xxh3Merge(accumulator, length, wide);
+        }
+
+        static void output64(Value& output, uint64_t hash)
+        {
+            store64be((uint8_t*)output.data, hash);
+            output.size = 8;
+        }
+
+        static void output128(Value& output, Hash128 hash)
+        {
+            store64be((uint8_t*)output.data, hash.high);
+            store64be((uint8_t*)output.data + 8, hash.low);
+            output.size = 16;
+        }
+
+      public:
+        static uint64_t xxh64(const uint8_t* input, uint64_t length)
+        {
+            const uint8_t* end = input + length;
+            uint64_t hash      = 0;
+
+            if (length >= 32)
+            {
+                uint64_t lanes[4] = { PRIME64_1 + PRIME64_2, PRIME64_2, 0, 0 - PRIME64_1 };
+
+                for (; end - input >= 32; input += 32)
+                {
+                    for (int lane = 0; lane < 4; lane++)
+                        lanes[lane] = xxh64Round(lanes[lane], load64le(input + lane * 8));
+                }
+
+                hash = leftrot(lanes[0], 1) + leftrot(lanes[1], 7) + leftrot(lanes[2], 12) +
+                       leftrot(lanes[3], 18);
+
+                for (int lane = 0; lane < 4; lane++)
+                    hash = xxh64Merge(hash, lanes[lane]);
+            }
+            else
+                hash = PRIME64_5;
+
+            hash += length;
+            return xxh64Finalize(hash, input, (size_t)(end - input));
+        }
+
+        static uint64_t xxh3_64(const uint8_t* input, uint64_t length)
+        {
+            if (length <= 16)
+                return xxh3Short64(input, (size_t)length);
+            else if (length <= MIDSIZE_MAX)
+                return xxh3Mid64(input, (size_t)length);
+
+            return xxh3Long(input, length, false).low;
+        }
+
+        static Hash128 xxh3_128(const uint8_t* input, uint64_t length)
+        {
+            if (length <= 16)
+                return xxh3Short128(input, (size_t)length);
+            else if (length <= MIDSIZE_MAX)
+                return xxh3Mid128(input, (size_t)length);
+
+            return xxh3Long(input, length, true);
+        }
+
+        class XXH64Context : public HashFunction::Context
+        {
+          public:
+            XXH64Context(Function function) : Context(function)
+            {}
+
+            void update(const char* input, uint64_t length) override
+            {
+                const uint8_t* bytes = (const uint8_t*)input;
+                this->totalLength += length;
+
+                if (this->buffered + length < 32)
+                {
+                    std::memcpy(this->buffer + this->buffered, bytes, (size_t)length);
+                    this->buffered += (size_t)length;
+                    return;
+                }
+
+                if (this->buffered > 0)
+                {
+                    size_t copy = 32 - this->buffered;
+                    std::memcpy(this->buffer + this->buffered, bytes, copy);
+
+                    this->consume(this->buffer);
+                    this->buffered = 0;
+
+                    bytes += copy;
+                    length -= copy;
+                }
+
+                for (; length >= 32; length -= 32, bytes += 32)
+                    this->consume(bytes);
+
+                std::memcpy(this->buffer, bytes, (size_t)length);
+                this->buffered = (size_t)length;
+            }
+
+            void finalize(Value& output) override
+            {
+                uint64_t hash = PRIME64_5;
+
+                if (this->totalLength >= 32)
+                {
+                    hash = leftrot(this->lanes[0], 1) + leftrot(this->lanes[1], 7) +
+                           leftrot(this->lanes[2], 12) + leftrot(this->lanes[3], 18);
+
+                    for (int lane = 0; lane < 4; lane++)
+                        hash = xxh64Merge(hash, this->lanes[lane]);
+                }
+
+                hash += this->totalLength;
+                output64(output, xxh64Finalize(hash, this->buffer, this->buffered));
+            }
+
+          private:
+            void consume(const uint8_t* bytes)
+            {
+                for (int lane = 0; lane < 4; lane++)
+                    this->lanes[lane] = xxh64Round(this->lanes[lane], load64le(bytes + lane * 8));
+            }
+
+            uint64_t lanes[4] = { PRIME64_1 + PRIME64_2, PRIME64_2, 0, 0 - PRIME64_1 };
+            uint8_t buffer[32];
+            size_t buffered      = 0;
+            uint64_t totalLength = 0;
+        };
+
+        // Stripes are only consumed once more input follows them, since the final stripe is
+        // processed with a different key. The last consumed stripe is kept at the end of the
+        // buffer for digests whose tail is shorter than a stripe.
+        class XXH3Context : public HashFunction::Context
+        {
+          public:
+            XXH3Context(Function function) : Context(function)
+            {
+                initAccumulator(this->accumulator);
+            }
+
+            void update(const char* input, uint64_t length) override
+            {
+                const uint8_t* bytes = (const uint8_t*)input;
+                this->totalLength += length;
+
+                if (this->buffered + length <= BUFFER_SIZE)
+                {
+                    std::memcpy(this->buffer + this->buffered, bytes, (size_t)length);
+                    this->buffered += (size_t)length;
+                    return;
+                }
+
+                if (this->buffered > 0)
+                {
+                    size_t copy = BUFFER_SIZE - this->buffered;
+                    std::memcpy(this->buffer + this->buffered, bytes, copy);
+
+                    consumeStripes(this->accumulator, this->stripes, this->buffer, BUFFER_STRIPES);
+                    this->buffered = 0;
+
+                    bytes += copy;
+                    length -= copy;
+                }
+
+                if (length > BUFFER_SIZE)
+                {
+                    size_t count = (size_t)((length - 1) / STRIPE_SIZE);
+                    consumeStripes(this->accumulator, this->stripes, bytes, count);
+
+                    bytes += count * STRIPE_SIZE;
+                    length -= count * STRIPE_SIZE;
+
+                    uint8_t* tail = this->buffer + BUFFER_SIZE - STRIPE_SIZE;
+                    std::memcpy(tail, bytes - STRIPE_SIZE, STRIPE_SIZE);
+                }
+
+                std::memcpy(this->buffer, bytes, (size_t)length);
+                this->buffered = (size_t)length;
+            }
+
+            void finalize(Value& output) override
+            {
+                bool wide = this->function == FUNCTION_XXH3_128;
+
+                if (this->totalLength <= MIDSIZE_MAX)
+                {
+                    if (wide)
+                        output128(output, xxh3_128(this->buffer, this->totalLength));
+                    else
+                        output64(output, xxh3_64(this->buffer, this->totalLength));
+
+                    return;
+                }
+
+                alignas(16) uint64_t accumulator[8];
+                std::memcpy(accumulator, this->accumulator, sizeof(accumulator));
+
+                uint8_t lastStripe[STRIPE_SIZE];
+                const uint8_t* last = lastStripe;
+
+                if (this->buffered >= STRIPE_SIZE)
+                {
+                    size_t stripes = this->stripes;
+                    size_t count   = (this->buffered - 1) / STRIPE_SIZE;
+                    consumeStripes(accumulator, stripes, this->buffer, count);
+
+                    last = this->buffer + this->buffered - STRIPE_SIZE;
+                }
+                else
+                {
+                    size_t carry = STRIPE_SIZE - this->buffered;
+                    std::memcpy(lastStripe, this->buffer + BUFFER_SIZE - carry, carry);
+                    std::memcpy(lastStripe + carry, this->buffer, this->buffered);
+                }
+
+                accumulateStripe(accumulator, last, secret + SECRET_SIZE - STRIPE_SIZE - 7);
+                Hash128 hash = xxh3Merge(accumulator, this->totalLength, wide);
+
+                if (wide)
+                    output128(output, hash);
+                else
+                    output64(output, hash.low);
+            }
+
+          private:
+            static constexpr size_t BUFFER_STRIPES = 4;
+            static constexpr size_t BUFFER_SIZE    = STRIPE_SIZE * BUFFER_STRIPES;
+
+            alignas(16) uint64_t accumulator[8];
+            uint8_t buffer[BUFFER_SIZE];
+            size_t buffered      = 0;
+            size_t stripes       = 0;
+            uint64_t totalLength = 0;
+        };
+
+        bool isSupported(Function function) const override
+        {
+            switch (function)
+            {
+                case FUNCTION_XXH64:
+                case FUNCTION_XXH3_64:
+                case FUNCTION_XXH3_128:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        HashFunction::Context* newContext(Function function) const override
+        {
+            if (!this->isSupported(function))
+                throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "xxHash implementation.");
+
+            if (function == FUNCTION_XXH64)
+                return new XXH64Context(function);
+
+            return new XXH3Context(function);
+        }
+
+        // One-shot hashing skips the context allocation and streaming bookkeeping.
+        void hash(Function function, const char* input, uint64_t length,
+                  Value& output) const override
+        {
+            const uint8_t* bytes = (const uint8_t*)input;
+
+            switch (function)
+            {
+                case FUNCTION_XXH64:
+                    output64(output, xxh64(bytes, length));
+                    break;
+                case FUNCTION_XXH3_64:
+                    output64(output, xxh3_64(bytes, length));
+                    break;
+                case FUNCTION_XXH3_128:
+                    output128(output, xxh3_128(bytes, length));
+                    break;
+                default:
+                    throw Exception(E_HASH_FUNCTION_NOT_SUPPORTED "xxHash implementation.");
+            }
+        }
+    } xxhash;
+} // namespace love
@@ -3,8 +3,12 @@
 #include "modules/data/misc/Compressor.hpp"
 
 #include "common/Exception.hpp"
+#include "common/ThreadPool.hpp"
 #include "common/int.hpp"
 
+#include <algorithm>
+#include <vector>
+
 #include <zlib.h>
 
 namespace love
@@ -12,6 +16,159 @@ namespace love
     class ZlibCompressor : public Compressor
     {
       private:
+        static int getDeflateWindowBits(Format format)
+        {
+            if (format == FORMAT_GZIP)
+                return 15 + 16;
+            else if (format == FORMAT_DEFLATE)
+                return -15;
+
+            return 15;
+        }
+
+        // Also detects zlib and gzip headers on its own.
+        static int getInflateWindowBits(Format format)
+        {
+            return format == FORMAT_DEFLATE ? -15 : 15 + 32;
+        }
+
+        static int clampLevel(int level)
+        {
+            if (level < 0)
+                return Z_DEFAULT_COMPRESSION;
+
+            return level > 9 ? 9 : level;
+        }
+
+        class DeflateStream : public Stream
+        {
+          public:
+            DeflateStream(Format format, int level) : Stream(format), stream {}
+            {
+                int windowBits = getDeflateWindowBits(format);
+                int error = deflateInit2(&this->stream, clampLevel(level), Z_DEFLATED, windowBits,
+                                         8, Z_DEFAULT_STRATEGY);
+
+                if (error == Z_MEM_ERROR)
+                    throw love::Exception(E_OUT_OF_MEMORY);
+                else if (error != Z_OK)
+                    throw love::Exception("Could not initialize zlib/gzip compression stream.");
+            }
+
+            virtual ~DeflateStream()
+            {
+                deflateEnd(&this->stream);
+            }
+
+            void push(const char* input, size_t size, std::vector<char>& output) override
+            {
+                this->run(input, size, Z_NO_FLUSH, output);
+            }
+
+            void finish(std::vector<char>& output) override
+            {
+                this->run(nullptr, 0, Z_FINISH, output);
+            }
+
+          private:
+            void run(const char* input, size_t size, int flush, std::vector<char>& output)
+            {
+                do
+                {
+                    // avail_in is only 32 bits wide.
+                    uInt piece = (uInt)std::min<size_t>(size, 1u << 30);
+
+                    this->stream.next_in  = (Bytef*)input;
+                    this->stream.avail_in = piece;
+
+                    input += piece;
+                    size -= piece;
+
+                    int status = Z_OK;
+
+                    do
+                    {
+                        size_t offset = output.size();
+                        output.resize(offset + STREAM_CHUNK_SIZE);
+
+                        this->stream.next_out  = (Bytef*)output.data() + offset;
+                        this->stream.avail_out = (uInt)STREAM_CHUNK_SIZE;
+
+                        status = deflate(&this->stream, size > 0 ? Z_NO_FLUSH : flush);
+                        output.resize(output.size() - this->stream.avail_out);
+
+                        if (status == Z_STREAM_ERROR)
+                            throw love::Exception("Could not zlib/gzip-compress data.");
+                    } while (this->stream.avail_out == 0);
+                } while (size > 0);
+            }
+
+            z_stream stream;
+        };
+
+        class InflateStream : public Stream
+        {
+          public:
+            InflateStream(Format format) : Stream(format), stream {}, ended(false)
+            {
+                int error = inflateInit2(&this->stream, getInflateWindowBits(format));
+
+                if (error == Z_MEM_ERROR)
+                    throw love::Exception(E_OUT_OF_MEMORY);
+                else if (error != Z_OK)
+                    throw love::Exception("Could not initialize zlib/gzip decompression stream.");
+            }
+
+            virtual ~InflateStream()
+            {
+                inflateEnd(&this->stream);
+            }
+
+            // Anything after the end of the compressed stream is ignored, like in decompress().
+            void push(const char* input, size_t size, std::vector<char>& output) override
+            {
+                while (size > 0 && !this->ended)
+                {
+                    uInt piece = (uInt)std::min<size_t>(size, 1u << 30);
+
+                    this->stream.next_in  = (Bytef*)input;
+                    this->stream.avail_in = piece;
+
+                    input += piece;
+                    size -= piece;
+
+                    do
+                    {
+                        size_t offset = output.size();
+                        output.resize(offset + STREAM_CHUNK_SIZE);
+
+                        this->stream.next_out  = (Bytef*)output.data() + offset;
+                        this->stream.avail_out = (uInt)STREAM_CHUNK_SIZE;
+
+                        int status = inflate(&this->stream, Z_NO_FLUSH);
+                        output.resize(output.size() - this->stream.avail_out);
+
+                        if (status == Z_STREAM_END)
+                            this->ended = true;
+                        else if (status == Z_MEM_ERROR)
+                            throw love::Exception(E_OUT_OF_MEMORY);
+                        else if (status != Z_OK && status != Z_BUF_ERROR)
+                            throw love::Exception(E_COULD_NOT_ZLIB_DECOMPRESS_DATA);
+                    } while (this->stream.avail_out == 0 && !this->ended);
+                }
+            }
+
+            void finish(std::vector<char>&) override
+            {
+                if (!this->ended)
+                    throw love::Exception(E_COMPRESSED_STREAM_TRUNCATED);
+            }
+
+          private:
+            z_stream stream;
+            bool ended;
+        };
+
         uLong zlibCompressBound(Format format, uLong sourceLen)
         {
             uLong size = sourceLen + (sourceLen >> 12) + (sourceLen >> 14) + (sourceLen >> 25) + 13;
@@ -22,74 +179,400 @@ namespace love
             return size;
         }
 
-        int zlibCompress(Format format, Bytef* destination, uLongf* destinationLength,
-                         const Bytef* source, uLong sourceLength, int level)
+        static int zlibCompress(z_stream* stream, Bytef* destination, uLongf* destinationLength,
+                                const Bytef* source, uLong sourceLength)
         {
-            z_stream stream {};
+            stream->next_in  = (Bytef*)source;
+            stream->avail_in = (uInt)sourceLength;
 
-            stream.next_in  = (Bytef*)source;
-            stream.avail_in = (uInt)sourceLength;
+            stream->next_out  = destination;
+            stream->avail_out = (uInt)(*destinationLength);
 
-            stream.next_out  = destination;
-            stream.avail_out = (uInt)(*destinationLength);
+            int error = deflate(stream, Z_FINISH);
 
-            int windowBits = 15;
-            if (format == FORMAT_GZIP)
-                windowBits += 16;
-            else if (format == FORMAT_DEFLATE)
-                windowBits = -windowBits;
+            if (error != Z_STREAM_END)
+                return error == Z_OK ? Z_BUF_ERROR : error;
 
-            int error = deflateInit2(&stream, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+            *destinationLength = stream->total_out;
+            return Z_OK;
+        }
 
-            if (error != Z_OK)
-                return error;
+        static int zlibDecompress(z_stream* stream, Bytef* destination, uLongf* destinationLength,
+                                  const Bytef* source, uLong sourceLength)
+        {
+            stream->next_in  = (Bytef*)source;
+            stream->avail_in = (uInt)sourceLength;
+
+            stream->next_out  = destination;
+            stream->avail_out = (uInt)(*destinationLength);
 
-            error = deflate(&stream, Z_FINISH);
+            int error = inflate(stream, Z_FINISH);
 
             if (error != Z_STREAM_END)
             {
-                deflateEnd(&stream);
-                return error == Z_OK ? Z_BUF_ERROR : error;
+                if (error == Z_NEED_DICT || (error == Z_BUF_ERROR && stream->avail_in == 0))
+                    return Z_DATA_ERROR;
+
+                return error;
             }
 
-            *destinationLength = stream.total_out;
-            return deflateEnd(&stream);
+            *destinationLength = stream->total_out;
+            return Z_OK;
         }
 
-        int zlibDecompress(Format format, Bytef* destination, uLongf* destinationLength,
-                           const Bytef* source, uLong sourceLength)
+        // Inputs at least this large are deflated in blocks on the thread pool, like pigz. Each
+        // block is primed with the 32 KB of input before it and all but the last end with a sync
+        // flush, so the pieces join into one stream that any inflater accepts.
+        static constexpr size_t PARALLEL_MIN_SIZE   = 1024 * 1024;
+        static constexpr size_t PARALLEL_BLOCK_SIZE = 128 * 1024;
+        static constexpr size_t WINDOW_SIZE         = 32 * 1024;
+
+        struct Block
         {
-            z_stream stream {};
+            size_t size;
+            uLong check;
+        };
 
-            stream.next_in  = (Bytef*)source;
-            stream.avail_in = (uInt)sourceLength;
+        static size_t deflateBlock(const char* data, size_t offset, size_t size, bool last,
+                                   int level, uint8_t* destination, size_t capacity)
+        {
+            z_stream& stream = *getDeflater(FORMAT_DEFLATE, level);
 
+            if (offset > 0)
+            {
+                size_t window = std::min(WINDOW_SIZE, offset);
+                deflateSetDictionary(&stream, (const Bytef*)data + offset - window, (uInt)window);
+            }
+
+            stream.next_in   = (Bytef*)data + offset;
+            stream.avail_in  = (uInt)size;
             stream.next_out  = destination;
-            stream.avail_out = (uInt)(*destinationLength);
+            stream.avail_out = (uInt)capacity;
 
-            int windowBits = 15 + 32;
-            if (format == FORMAT_DEFLATE)
-                windowBits = -15;
+            int status = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+            bool done  = last ? status == Z_STREAM_END : status == Z_OK && stream.avail_out > 0;
 
-            int error = inflateInit2(&stream, windowBits);
+            size_t written = capacity - stream.avail_out;
 
-            if (error != Z_OK)
-                return error;
+            if (!done || stream.avail_in > 0)
+                throw love::Exception("Could not zlib/gzip-compress data.");
 
-            error = inflate(&stream, Z_FINISH);
+            return written;
+        }
 
-            if (error != Z_STREAM_END)
+        static size_t writeHeader(Format format, int level, uint8_t* destination)
+        {
+            if (format == FORMAT_GZIP)
             {
-                inflateEnd(&stream);
+                // No name or timestamp, same as deflate() writes.
+                const uint8_t extra = level == 9 ? 2 : (level >= 0 && level < 2) ? 4 : 0;
+                const uint8_t header[10] = { 0x1F, 0x8B, Z_DEFLATED, 0, 0, 0, 0, 0, extra, 3 };
 
-                if (error == Z_NEED_DICT || (error == Z_BUF_ERROR && stream.avail_in == 0))
-                    return Z_DATA_ERROR;
+                std::memcpy(destination, header, sizeof(header));
+                return sizeof(header);
+            }
+            else if (format == FORMAT_ZLIB)
+            {
+                int levelFlags = 2;
+                if (level >= 0 && level < 2)
+                    levelFlags = 0;
+                else if (level >= 2 && level < 6)
+                    levelFlags = 1;
+                else if (level > 6)
+                    levelFlags = 3;
+
+                unsigned header = (0x78 << 8) | (levelFlags << 6);
+                header += 31 - header % 31;
+
+                destination[0] = (uint8_t)(header >> 8);
+                destination[1] = (uint8_t)header;
+                return 2;
+            }
 
-                return error;
+            return 0;
+        }
+
+        char* parallelCompress(Format format, const char* data, size_t dataSize, int level,
+                               size_t& compressedSize)
+        {
+            size_t blocks   = (dataSize + PARALLEL_BLOCK_SIZE - 1) / PARALLEL_BLOCK_SIZE;
+            size_t slotSize = zlibCompressBound(FORMAT_DEFLATE, PARALLEL_BLOCK_SIZE) + 16;
+
+            // Room for the gzip header and trailer, the largest of the three formats.
+            size_t maxSize = 10 + blocks * slotSize + 8;
+            uint8_t* bytes = nullptr;
+
+            try
+            {
+                bytes = new uint8_t[maxSize];
+            }
+            catch (std::bad_alloc&)
+            {
+                throw love::Exception(E_OUT_OF_MEMORY);
+            }
+
+            uint8_t* position = bytes + writeHeader(format, level, bytes);
+            uint8_t* slots    = bytes + 10;
+
+            std::vector<Block> results(blocks);
+
+            try
+            {
+                ThreadPool::getInstance().parallelFor(blocks, [&](size_t index) {
+                    size_t offset = index * PARALLEL_BLOCK_SIZE;
+                    size_t size   = std::min(PARALLEL_BLOCK_SIZE, dataSize - offset);
+
+                    const Bytef* input = (const Bytef*)data + offset;
+                    uint8_t* slot      = slots + index * slotSize;
+                    bool last          = index == blocks - 1;
+
+                    results[index].size = deflateBlock(data, offset, size, last, level, slot,
+                                                       slotSize);
+
+                    if (format == FORMAT_GZIP)
+                        results[index].check = crc32(0, input, (uInt)size);
+                    else if (format == FORMAT_ZLIB)
+                        results[index].check = adler32(1, input, (uInt)size);
+                });
+            }
+            catch (...)
+            {
+                delete[] bytes;
+                throw;
+            }
+
+            uLong check = format == FORMAT_GZIP ? crc32(0, nullptr, 0) : adler32(0, nullptr, 0);
+
+            for (size_t index = 0; index < blocks; index++)
+            {
+                std::memmove(position, slots + index * slotSize, results[index].size);
+                position += results[index].size;
+
+                size_t offset = index * PARALLEL_BLOCK_SIZE;
+                z_off_t size  = (z_off_t)std::min(PARALLEL_BLOCK_SIZE, dataSize - offset);
+
+                if (format == FORMAT_GZIP)
+                    check = crc32_combine(check, results[index].check, size);
+                else if (format == FORMAT_ZLIB)
+                    check = adler32_combine(check, results[index].check, size);
             }
 
-            *destinationLength = stream.total_out;
-            return inflateEnd(&stream);
+            if (format == FORMAT_GZIP)
+            {
+                for (int index = 0; index < 4; index++)
+                    *position++ = (uint8_t)(check >> (index * 8));
+
+                for (int index = 0; index < 4; index++)
+                    *position++ = (uint8_t)(dataSize >> (index * 8));
+            }
+            else if (format == FORMAT_ZLIB)
+            {
+                for (int index = 3; index >= 0; index--)
+                    *position++ = (uint8_t)(check >> (index * 8));
+            }
+
+            compressedSize = (size_t)(position - bytes);
+
+            if ((double)maxSize / (double)compressedSize >= 1.3)
+            {
+                char* shrunk = new (std::nothrow) char[compressedSize];
+
+                if (shrunk)
+                {
+                    std::memcpy(shrunk, bytes, compressedSize);
+                    delete[] bytes;
+                    return shrunk;
+                }
+            }
+
+            return (char*)bytes;
+        }
+
+        static void initDeflate(z_stream& stream, Format format, int level)
+        {
+            stream    = z_stream {};
+            int error = deflateInit2(&stream, level, Z_DEFLATED, getDeflateWindowBits(format), 8,
+                                     Z_DEFAULT_STRATEGY);
+
+            if (error == Z_MEM_ERROR)
+                throw love::Exception(E_OUT_OF_MEMORY);
+            else if (error != Z_OK)
+                throw love::Exception("Could not zlib/gzip-compress data.");
+        }
+
+        static void initInflate(z_stream& stream, Format format)
+        {
+            stream    = z_stream {};
+            int error = inflateInit2(&stream, getInflateWindowBits(format));
+
+            if (error == Z_MEM_ERROR)
+                throw love::Exception(E_OUT_OF_MEMORY);
+            else if (error != Z_OK)
+                throw love::Exception(E_COULD_NOT_ZLIB_DECOMPRESS_DATA);
+        }
+
+        // deflateInit2 allocates about 256 KB of window and hash tables at the default memLevel;
+        // inflateInit2 allocates a 32 KB window and about 7 KB of state.
+        static constexpr size_t DEFLATE_STATE_SIZE = 256 * 1024;
+        static constexpr size_t INFLATE_STATE_SIZE = 39 * 1024;
+
+        static void freeDeflater(z_stream* stream)
+        {
+            deflateEnd(stream);
+            delete stream;
+        }
+
+        static void freeInflater(z_stream* stream)
+        {
+            inflateEnd(stream);
+            delete stream;
+        }
+
+        static size_t getDeflaterSize(const z_stream*)
+        {
+            return DEFLATE_STATE_SIZE;
+        }
+
+        static size_t getInflaterSize(const z_stream*)
+        {
+            return INFLATE_STATE_SIZE;
+        }
+
+        // The header type and level are fixed when a deflater is set up, so each thread keeps one
+        // per combination it has used. Most programs only ever use one or two.
+        static z_stream* getDeflater(Format format, int level)
+        {
+            using Deflater = ThreadContext<z_stream, freeDeflater, getDeflaterSize>;
+            thread_local Deflater deflaters[FORMAT_DEFLATE - FORMAT_GZIP + 1][10 + 1];
+
+            Deflater& deflater = deflaters[format - FORMAT_GZIP][level + 1];
+
+            if (z_stream* stream = deflater.get())
+            {
+                deflateReset(stream);
+                return stream;
+            }
+
+            auto* stream = new (std::nothrow) z_stream {};
+
+            if (stream == nullptr)
+                throw love::Exception(E_OUT_OF_MEMORY);
+
+            try
+            {
+                initDeflate(*stream, format, level);
+            }
+            catch (love::Exception&)
+            {
+                delete stream;
+                throw;
+            }
+
+            return deflater.set(stream);
+        }
+
+        // inflateReset2 switches the header handling and keeps the window, so one is enough.
+        static z_stream* getInflater(Format format)
+        {
+            using Inflater = ThreadContext<z_stream, freeInflater, getInflaterSize>;
+            thread_local Inflater inflater;
+
+            if (z_stream* stream = inflater.get())
+            {
+                if (inflateReset2(stream, getInflateWindowBits(format)) != Z_OK)
+                    throw love::Exception(E_COULD_NOT_ZLIB_DECOMPRESS_DATA);
+
+                return stream;
+            }
+
+            auto* stream = new (std::nothrow) z_stream {};
+
+            if (stream == nullptr)
+                throw love::Exception(E_OUT_OF_MEMORY);
+
+            try
+            {
+                initInflate(*stream, format);
+            }
+            catch (love::Exception&)
+            {
+                delete stream;
+                throw;
+            }
+
+            return inflater.set(stream);
+        }
+
+        // Only the content is needed; the per-thread streams are primed with it on each call.
+        class ZlibDictionary : public Dictionary
+        {
+          public:
+            ZlibDictionary(Format format, const char* content, size_t size) :
+                Dictionary(format, content + size - std::min(size, WINDOW_SIZE),
+                           std::min(size, WINDOW_SIZE))
+            {}
+        };
+
+        static bool supportsDictionary(Format format)
+        {
+            // gzip headers have no field for a dictionary ID, so zlib refuses to use one there.
+            return format == FORMAT_ZLIB || format == FORMAT_DEFLATE;
+        }
+
+        static void deflateWithDictionary(z_stream* stream, const std::vector<char>& content,
+                                          const char* data, size_t dataSize, char* destination,
+                                          size_t& capacity)
+        {
+            deflateSetDictionary(stream, (const Bytef*)content.data(), (uInt)content.size());
+
+            stream->next_in   = (Bytef*)data;
+            stream->avail_in  = (uInt)dataSize;
+            stream->next_out  = (Bytef*)destination;
+            stream->avail_out = (uInt)capacity;
+
+            int status = deflate(stream, Z_FINISH);
+            capacity   = stream->total_out;
+
+            if (status != Z_STREAM_END)
+                throw love::Exception("Could not zlib/gzip-compress data.");
+        }
+
+        static void inflateWithDictionary(z_stream* stream, Format format,
+                                          const std::vector<char>& content, const char* data,
+                                          size_t dataSize, std::vector<char>& output)
+        {
+            // Raw deflate has no header asking for the dictionary, so it goes in up front.
+            if (format == FORMAT_DEFLATE)
+                inflateSetDictionary(stream, (const Bytef*)content.data(), (uInt)content.size());
+
+            stream->next_in  = (Bytef*)data;
+            stream->avail_in = (uInt)dataSize;
+
+            while (true)
+            {
+                if (stream->total_out == output.size())
+                    output.resize(std::max<size_t>(output.size() * 2, 1024));
+
+                stream->next_out  = (Bytef*)output.data() + stream->total_out;
+                stream->avail_out = (uInt)(output.size() - stream->total_out);
+
+                int status = inflate(stream, Z_NO_FLUSH);
+
+                if (status == Z_NEED_DICT)
+                {
+                    auto* bytes = (const Bytef*)content.data();
+                    status      = inflateSetDictionary(stream, bytes, (uInt)content.size());
+                }
+
+                if (status == Z_STREAM_END)
+                    break;
+                else if (status == Z_BUF_ERROR && stream->avail_in == 0)
+                    throw love::Exception(E_COMPRESSED_STREAM_TRUNCATED);
+                else if (status != Z_OK && status != Z_BUF_ERROR)
+                    throw love::Exception(E_COULD_NOT_ZLIB_DECOMPRESS_DATA);
+            }
+
+            output.resize(stream->total_out);
         }
 
       public:
@@ -99,12 +582,13 @@ namespace love
             if (!this->isSupported(format))
                 throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZLIB);
 
-            if (level < 0)
-                level = Z_DEFAULT_COMPRESSION;
-            else if (level > 9)
-                level = 9;
+            level = clampLevel(level);
+
+            if (dataSize >= PARALLEL_MIN_SIZE && ThreadPool::getInstance().getConcurrency() > 1)
+                return this->parallelCompress(format, data, dataSize, level, compressedSize);
 
-            uLong maxSize = zlibCompressBound(format, (uLong)dataSize);
+            z_stream* stream = getDeflater(format, level);
+            uLong maxSize    = zlibCompressBound(format, (uLong)dataSize);
 
             char* compressedBytes = nullptr;
 
@@ -118,8 +602,8 @@ namespace love
             }
 
             uLongf dstLength = (uLongf)maxSize;
-            int status       = zlibCompress(format, (Bytef*)compressedBytes, &dstLength,
-                                            (const Bytef*)data, (uLong)dataSize, level);
+            int status       = zlibCompress(stream, (Bytef*)compressedBytes, &dstLength,
+                                            (const Bytef*)data, (uLong)dataSize);
 
             if (status != Z_OK)
             {
@@ -154,6 +638,8 @@ namespace love
 
             while (true)
             {
+                z_stream* stream = getInflater(format);
+
                 try
                 {
                     rawBytes = new char[rawSize];
@@ -164,7 +650,7 @@ namespace love
                 }
 
                 uLongf dstLength = (uLongf)rawSize;
-                int status       = zlibDecompress(format, (Bytef*)rawBytes, &dstLength,
+                int status       = zlibDecompress(stream, (Bytef*)rawBytes, &dstLength,
                                                   (const Bytef*)data, (uLong)dataSize);
 
                 if (status == Z_OK)
@@ -175,7 +661,7 @@ namespace love
                 else if (status != Z_BUF_ERROR)
                 {
                     delete[] rawBytes;
-                    throw love::Exception("Could not decompress zlib/gzip-compressed data.");
+                    throw love::Exception(E_COULD_NOT_ZLIB_DECOMPRESS_DATA);
                 }
 
                 delete[] rawBytes;
@@ -185,6 +671,129 @@ namespace love
             return rawBytes;
         }
 
+        size_t decompressInto(Compressor::Format format, const char* data, size_t dataSize,
+                              char* destination, size_t capacity) override
+        {
+            if (!this->isSupported(format))
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZLIB);
+
+            z_stream* stream = getInflater(format);
+
+            stream->next_in   = (Bytef*)data;
+            stream->avail_in  = (uInt)dataSize;
+            stream->next_out  = (Bytef*)destination;
+            stream->avail_out = (uInt)capacity;
+
+            int status = inflate(stream, Z_FINISH);
+
+            if (status == Z_STREAM_END)
+                return stream->total_out;
+            else if (status == Z_BUF_ERROR && stream->avail_out == 0)
+                throw love::Exception(E_DECOMPRESS_DESTINATION_TOO_SMALL);
+            else if (status == Z_BUF_ERROR)
+                throw love::Exception(E_COMPRESSED_STREAM_TRUNCATED);
+            else if (status == Z_MEM_ERROR)
+                throw love::Exception(E_OUT_OF_MEMORY);
+
+            throw love::Exception(E_COULD_NOT_ZLIB_DECOMPRESS_DATA);
+        }
+
+        Stream* newCompressionStream(Compressor::Format format, int level) override
+        {
+            if (!this->isSupported(format))
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZLIB);
+
+            return new DeflateStream(format, level);
+        }
+
+        Stream* newDecompressionStream(Compressor::Format format) override
+        {
+            if (!this->isSupported(format))
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZLIB);
+
+            return new InflateStream(format);
+        }
+
+        char* compress(Compressor::Format format, Dictionary& dictionary, const char* data,
+                       size_t dataSize, int level, size_t& compressedSize) override
+        {
+            if (!this->isSupported(format))
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZLIB);
+            else if (!supportsDictionary(format))
+                throwDictionaryNotSupported(format);
+
+            const auto& content = dictionary.getContent();
+
+            // The dictionary ID in the zlib header takes 4 more bytes.
+            size_t maxSize        = zlibCompressBound(format, (uLong)dataSize) + 4;
+            char* compressedBytes = nullptr;
+
+            try
+            {
+                compressedBytes = new char[maxSize];
+            }
+            catch (std::bad_alloc&)
+            {
+                throw love::Exception(E_OUT_OF_MEMORY);
+            }
+
+            size_t outputSize = maxSize;
+
+            try
+            {
+                z_stream* stream = getDeflater(format, clampLevel(level));
+                deflateWithDictionary(stream, content, data, dataSize, compressedBytes, outputSize);
+            }
+            catch (love::Exception&)
+            {
+                delete[] compressedBytes;
+                throw;
+            }
+
+            if ((double)maxSize / (double)outputSize >= 1.3)
+            {
+                char* bytes = new (std::nothrow) char[outputSize];
+
+                if (bytes)
+                {
+                    std::memcpy(bytes, compressedBytes, outputSize);
+                    delete[] compressedBytes;
+                    compressedBytes = bytes;
+                }
+            }
+
+            compressedSize = outputSize;
+            return compressedBytes;
+        }
+
+        char* decompress(Compressor::Format format, Dictionary& dictionary, const char* data,
+                         size_t dataSize, size_t& decompressedSize) override
+        {
+            if (!this->isSupported(format))
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZLIB);
+            else if (!supportsDictionary(format))
+                throwDictionaryNotSupported(format);
+
+            const auto& content = dictionary.getContent();
+            std::vector<char> output(decompressedSize > 0 ? decompressedSize : dataSize * 2);
+
+            z_stream* stream = getInflater(format);
+            inflateWithDictionary(stream, format, content, data, dataSize, output);
+
+            return copyOutput(output, decompressedSize);
+        }
+
+        Dictionary* newDictionary(Compressor::Format format, const char* content,
+                                  size_t size) override
+        {
+            if (!this->isSupported(format))
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZLIB);
+            else if (!supportsDictionary(format))
+                throwDictionaryNotSupported(format);
+
+            return new ZlibDictionary(format, content, size);
+        }
+
         bool isSupported(Compressor::Format format) const override
         {
             return format == Compressor::FORMAT_GZIP || format == Compressor::FORMAT_ZLIB ||
@@ -0,0 +1,559 @@
+#pragma once
+
+#include "modules/data/misc/Compressor.hpp"
+
+#include "common/Exception.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+#include <zdict.h>
+#include <zstd.h>
+#include <zstd_errors.h>
+
+namespace love
+{
+    class ZstdCompressor : public Compressor
+    {
+      private:
+        // Inputs at least this large get long-distance matching and a window sized to fit them,
+        // capped at the largest window decoders accept by default.
+        static constexpr size_t LONG_WINDOW_MIN_SIZE = 8 * 1024 * 1024;
+        static constexpr int LONG_WINDOW_LOG_MAX     = 27;
+
+        // The densest block is a 4-byte RLE block of 128 KB, so no input decodes to more than
+        // this many times its size.
+        static constexpr size_t MAX_EXPANSION = 128 * 1024 / 4;
+
+        // A frame's recorded content size is only allocated up front when its input could hold
+        // that much and it is no more than the size the caller expects, if any. Other frames go
+        // through the streaming decoder, which grows its output only as data actually arrives.
+        static bool isContentSizeTrusted(unsigned long long rawSize, size_t dataSize,
+                                         size_t expectedSize)
+        {
+            if (expectedSize > 0 && rawSize > expectedSize)
+                return false;
+
+            return rawSize / MAX_EXPANSION <= dataSize;
+        }
+
+        static int clampLevel(int level)
+        {
+            if (level < 0)
+                return ZSTD_CLEVEL_DEFAULT;
+
+            return std::clamp(level, 1, ZSTD_maxCLevel());
+        }
+
+        static void check(size_t result, const char* action)
+        {
+            if (ZSTD_isError(result))
+                throw love::Exception("Could not {} data: {}", action, ZSTD_getErrorName(result));
+        }
+
+        // Contexts hold several hundred KB of tables, so each thread keeps one around.
+        static ZSTD_CCtx* getCompressionContext()
+        {
+            thread_local ThreadContext<ZSTD_CCtx, ZSTD_freeCCtx, ZSTD_sizeof_CCtx> context;
+
+            ZSTD_CCtx* result = context.get();
+
+            if (result == nullptr)
+                result = context.set(ZSTD_createCCtx());
+
+            ZSTD_CCtx_reset(result, ZSTD_reset_session_and_parameters);
+            return result;
+        }
+
+        static ZSTD_DCtx* getDecompressionContext()
+        {
+            thread_local ThreadContext<ZSTD_DCtx, ZSTD_freeDCtx, ZSTD_sizeof_DCtx> context;
+
+            ZSTD_DCtx* result = context.get();
+
+            if (result == nullptr)
+                result = context.set(ZSTD_createDCtx());
+
+            ZSTD_DCtx_reset(result, ZSTD_reset_session_and_parameters);
+            return result;
+        }
+
+        static void setParameters(ZSTD_CCtx* context, int level, size_t dataSize)
+        {
+            check(ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, clampLevel(level)),
+                  "zstd-compress");
+
+            if (dataSize < LONG_WINDOW_MIN_SIZE)
+                return;
+
+            int windowLog = 0;
+            while (windowLog < LONG_WINDOW_LOG_MAX && ((size_t)1 << windowLog) < dataSize)
+                windowLog++;
+
+            check(ZSTD_CCtx_setParameter(context, ZSTD_c_enableLongDistanceMatching, 1),
+                  "zstd-compress");
+            check(ZSTD_CCtx_setParameter(context, ZSTD_c_windowLog, windowLog), "zstd-compress");
+        }
+
+        class CompressStream : public Stream
+        {
+          public:
+            CompressStream(int level) : Stream(FORMAT_ZSTD), stream(ZSTD_createCStream())
+            {
+                if (this->stream == nullptr)
+                    throw love::Exception(E_OUT_OF_MEMORY);
+
+                // The total size isn't known up front, so long-distance matching stays off.
+                setParameters(this->stream, level, 0);
+            }
+
+            virtual ~CompressStream()
+            {
+                ZSTD_freeCStream(this->stream);
+            }
+
+            void push(const char* input, size_t size, std::vector<char>& output) override
+            {
+                this->run(input, size, ZSTD_e_continue, output);
+            }
+
+            void finish(std::vector<char>& output) override
+            {
+                this->run(nullptr, 0, ZSTD_e_end, output);
+            }
+
+          private:
+            void run(const char* input, size_t size, ZSTD_EndDirective mode,
+                     std::vector<char>& output)
+            {
+                ZSTD_inBuffer in { input, size, 0 };
+                size_t remaining = 0;
+
+                do
+                {
+                    size_t offset = output.size();
+                    output.resize(offset + STREAM_CHUNK_SIZE);
+
+                    ZSTD_outBuffer out { output.data() + offset, STREAM_CHUNK_SIZE, 0 };
+                    remaining = ZSTD_compressStream2(this->stream, &out, &in, mode);
+
+                    output.resize(offset + out.pos);
+                    check(remaining, "zstd-compress");
+                } while (in.pos < in.size || (mode == ZSTD_e_end && remaining > 0));
+            }
+
+            ZSTD_CStream* stream;
+        };
+
+        class DecompressStream : public Stream
+        {
+          public:
+            DecompressStream(const ZSTD_DDict* dictionary = nullptr) :
+                Stream(FORMAT_ZSTD),
+                stream(ZSTD_createDStream()),
+                ended(false)
+            {
+                if (this->stream == nullptr)
+                    throw love::Exception(E_OUT_OF_MEMORY);
+
+                if (dictionary != nullptr)
+                {
+                    size_t result = ZSTD_DCtx_refDDict(this->stream, dictionary);
+
+                    if (ZSTD_isError(result))
+                        ZSTD_freeDStream(this->stream);
+
+                    check(result, "decompress zstd-compressed");
+                }
+            }
+
+            virtual ~DecompressStream()
+            {
+                ZSTD_freeDStream(this->stream);
+            }
+
+            // Decodes concatenated frames, like the zstd tool. finish() only needs the last
+            // frame to be complete.
+            void push(const char* input, size_t size, std::vector<char>& output) override
+            {
+                ZSTD_inBuffer in { input, size, 0 };
+
+                while (true)
+                {
+                    size_t offset = output.size();
+                    output.resize(offset + STREAM_CHUNK_SIZE);
+
+                    ZSTD_outBuffer out { output.data() + offset, STREAM_CHUNK_SIZE, 0 };
+                    size_t result = ZSTD_decompressStream(this->stream, &out, &in);
+
+                    output.resize(offset + out.pos);
+                    check(result, "decompress zstd-compressed");
+
+                    this->ended = result == 0;
+
+                    if (in.pos == in.size && out.pos < out.size)
+                        break;
+                }
+            }
+
+            void finish(std::vector<char>&) override
+            {
+                if (!this->ended)
+                    throw love::Exception(E_COMPRESSED_STREAM_TRUNCATED);
+            }
+
+          private:
+            ZSTD_DStream* stream;
+            bool ended;
+        };
+
+        // Digested dictionaries are built once: the decompression one up front, and one per
+        // compression level the first time that level is used.
+        class ZstdDictionary : public Dictionary
+        {
+          public:
+            ZstdDictionary(const char* content, size_t size) :
+                Dictionary(FORMAT_ZSTD, content, size),
+                decompressionDictionary(nullptr)
+            {
+                this->decompressionDictionary = ZSTD_createDDict(content, size);
+
+                if (this->decompressionDictionary == nullptr)
+                    throw love::Exception("Could not create zstd dictionary.");
+            }
+
+            virtual ~ZstdDictionary()
+            {
+                for (const auto& entry : this->compressionDictionaries)
+                    ZSTD_freeCDict(entry.second);
+
+                ZSTD_freeDDict(this->decompressionDictionary);
+            }
+
+            const ZSTD_CDict* getCompressionDictionary(int level)
+            {
+                std::lock_guard lock(this->mutex);
+
+                auto it = this->compressionDictionaries.find(level);
+                if (it != this->compressionDictionaries.end())
+                    return it->second;
+
+                const auto& content = this->content;
+                ZSTD_CDict* result  = ZSTD_createCDict(content.data(), content.size(), level);
+
+                if (result == nullptr)
+                    throw love::Exception(E_OUT_OF_MEMORY);
+
+                this->compressionDictionaries[level] = result;
+                return result;
+            }
+
+            const ZSTD_DDict* getDecompressionDictionary() const
+            {
+                return this->decompressionDictionary;
+            }
+
+          private:
+            std::mutex mutex;
+            std::map<int, ZSTD_CDict*> compressionDictionaries;
+            ZSTD_DDict* decompressionDictionary;
+        };
+
+      public:
+        char* compress(Compressor::Format format, const char* data, size_t dataSize, int level,
+                       size_t& compressedSize) override
+        {
+            if (!this->isSupported(format))
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZSTD);
+
+            size_t maxSize        = ZSTD_compressBound(dataSize);
+            char* compressedBytes = nullptr;
+
+            try
+            {
+                compressedBytes = new char[maxSize];
+            }
+            catch (std::bad_alloc&)
+            {
+                throw love::Exception(E_OUT_OF_MEMORY);
+            }
+
+            size_t result = 0;
+
+            try
+            {
+                ZSTD_CCtx* context = getCompressionContext();
+                setParameters(context, level, dataSize);
+
+                result = ZSTD_compress2(context, compressedBytes, maxSize, data, dataSize);
+                check(result, "zstd-compress");
+            }
+            catch (love::Exception&)
+            {
+                delete[] compressedBytes;
+                throw;
+            }
+
+            if ((double)maxSize / (double)result >= 1.2)
+            {
+                char* bytes = new (std::nothrow) char[result];
+
+                if (bytes)
+                {
+                    std::memcpy(bytes, compressedBytes, result);
+                    delete[] compressedBytes;
+                    compressedBytes = bytes;
+                }
+            }
+
+            compressedSize = result;
+            return compressedBytes;
+        }
+
+        char* decompress(Compressor::Format format, const char* data, size_t dataSize,
+                         size_t& decompressedSize) override
+        {
+            if (!this->isSupported(format))
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZSTD);
+
+            unsigned long long rawSize = ZSTD_getFrameContentSize(data, dataSize);
+
+            if (rawSize == ZSTD_CONTENTSIZE_ERROR)
+                throw love::Exception("Could not decompress zstd-compressed data.");
+
+            size_t frameSize = ZSTD_findFrameCompressedSize(data, dataSize);
+
+            // Streams don't record the content size, and later frames may follow the first. The
+            // streaming decoder also reports truncated input more clearly, and is used for sizes
+            // that input could not hold.
+            if (rawSize == ZSTD_CONTENTSIZE_UNKNOWN || ZSTD_isError(frameSize) ||
+                frameSize < dataSize || !isContentSizeTrusted(rawSize, dataSize, decompressedSize))
+            {
+                std::vector<char> output;
+                output.reserve(decompressedSize);
+
+                DecompressStream stream;
+                stream.push(data, dataSize, output);
+                stream.finish(output);
+
+                return copyOutput(output, decompressedSize);
+            }
+
+            char* rawBytes = nullptr;
+
+            try
+            {
+                rawBytes = new char[std::max<size_t>(rawSize, 1)];
+            }
+            catch (std::bad_alloc&)
+            {
+                throw love::Exception(E_OUT_OF_MEMORY);
+            }
+
+            try
+            {
+                ZSTD_DCtx* context = getDecompressionContext();
+                size_t result = ZSTD_decompressDCtx(context, rawBytes, rawSize, data, dataSize);
+
+                check(result, "decompress zstd-compressed");
+                decompressedSize = result;
+            }
+            catch (love::Exception&)
+            {
+                delete[] rawBytes;
+                throw;
+            }
+
+            return rawBytes;
+        }
+
+        // Frames without a recorded content size decode the same way, as long as they fit.
+        size_t decompressInto(Compressor::Format format, const char* data, size_t dataSize,
+                              char* destination, size_t capacity) override
+        {
+            if (!this->isSupported(format))
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZSTD);
+
+            ZSTD_DCtx* context = getDecompressionContext();
+            size_t result = ZSTD_decompressDCtx(context, destination, capacity, data, dataSize);
+
+            if (ZSTD_getErrorCode(result) == ZSTD_error_dstSize_tooSmall)
+                throw love::Exception(E_DECOMPRESS_DESTINATION_TOO_SMALL);
+
+            check(result, "decompress zstd-compressed");
+            return result;
+        }
+
+        Stream* newCompressionStream(Compressor::Format format, int level) override
+        {
+            if (!this->isSupported(format))
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZSTD);
+
+            return new CompressStream(level);
+        }
+
+        Stream* newDecompressionStream(Compressor::Format format) override
+        {
+            if (!this->isSupported(format))
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZSTD);
+
+            return new DecompressStream();
+        }
+
+        char* compress(Compressor::Format format, Dictionary& dictionary, const char* data,
+                       size_t dataSize, int level, size_t& compressedSize) override
+        {
+            if (!this->isSupported(format))
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZSTD);
+
+            auto& zstdDictionary       = (ZstdDictionary&)dictionary;
+            const ZSTD_CDict* digested = zstdDictionary.getCompressionDictionary(clampLevel(level));
+
+            size_t maxSize        = ZSTD_compressBound(dataSize);
+            char* compressedBytes = nullptr;
+
+            try
+            {
+                compressedBytes = new char[maxSize];
+            }
+            catch (std::bad_alloc&)
+            {
+                throw love::Exception(E_OUT_OF_MEMORY);
+            }
+
+            size_t result = 0;
+
+            try
+            {
+                ZSTD_CCtx* context = getCompressionContext();
+
+                // clang-format off
+                result = ZSTD_compress_usingCDict(context, compressedBytes, maxSize, data, dataSize, digested);
+                // clang-format on
+                check(result, "zstd-compress");
+            }
+            catch (love::Exception&)
+            {
+                delete[] compressedBytes;
+                throw;
+            }
+
+            if ((double)maxSize / (double)result >= 1.2)
+            {
+                char* bytes = new (std::nothrow) char[result];
+
+                if (bytes)
+                {
+                    std::memcpy(bytes, compressedBytes, result);
+                    delete[] compressedBytes;
+                    compressedBytes = bytes;
+                }
+            }
+
+            compressedSize = result;
+            return compressedBytes;
+        }
+
+        char* decompress(Compressor::Format format, Dictionary& dictionary, const char* data,
+                         size_t dataSize, size_t& decompressedSize) override
+        {
+            if (!this->isSupported(format))
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZSTD);
+
+            const auto& zstdDictionary = (const ZstdDictionary&)dictionary;
+            const ZSTD_DDict* digested = zstdDictionary.getDecompressionDictionary();
+
+            unsigned long long rawSize = ZSTD_getFrameContentSize(data, dataSize);
+
+            if (rawSize == ZSTD_CONTENTSIZE_ERROR)
+                throw love::Exception("Could not decompress zstd-compressed data.");
+
+            size_t frameSize = ZSTD_findFrameCompressedSize(data, dataSize);
+
+            if (rawSize == ZSTD_CONTENTSIZE_UNKNOWN || ZSTD_isError(frameSize) ||
+                frameSize < dataSize || !isContentSizeTrusted(rawSize, dataSize, decompressedSize))
+            {
+                std::vector<char> output;
+                output.reserve(decompressedSize);
+
+                DecompressStream stream(digested);
+                stream.push(data, dataSize, output);
+                stream.finish(output);
+
+                return copyOutput(output, decompressedSize);
+            }
+
+            char* rawBytes = nullptr;
+
+            try
+            {
+                rawBytes = new char[std::max<size_t>(rawSize, 1)];
+            }
+            catch (std::bad_alloc&)
+            {
+                throw love::Exception(E_OUT_OF_MEMORY);
+            }
+
+            try
+            {
+                ZSTD_DCtx* context = getDecompressionContext();
+
+                // clang-format off
+                size_t result = ZSTD_decompress_usingDDict(context, rawBytes, rawSize, data, dataSize, digested);
+                // clang-format on
+
+                check(result, "decompress zstd-compressed");
+                decompressedSize = result;
+            }
+            catch (love::Exception&)
+            {
+                delete[] rawBytes;
+                throw;
+            }
+
+            return rawBytes;
+        }
+
+        Dictionary* newDictionary(Compressor::Format format, const char* content,
+                                  size_t size) override
+        {
+            if (!this->isSupported(format))
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZSTD);
+
+            return new ZstdDictionary(content, size);
+        }
+
+        // Trains a proper dictionary: common substrings plus entropy tables tuned to the samples.
+        // Too few or too similar samples make training fail, and then they are just joined.
+        Dictionary* trainDictionary(Compressor::Format format, const char* const* samples,
+                                    const size_t* sizes, size_t count) override
+        {
+            if (!this->isSupported(format))
+                throw love::Exception(E_INVALID_COMPRESSION_FORMAT_ZSTD);
+
+            std::vector<char> buffer;
+
+            for (size_t index = 0; index < count; index++)
+                buffer.insert(buffer.end(), samples[index], samples[index] + sizes[index]);
+
+            size_t capacity = std::clamp<size_t>(buffer.size() / 10, 1024, 110 * 1024);
+            std::vector<char> content(capacity);
+
+            auto sampleCount = (unsigned)count;
+            size_t result    = ZDICT_trainFromBuffer(content.data(), capacity, buffer.data(), sizes,
+                                                     sampleCount);
+
+            if (ZDICT_isError(result))
+                return new ZstdDictionary(buffer.data(), buffer.size());
+
+            return new ZstdDictionary(content.data(), result);
+        }
+
+        bool isSupported(Compressor::Format format) const override
+        {
+            return format == Compressor::FORMAT_ZSTD;
+        }
+    };
+} // namespace love
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "common/luax.hpp"
+#include "modules/data/ChainedData.hpp"
+
+namespace love
+{
+    ChainedData* luax_checkchaineddata(lua_State* L, int index);
+
+    // Appends the Data, ChainedData or string at `index`. With `ranged`, a Data can be limited by
+    // the offset and size at index + 1 and index + 2. Strings are copied into a new ByteData.
+    void luax_appendtochain(lua_State* L, ChainedData* chain, int index, bool ranged);
+
+    int open_chaineddata(lua_State* L);
+} // namespace love
+
+namespace Wrap_ChainedData
+{
+    int clone(lua_State* L);
+
+    int append(lua_State* L);
+
+    int slice(lua_State* L);
+
+    int flatten(lua_State* L);
+
+    int getSegmentCount(lua_State* L);
+} // namespace Wrap_ChainedData
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "common/luax.hpp"
+#include "modules/data/CompressionDictionary.hpp"
+
+namespace love
+{
+    CompressionDictionary* luax_checkcompressiondictionary(lua_State* L, int index);
+
+    int open_compressiondictionary(lua_State* L);
+} // namespace love
+
+namespace Wrap_CompressionDictionary
+{
+    int clone(lua_State* L);
+
+    int getFormat(lua_State* L);
+} // namespace Wrap_CompressionDictionary
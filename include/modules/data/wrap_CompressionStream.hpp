@@ -0,0 +1,22 @@
+#pragma once
+
+#include "common/luax.hpp"
+#include "modules/data/CompressionStream.hpp"
+
+namespace love
+{
+    CompressionStream* luax_checkcompressionstream(lua_State* L, int index);
+
+    int open_compressionstream(lua_State* L);
+} // namespace love
+
+namespace Wrap_CompressionStream
+{
+    int push(lua_State* L);
+
+    int finish(lua_State* L);
+
+    int getFormat(lua_State* L);
+
+    int getMode(lua_State* L);
+} // namespace Wrap_CompressionStream
@@ -22,5 +22,7 @@ namespace Wrap_Data
 
     int performAtomic(lua_State* L);
 
-    extern luaL_Reg functions[13];
+    int toTable(lua_State* L);
+
+    extern luaL_Reg functions[14];
 } // namespace Wrap_Data
@@ -2,10 +2,13 @@
 
 #include "common/luax.hpp"
 #include "modules/data/DataModule.hpp"
+#include "modules/data/misc/ArrayKernels.hpp"
 
 namespace love
 {
     data::ContainerType luax_checkcontainertype(lua_State* L, int index);
+
+    ArrayKernels::ElementType luax_checkelementtype(lua_State* L, int index);
 } // namespace love
 
 namespace Wrap_DataModule
@@ -14,19 +17,75 @@ namespace Wrap_DataModule
 
     int decompress(lua_State* L);
 
+    int decompressInto(lua_State* L);
+
     int hash(lua_State* L);
 
+    int hashBatch(lua_State* L);
+
+    int getHashBackend(lua_State* L);
+
+    int getCompressorStats(lua_State* L);
+
+    int getAllocatorStats(lua_State* L);
+
     int encode(lua_State* L);
 
+    int encodeInto(lua_State* L);
+
     int decode(lua_State* L);
 
     int pack(lua_State* L);
 
     int unpack(lua_State* L);
 
+    int serialize(lua_State* L);
+
+    int deserialize(lua_State* L);
+
+    int fill(lua_State* L);
+
+    int add(lua_State* L);
+
+    int subtract(lua_State* L);
+
+    int multiply(lua_State* L);
+
+    int fma(lua_State* L);
+
+    int clamp(lua_State* L);
+
+    int convert(lua_State* L);
+
+    int sum(lua_State* L);
+
+    int min(lua_State* L);
+
+    int max(lua_State* L);
+
+    int dot(lua_State* L);
+
+    int sort(lua_State* L);
+
+    int search(lua_State* L);
+
+    int fromTable(lua_State* L);
+
     int newByteData(lua_State* L);
 
     int newDataView(lua_State* L);
 
+    int newChainedData(lua_State* L);
+
+    int newHasher(lua_State* L);
+
+    int newPackFormat(lua_State* L);
+
+    int newCompressionStream(lua_State* L);
+
+    int newDecompressionStream(lua_State* L);
+
+    int newCompressionDictionary(lua_State* L);
+
     int open(lua_State* L);
 } // namespace Wrap_DataModule
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "common/luax.hpp"
+#include "modules/data/Hasher.hpp"
+
+namespace love
+{
+    Hasher* luax_checkhasher(lua_State* L, int index);
+
+    int open_hasher(lua_State* L);
+} // namespace love
+
+namespace Wrap_Hasher
+{
+    int update(lua_State* L);
+
+    int finish(lua_State* L);
+
+    int getFunction(lua_State* L);
+} // namespace Wrap_Hasher
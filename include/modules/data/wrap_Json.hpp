@@ -0,0 +1,17 @@
+#pragma once
+
+#include "common/luax.hpp"
+#include "modules/data/misc/Json.hpp"
+
+namespace love
+{
+    // Pushes the love.data.json table.
+    int open_json(lua_State* L);
+} // namespace love
+
+namespace Wrap_Json
+{
+    int decode(lua_State* L);
+
+    int encode(lua_State* L);
+} // namespace Wrap_Json
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "common/luax.hpp"
+#include "modules/data/PackFormat.hpp"
+
+namespace love
+{
+    PackFormat* luax_checkpackformat(lua_State* L, int index);
+
+    int open_packformat(lua_State* L);
+} // namespace love
+
+namespace Wrap_PackFormat
+{
+    int pack(lua_State* L);
+
+    int unpack(lua_State* L);
+
+    int unpackMany(lua_State* L);
+
+    int getSize(lua_State* L);
+
+    int getFormat(lua_State* L);
+} // namespace Wrap_PackFormat
@@ -18,7 +18,7 @@ namespace love
     class FileBase : public Stream
     {
       public:
-        static inline Type type = Type("File", &Stream::type);
+        static inline Type type = Type("File", Type::ID_FILE);
 
         static constexpr int64_t MAX_FILE_SIZE = 0x20000000000000LL;
         static constexpr int64_t MAX_MODTIME   = 0x20000000000000LL;
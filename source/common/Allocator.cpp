@@ -0,0 +1,388 @@
+#include "common/Allocator.hpp"
+#include "common/Exception.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace love
+{
+    static constexpr size_t CLASS_COUNT =
+        std::bit_width(Allocator::MAX_POOLED_SIZE / Allocator::MIN_CLASS_SIZE);
+
+    // Freed blocks each thread keeps per class, and how many the shared lists hold beyond that.
+    static constexpr size_t THREAD_CACHE_BYTES = 128 * 1024;
+    static constexpr size_t SHARED_CACHE_BYTES = 1024 * 1024;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    struct FreeList
+    {
+        FreeBlock* head;
+        size_t count;
+
+        void push(FreeBlock* block)
+        {
+            block->next = this->head;
+            this->head  = block;
+            this->count++;
+        }
+
+        FreeBlock* pop()
+        {
+            FreeBlock* block = this->head;
+            this->head       = block->next;
+            this->count--;
+
+            return block;
+        }
+    };
+
+    struct SharedList
+    {
+        std::mutex mutex;
+        FreeList list;
+    };
+
+    // Never destroyed, since Data can still be released while other statics are torn down, and
+    // created on first use, since it can also be allocated before this file's statics are set up.
+    static SharedList& getSharedList(size_t index)
+    {
+        static SharedList* const sharedLists = new SharedList[CLASS_COUNT] {};
+        return sharedLists[index];
+    }
+
+    // Counters are written by one thread at a time: the owning thread for its cache, or any
+    // thread holding the registry lock for the totals of exited threads. Plain loads and stores
+    // are then enough, which keeps locked instructions off the allocation path.
+    struct Counters
+    {
+        std::atomic<uint64_t> allocations;
+        std::atomic<uint64_t> cacheHits;
+        std::atomic<uint64_t> largeAllocations;
+        std::atomic<uint64_t> bytesInUse;
+        std::atomic<uint64_t> bytesCached;
+
+        // Byte counts of a single thread can go below zero when another thread freed what it
+        // allocated. Unsigned wraparound keeps the sum across all counters right.
+        static void add(std::atomic<uint64_t>& counter, uint64_t amount)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + amount,
+                          std::memory_order_relaxed);
+        }
+
+        void addTo(Allocator::Stats& stats) const
+        {
+            stats.allocations += this->allocations.load(std::memory_order_relaxed);
+            stats.cacheHits += this->cacheHits.load(std::memory_order_relaxed);
+            stats.largeAllocations += this->largeAllocations.load(std::memory_order_relaxed);
+            stats.bytesInUse += this->bytesInUse.load(std::memory_order_relaxed);
+            stats.bytesCached += this->bytesCached.load(std::memory_order_relaxed);
+        }
+    };
+
+    struct ThreadCache;
+
+    struct Registry
+    {
+        std::mutex mutex;
+        std::vector<ThreadCache*> caches;
+        Counters exited;
+    };
+
+    static Registry& getRegistry()
+    {
+        static Registry* const registry = new Registry {};
+        return *registry;
+    }
+
+    static size_t getClass(size_t size)
+    {
+        if (size <= Allocator::MIN_CLASS_SIZE)
+            return 0;
+
+        return std::bit_width((size - 1) / Allocator::MIN_CLASS_SIZE);
+    }
+
+    static size_t getClassSize(size_t index)
+    {
+        return Allocator::MIN_CLASS_SIZE << index;
+    }
+
+    static std::align_val_t getAlignment(size_t size)
+    {
+        if (size >= Allocator::SIMD_ALIGNMENT)
+            return std::align_val_t(Allocator::SIMD_ALIGNMENT);
+
+        return std::align_val_t(Allocator::MIN_ALIGNMENT);
+    }
+
+    static void* systemAllocate(size_t size)
+    {
+        try
+        {
+            return ::operator new(size, getAlignment(size));
+        }
+        catch (std::bad_alloc&)
+        {
+            throw love::Exception(E_OUT_OF_MEMORY);
+        }
+    }
+
+    static void systemFree(void* block, size_t size)
+    {
+        ::operator delete(block, getAlignment(size));
+    }
+
+    static thread_local bool threadCacheDestroyed = false;
+
+    struct ThreadCache
+    {
+        FreeList lists[CLASS_COUNT] {};
+        Counters counters {};
+
+        ThreadCache();
+
+        ~ThreadCache();
+
+        // Blocks this thread may keep for one class before handing half to the shared list.
+        static size_t getLimit(size_t index)
+        {
+            return std::max<size_t>(2, THREAD_CACHE_BYTES / getClassSize(index));
+        }
+    };
+
+    static thread_local ThreadCache threadCache;
+
+    // Calls function(counters) with the counters the calling thread may write.
+    template<typename Function>
+    static void count(Function function)
+    {
+        if (!threadCacheDestroyed)
+            return function(threadCache.counters);
+
+        auto& registry = getRegistry();
+        std::unique_lock lock(registry.mutex);
+
+        function(registry.exited);
+    }
+
+    // Moves up to `count` blocks from `source` to the shared list of their class. Blocks beyond
+    // the shared limit go back to the system.
+    static void release(FreeList& source, size_t index, size_t count)
+    {
+        size_t classSize = getClassSize(index);
+        size_t limit     = std::max<size_t>(4, SHARED_CACHE_BYTES / classSize);
+        size_t freed     = 0;
+
+        {
+            auto& shared = getSharedList(index);
+            std::unique_lock lock(shared.mutex);
+
+            for (; count > 0 && source.head != nullptr; count--)
+            {
+                FreeBlock* block = source.pop();
+
+                if (shared.list.count < limit)
+                    shared.list.push(block);
+                else
+                {
+                    systemFree(block, classSize);
+                    freed += classSize;
+                }
+            }
+        }
+
+        if (freed > 0)
+            love::count([&](Counters& counters) { Counters::add(counters.bytesCached, -freed); });
+    }
+
+    ThreadCache::ThreadCache()
+    {
+        auto& registry = getRegistry();
+        std::unique_lock lock(registry.mutex);
+        registry.caches.push_back(this);
+    }
+
+    ThreadCache::~ThreadCache()
+    {
+        for (size_t index = 0; index < CLASS_COUNT; index++)
+            release(this->lists[index], index, this->lists[index].count);
+
+        auto& registry = getRegistry();
+        std::unique_lock lock(registry.mutex);
+
+        auto& caches = registry.caches;
+        caches.erase(std::find(caches.begin(), caches.end(), this));
+
+        Allocator::Stats totals {};
+        this->counters.addTo(totals);
+
+        Counters::add(registry.exited.allocations, totals.allocations);
+        Counters::add(registry.exited.cacheHits, totals.cacheHits);
+        Counters::add(registry.exited.largeAllocations, totals.largeAllocations);
+        Counters::add(registry.exited.bytesInUse, totals.bytesInUse);
+        Counters::add(registry.exited.bytesCached, totals.bytesCached);
+
+        threadCacheDestroyed = true;
+    }
+
+    void* Allocator::allocate(size_t size, bool clear)
+    {
+        if (size > MAX_POOLED_SIZE)
+        {
+            void* block = systemAllocate(size);
+
+            count([&](Counters& counters) {
+                Counters::add(counters.allocations, 1);
+                Counters::add(counters.largeAllocations, 1);
+                Counters::add(counters.bytesInUse, size);
+            });
+
+            if (clear)
+                std::memset(block, 0, size);
+
+            return block;
+        }
+
+        size_t index     = getClass(size);
+        size_t classSize = getClassSize(index);
+        void* block      = nullptr;
+
+        if (!threadCacheDestroyed)
+        {
+            FreeList& list = threadCache.lists[index];
+
+            // Refills half the thread's share at once so the shared lock is taken rarely.
+            if (list.head == nullptr)
+            {
+                auto& shared = getSharedList(index);
+                std::unique_lock lock(shared.mutex);
+
+                for (size_t count = ThreadCache::getLimit(index) / 2; count > 0; count--)
+                {
+                    if (shared.list.head == nullptr)
+                        break;
+
+                    list.push(shared.list.pop());
+                }
+            }
+
+            if (list.head != nullptr)
+                block = list.pop();
+        }
+
+        bool cached = block != nullptr;
+
+        if (!cached)
+            block = systemAllocate(classSize);
+
+        count([&](Counters& counters) {
+            Counters::add(counters.allocations, 1);
+            Counters::add(counters.bytesInUse, classSize);
+
+            if (cached)
+            {
+                Counters::add(counters.cacheHits, 1);
+                Counters::add(counters.bytesCached, -classSize);
+            }
+        });
+
+        if (clear)
+            std::memset(block, 0, size);
+
+        return block;
+    }
+
+    void Allocator::deallocate(void* block, size_t size)
+    {
+        if (block == nullptr)
+            return;
+
+        if (size > MAX_POOLED_SIZE)
+        {
+            systemFree(block, size);
+            count([&](Counters& counters) { Counters::add(counters.bytesInUse, -size); });
+
+            return;
+        }
+
+        size_t index     = getClass(size);
+        size_t classSize = getClassSize(index);
+
+        count([&](Counters& counters) {
+            Counters::add(counters.bytesInUse, -classSize);
+            Counters::add(counters.bytesCached, classSize);
+        });
+
+        if (threadCacheDestroyed)
+        {
+            FreeList single { nullptr, 0 };
+            single.push((FreeBlock*)block);
+
+            release(single, index, 1);
+            return;
+        }
+
+        FreeList& list = threadCache.lists[index];
+        list.push((FreeBlock*)block);
+
+        size_t limit = ThreadCache::getLimit(index);
+
+        if (list.count > limit)
+            release(list, index, limit / 2);
+    }
+
+    Allocator::Stats Allocator::getStats()
+    {
+        Stats stats {};
+
+        auto& registry = getRegistry();
+        std::unique_lock lock(registry.mutex);
+
+        registry.exited.addTo(stats);
+
+        for (const auto* cache : registry.caches)
+            cache->counters.addTo(stats);
+
+        return stats;
+    }
+
+    void Allocator::trim()
+    {
+        size_t freed = 0;
+
+        for (size_t index = 0; index < CLASS_COUNT; index++)
+        {
+            size_t classSize = getClassSize(index);
+            FreeList blocks { nullptr, 0 };
+
+            if (!threadCacheDestroyed)
+                std::swap(blocks, threadCache.lists[index]);
+
+            {
+                auto& shared = getSharedList(index);
+                std::unique_lock lock(shared.mutex);
+
+                while (shared.list.head != nullptr)
+                    blocks.push(shared.list.pop());
+            }
+
+            while (blocks.head != nullptr)
+            {
+                systemFree(blocks.pop(), classSize);
+                freed += classSize;
+            }
+        }
+
+        count([&](Counters& counters) { Counters::add(counters.bytesCached, -freed); });
+    }
+} // namespace love
@@ -2,7 +2,7 @@
 
 namespace love
 {
-    Type Data::type("Data", &Object::type);
+    Type Data::type("Data", Type::ID_DATA);
 
     Data::~Data()
     {
@@ -34,7 +34,7 @@ namespace
 
 namespace love
 {
-    Type Module::type("Module", &Object::type);
+    Type Module::type("Module", Type::ID_MODULE);
 
     Module* Module::instances[] {};
 
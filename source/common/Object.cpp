@@ -2,7 +2,7 @@
 
 namespace love
 {
-    Type Object::type("Object", nullptr);
+    Type Object::type("Object", Type::ID_OBJECT);
 
     Object::Object() : count(1)
     {}
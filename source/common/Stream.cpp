@@ -13,7 +13,7 @@
 
 namespace love
 {
-    Type Stream::type("Stream", &Object::type);
+    Type Stream::type("Stream", Type::ID_STREAM);
 
     Data* Stream::read(int64_t size)
     {
@@ -0,0 +1,149 @@
+#include "common/ThreadPool.hpp"
+#include "common/Console.hpp"
+
+#include <algorithm>
+
+namespace love
+{
+    static thread_local bool insideTask = false;
+
+    ThreadPool& ThreadPool::getInstance()
+    {
+        static ThreadPool instance([] {
+            size_t cores = std::max(1u, std::thread::hardware_concurrency());
+
+            // Applications only get three of the Switch's four cores.
+            if (Console::is(Console::HAC))
+                cores = std::min<size_t>(cores, 3);
+
+            return cores - 1;
+        }());
+
+        return instance;
+    }
+
+    ThreadPool::ThreadPool(size_t workerCount) : job(nullptr), generation(0), stopping(false)
+    {
+        for (size_t index = 0; index < workerCount; index++)
+            this->workers.emplace_back(&ThreadPool::workerMain, this);
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard lock(this->mutex);
+            this->stopping = true;
+        }
+
+        this->wakeCondition.notify_all();
+
+        for (auto& worker : this->workers)
+            worker.join();
+    }
+
+    void ThreadPool::runTasks(Job& job)
+    {
+        insideTask = true;
+
+        for (;;)
+        {
+            size_t index = job.nextIndex.fetch_add(1, std::memory_order_relaxed);
+
+            if (index >= job.count)
+                break;
+
+            try
+            {
+                (*job.task)(index);
+            }
+            catch (...)
+            {
+                std::lock_guard lock(this->mutex);
+
+                if (!job.exception)
+                    job.exception = std::current_exception();
+
+                // Skip whatever has not been started yet.
+                job.nextIndex.store(job.count, std::memory_order_relaxed);
+            }
+        }
+
+        insideTask = false;
+    }
+
+    void ThreadPool::workerMain()
+    {
+        uint64_t seen = 0;
+
+        for (;;)
+        {
+            Job* current = nullptr;
+
+            {
+                std::unique_lock lock(this->mutex);
+                this->wakeCondition.wait(lock, [&] {
+                    return this->stopping || (this->job != nullptr && this->generation != seen);
+                });
+
+                if (this->stopping)
+                    return;
+
+                seen    = this->generation;
+                current = this->job;
+                current->workers++;
+            }
+
+            this->runTasks(*current);
+
+            {
+                std::lock_guard lock(this->mutex);
+                current->workers--;
+            }
+
+            this->doneCondition.notify_all();
+        }
+    }
+
+    void ThreadPool::parallelFor(size_t count, const Task& task)
+    {
+        if (count == 0)
+            return;
+
+        if (count == 1 || this->workers.empty() || insideTask)
+        {
+            for (size_t index = 0; index < count; index++)
+                task(index);
+
+            return;
+        }
+
+        std::lock_guard submit(this->submitMutex);
+
+        Job job;
+        job.task    = &task;
+        job.count   = count;
+        job.workers = 0;
+        job.nextIndex.store(0, std::memory_order_relaxed);
+
+        {
+            std::lock_guard lock(this->mutex);
+
+            this->job = &job;
+            this->generation++;
+        }
+
+        this->wakeCondition.notify_all();
+        this->runTasks(job);
+
+        {
+            std::unique_lock lock(this->mutex);
+            this->doneCondition.wait(lock, [&] { return job.workers == 0; });
+
+            // Workers that wake after this point find no job to join.
+            this->job = nullptr;
+        }
+
+        if (job.exception)
+            std::rethrow_exception(job.exception);
+    }
+} // namespace love
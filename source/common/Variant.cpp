@@ -18,12 +18,88 @@
  * 3. This notice may not be removed or altered from any source distribution.
  **/
 
+#include <algorithm>
 #include <memory>
+#include <new>
 
+#include "common/Allocator.hpp"
 #include "common/Variant.hpp"
 
 namespace love
 {
+    static constexpr size_t MIN_CHUNK_SIZE = 4 * 1024;
+    static constexpr size_t MAX_CHUNK_SIZE = Allocator::MAX_POOLED_SIZE;
+
+    Variant::SharedTable::SharedTable() : cursor(nullptr), remaining(0), tables(nullptr)
+    {}
+
+    Variant::SharedTable::~SharedTable()
+    {
+        for (Table* table = this->tables; table != nullptr; table = table->next)
+        {
+            std::destroy_n(table->array, table->arrayLength);
+
+            if (table->pairs != nullptr)
+                std::destroy_n(table->pairs, table->pairCount);
+        }
+
+        for (const auto& chunk : this->chunks)
+            Allocator::deallocate(chunk.first, chunk.second);
+    }
+
+    void* Variant::SharedTable::allocate(size_t size)
+    {
+        size = (size + Allocator::MIN_ALIGNMENT - 1) & ~(Allocator::MIN_ALIGNMENT - 1);
+
+        if (size > this->remaining)
+        {
+            // Chunks grow with the tables they hold, and oversized arrays get one to themselves.
+            size_t previous  = this->chunks.empty() ? 0 : this->chunks.back().second;
+            size_t chunkSize = std::clamp(previous * 2, MIN_CHUNK_SIZE, MAX_CHUNK_SIZE);
+            chunkSize        = std::max(chunkSize, size);
+
+            char* chunk = (char*)Allocator::allocate(chunkSize);
+            this->chunks.emplace_back(chunk, chunkSize);
+
+            this->cursor    = chunk;
+            this->remaining = chunkSize;
+        }
+
+        void* block = this->cursor;
+
+        this->cursor += size;
+        this->remaining -= size;
+
+        return block;
+    }
+
+    Variant::SharedTable::Table* Variant::SharedTable::newTable(size_t arrayLength)
+    {
+        auto* table = new (this->allocate(sizeof(Table))) Table();
+
+        table->array       = (Variant*)this->allocate(arrayLength * sizeof(Variant));
+        table->arrayLength = arrayLength;
+
+        std::uninitialized_default_construct_n(table->array, arrayLength);
+
+        table->shared = this;
+        table->next   = this->tables;
+        this->tables = table;
+
+        return table;
+    }
+
+    void Variant::SharedTable::setPairs(Table* table, std::pair<Variant, Variant>* pairs,
+                                        size_t count)
+    {
+        using Pair = std::pair<Variant, Variant>;
+
+        table->pairs = (Pair*)this->allocate(count * sizeof(Pair));
+        std::uninitialized_move_n(pairs, count, table->pairs);
+
+        table->pairCount = count;
+    }
+
     Variant::Variant(Type vtype) : type(vtype)
     {}
 
@@ -72,10 +148,13 @@ namespace love
             data.proxy.object->retain();
     }
 
-    // Variant gets ownership of the vector.
-    Variant::Variant(SharedTable* table) : type(TABLE)
+    Variant::Variant(SharedTable* shared, const SharedTable::Table* table) : type(TABLE)
     {
-        data.table = table;
+        data.table.shared = shared;
+        data.table.table  = table;
+
+        if (shared != nullptr)
+            shared->retain();
     }
 
     Variant::Variant(const Variant& v) : type(v.type), data(v.data)
@@ -85,10 +164,13 @@ namespace love
         else if (type == LOVEOBJECT && data.proxy.object != nullptr)
             data.proxy.object->retain();
         else if (type == TABLE)
-            data.table->retain();
+        {
+            data.table.shared = data.table.table->shared;
+            data.table.shared->retain();
+        }
     }
 
-    Variant::Variant(Variant&& v) : type(std::move(v.type)), data(std::move(v.data))
+    Variant::Variant(Variant&& v) noexcept : type(std::move(v.type)), data(std::move(v.data))
     {
         v.type = NIL;
     }
@@ -99,8 +181,8 @@ namespace love
             data.string->release();
         else if (type == LOVEOBJECT && data.proxy.object != nullptr)
             data.proxy.object->release();
-        else if (type == TABLE)
-            data.table->release();
+        else if (type == TABLE && data.table.shared != nullptr)
+            data.table.shared->release();
     }
 
     Variant& Variant::operator=(const Variant& v)
@@ -110,18 +192,36 @@ namespace love
         else if (v.type == LOVEOBJECT && v.data.proxy.object != nullptr)
             v.data.proxy.object->retain();
         else if (v.type == TABLE)
-            v.data.table->retain();
+            v.data.table.table->shared->retain();
 
         if (type == STRING)
             data.string->release();
         else if (type == LOVEOBJECT && data.proxy.object != nullptr)
             data.proxy.object->release();
-        else if (type == TABLE)
-            data.table->release();
+        else if (type == TABLE && data.table.shared != nullptr)
+            data.table.shared->release();
 
         type = v.type;
         data = v.data;
 
+        if (type == TABLE)
+            data.table.shared = data.table.table->shared;
+
+        return *this;
+    }
+
+    Variant& Variant::operator=(Variant&& v) noexcept
+    {
+        if (this != &v)
+        {
+            this->~Variant();
+
+            type = v.type;
+            data = v.data;
+
+            v.type = NIL;
+        }
+
         return *this;
     }
 
@@ -1,153 +1,442 @@
 #include "common/b64.hpp"
 #include "common/Exception.hpp"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <limits>
 
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define LOVE_B64_NEON
+#elif defined(__SSSE3__)
+    #include <tmmintrin.h>
+    #define LOVE_B64_SSSE3
+#endif
+
 namespace love
 {
-    static constexpr char cb64[] =
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    static constexpr char cb64[2][65] = {
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+    };
 
-    static constexpr char cd64[] =
-        "|$$$}rstuvwxyz{$$$$$$$>?@ABCDEFGHIJKLMNOPQRSTUVW$$$$$$XYZ[\\]^_`abcdefghijklmnopq";
+    // Decode table markers. Every other entry is the character's 6-bit value.
+    static constexpr uint8_t B64_INVALID = 0xFF;
+    static constexpr uint8_t B64_PADDING = 0xFE;
+    static constexpr uint8_t B64_NEWLINE = 0xFD;
 
-    static void b64_encode_block(char in[3], char out[4], int len)
+    static constexpr std::array<uint8_t, 256> makeDecodeTable(const char* alphabet)
     {
-        out[0] = (char)cb64[(int)((in[0] & 0xFC) >> 2)];
-        out[1] = (char)cb64[(int)(((in[0] & 0x03) << 4) | ((in[1] & 0xF0) >> 4))];
-        out[2] = (char)(len > 1 ? cb64[(int)(((in[1] & 0x0F) << 2) | ((in[2] & 0xC0) >> 6))] : '=');
-        out[3] = (char)(len > 2 ? cb64[(int)(in[2] & 0x3F)] : '=');
+        std::array<uint8_t, 256> table {};
+
+        for (auto& value : table)
+            value = B64_INVALID;
+
+        for (uint8_t index = 0; index < 64; index++)
+            table[(uint8_t)alphabet[index]] = index;
+
+        table['=']  = B64_PADDING;
+        table['\r'] = B64_NEWLINE;
+        table['\n'] = B64_NEWLINE;
+
+        return table;
     }
 
-    char* b64_encode(const char* source, size_t sourceLength, size_t lineLength, size_t& dstLength)
+    static constexpr std::array<uint8_t, 256> cd64[2] = { makeDecodeTable(cb64[BASE64_STANDARD]),
+                                                          makeDecodeTable(cb64[BASE64_URL]) };
+
+    /*
+    ** Vector kernels. Each one handles a fixed number of whole 3-byte groups; the scalar code
+    ** below does the rest, so any target without NEON or SSSE3 still gets the same output.
+    */
+
+#if defined(LOVE_B64_NEON)
+    static constexpr size_t ENCODE_VECTOR_READ   = 48;
+    static constexpr size_t ENCODE_VECTOR_INPUT  = 48;
+    static constexpr size_t ENCODE_VECTOR_OUTPUT = 64;
+    static constexpr size_t DECODE_VECTOR_READ   = 64;
+    static constexpr size_t DECODE_VECTOR_INPUT  = 64;
+    static constexpr size_t DECODE_VECTOR_OUTPUT = 48;
+
+    static inline uint8x16x4_t loadTable(const uint8_t* table)
     {
-        if (lineLength == 0)
-            lineLength = std::numeric_limits<size_t>::max();
+        return uint8x16x4_t { { vld1q_u8(table), vld1q_u8(table + 16), vld1q_u8(table + 32),
+                                vld1q_u8(table + 48) } };
+    }
 
-        size_t blocksOut      = 0;
-        size_t sourcePosition = 0;
+    static void encodeVector(const uint8_t* source, char* destination, Base64Alphabet alphabet)
+    {
+        const uint8x16x4_t table = loadTable((const uint8_t*)cb64[alphabet]);
+        const uint8x16_t mask    = vdupq_n_u8(0x3F);
 
-        size_t adjustment   = (sourceLength % 3) ? (3 - (sourceLength % 3)) : 0;
-        size_t paddedLength = ((sourceLength + adjustment) / 3) * 4;
+        uint8x16x3_t input = vld3q_u8(source);
+        uint8x16x4_t output;
 
-        dstLength = paddedLength + paddedLength / lineLength;
+        uint8x16_t first  = vorrq_u8(vshlq_n_u8(input.val[0], 4), vshrq_n_u8(input.val[1], 4));
+        uint8x16_t second = vorrq_u8(vshlq_n_u8(input.val[1], 2), vshrq_n_u8(input.val[2], 6));
 
-        if (dstLength == 0)
-            return nullptr;
+        output.val[0] = vshrq_n_u8(input.val[0], 2);
+        output.val[1] = vandq_u8(first, mask);
+        output.val[2] = vandq_u8(second, mask);
+        output.val[3] = vandq_u8(input.val[2], mask);
 
-        char* destination = nullptr;
+        for (auto& lane : output.val)
+            lane = vqtbl4q_u8(table, lane);
 
-        try
+        vst4q_u8((uint8_t*)destination, output);
+    }
+
+    // Returns false without writing anything if the block holds a character outside the
+    // alphabet, so the scalar decoder can deal with it.
+    static bool decodeVector(const char* source, uint8_t* destination, Base64Alphabet alphabet)
+    {
+        const uint8x16x4_t low  = loadTable(cd64[alphabet].data());
+        const uint8x16x4_t high = loadTable(cd64[alphabet].data() + 64);
+
+        uint8x16x4_t input = vld4q_u8((const uint8_t*)source);
+        uint8x16_t invalid = vdupq_n_u8(0);
+
+        // Out of range indices look up zero, so characters >= 128 are flagged separately.
+        for (auto& lane : input.val)
         {
-            destination = new char[dstLength + 1];
+            uint8x16_t value = vorrq_u8(vqtbl4q_u8(low, lane),
+                                        vqtbl4q_u8(high, vsubq_u8(lane, vdupq_n_u8(64))));
+
+            invalid = vorrq_u8(invalid, vcgtq_u8(value, vdupq_n_u8(63)));
+            invalid = vorrq_u8(invalid, vcgeq_u8(lane, vdupq_n_u8(128)));
+            lane    = value;
         }
-        catch (std::bad_alloc&)
+
+        if (vmaxvq_u8(invalid) != 0)
+            return false;
+
+        uint8x16x3_t output;
+
+        output.val[0] = vorrq_u8(vshlq_n_u8(input.val[0], 2), vshrq_n_u8(input.val[1], 4));
+        output.val[1] = vorrq_u8(vshlq_n_u8(input.val[1], 4), vshrq_n_u8(input.val[2], 2));
+        output.val[2] = vorrq_u8(vshlq_n_u8(input.val[2], 6), input.val[3]);
+
+        vst3q_u8(destination, output);
+        return true;
+    }
+#elif defined(LOVE_B64_SSSE3)
+    // The encoder reads 16 bytes but only consumes 12. The decoder writes 16 bytes of which 12
+    // are kept, so it needs 32 characters left to be sure the extra 4 fit in the output.
+    static constexpr size_t ENCODE_VECTOR_READ   = 16;
+    static constexpr size_t ENCODE_VECTOR_INPUT  = 12;
+    static constexpr size_t ENCODE_VECTOR_OUTPUT = 16;
+    static constexpr size_t DECODE_VECTOR_READ   = 32;
+    static constexpr size_t DECODE_VECTOR_INPUT  = 16;
+    static constexpr size_t DECODE_VECTOR_OUTPUT = 12;
+
+    static constexpr char lastTwo[2][2] = { { '+', '/' }, { '-', '_' } };
+
+    static void encodeVector(const uint8_t* source, char* destination, Base64Alphabet alphabet)
+    {
+        __m128i input = _mm_loadu_si128((const __m128i*)source);
+        input = _mm_shuffle_epi8(input, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9,
+                                                      11, 10));
+
+        // Moves the four 6-bit fields of every 24-bit group into their own byte.
+        __m128i high    = _mm_mulhi_epu16(_mm_and_si128(input, _mm_set1_epi32(0x0FC0FC00)),
+                                          _mm_set1_epi32(0x04000040));
+        __m128i low     = _mm_mullo_epi16(_mm_and_si128(input, _mm_set1_epi32(0x003F03F0)),
+                                          _mm_set1_epi32(0x01000010));
+        __m128i indices = _mm_or_si128(high, low);
+
+        // Maps each index to the offset of its range: 0 for a-z, 1-10 for 0-9, 11 and 12 for
+        // the last two characters and 13 for A-Z.
+        __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+        __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+        range         = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+
+        const char plus  = lastTwo[alphabet][0] - 62;
+        const char slash = lastTwo[alphabet][1] - 63;
+
+        __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                        '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, plus,
+                                        slash, 'A', 0, 0);
+
+        __m128i output = _mm_add_epi8(indices, _mm_shuffle_epi8(offsets, range));
+        _mm_storeu_si128((__m128i*)destination, output);
+    }
+
+    static inline __m128i inRange(__m128i input, char first, char last)
+    {
+        return _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8(first - 1)),
+                             _mm_cmpgt_epi8(_mm_set1_epi8(last + 1), input));
+    }
+
+    static bool decodeVector(const char* source, uint8_t* destination, Base64Alphabet alphabet)
+    {
+        __m128i input = _mm_loadu_si128((const __m128i*)source);
+
+        __m128i upper = inRange(input, 'A', 'Z');
+        __m128i lower = inRange(input, 'a', 'z');
+        __m128i digit = inRange(input, '0', '9');
+        __m128i plus  = _mm_cmpeq_epi8(input, _mm_set1_epi8(lastTwo[alphabet][0]));
+        __m128i slash = _mm_cmpeq_epi8(input, _mm_set1_epi8(lastTwo[alphabet][1]));
+
+        __m128i valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, plus));
+        if (_mm_movemask_epi8(_mm_or_si128(valid, slash)) != 0xFFFF)
+            return false;
+
+        __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+        shift = _mm_or_si128(shift, _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+        shift = _mm_or_si128(shift, _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+        shift = _mm_or_si128(shift, _mm_and_si128(plus, _mm_set1_epi8(62 - lastTwo[alphabet][0])));
+        shift = _mm_or_si128(shift, _mm_and_si128(slash, _mm_set1_epi8(63 - lastTwo[alphabet][1])));
+
+        __m128i values = _mm_add_epi8(input, shift);
+
+        // Joins pairs of 6-bit values into 12 bits, then pairs of those into 24 bits.
+        __m128i pairs  = _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+        __m128i groups = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+
+        __m128i output = _mm_shuffle_epi8(groups, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13,
+                                                                12, -1, -1, -1, -1));
+        _mm_storeu_si128((__m128i*)destination, output);
+        return true;
+    }
+#endif
+
+    // Encodes `length` bytes, which must be a multiple of 3.
+    static char* b64_encode_groups(const uint8_t* source, size_t length, char* destination,
+                                   Base64Alphabet alphabet)
+    {
+        const char* chars = cb64[alphabet];
+        size_t position   = 0;
+
+#if defined(LOVE_B64_NEON) || defined(LOVE_B64_SSSE3)
+        while (length - position >= ENCODE_VECTOR_READ)
         {
-            throw love::Exception(E_OUT_OF_MEMORY);
+            encodeVector(source + position, destination, alphabet);
+            position += ENCODE_VECTOR_INPUT;
+            destination += ENCODE_VECTOR_OUTPUT;
         }
+#endif
 
-        size_t dstPosition = 0;
+        for (; position < length; position += 3)
+        {
+            uint32_t group = (source[position] << 16) | (source[position + 1] << 8) |
+                             source[position + 2];
+
+            *destination++ = chars[(group >> 18) & 0x3F];
+            *destination++ = chars[(group >> 12) & 0x3F];
+            *destination++ = chars[(group >> 6) & 0x3F];
+            *destination++ = chars[group & 0x3F];
+        }
+
+        return destination;
+    }
+
+    // Lines hold whole 4-character groups.
+    static size_t b64_line_chars(size_t lineLength)
+    {
+        if (lineLength == 0)
+            return std::numeric_limits<size_t>::max();
+
+        return std::max<size_t>(lineLength / 4 * 4, 4);
+    }
+
+    // Characters before line breaks are added.
+    static size_t b64_unbroken_size(size_t sourceLength, Base64Alphabet alphabet)
+    {
+        size_t remainder = sourceLength % 3;
+        size_t length    = (sourceLength / 3) * 4;
 
-        while (sourcePosition < sourceLength)
+        if (remainder != 0)
+            length += (alphabet == BASE64_URL) ? remainder + 1 : 4;
+
+        return length;
+    }
+
+    size_t b64_encoded_size(size_t sourceLength, size_t lineLength, Base64Alphabet alphabet)
+    {
+        size_t length = b64_unbroken_size(sourceLength, alphabet);
+        return length + length / b64_line_chars(lineLength);
+    }
+
+    void b64_encode_into(const char* source, size_t sourceLength, size_t lineLength,
+                         char* destination, Base64Alphabet alphabet)
+    {
+        size_t charsPerLine = b64_line_chars(lineLength);
+        size_t remainder    = sourceLength % 3;
+
+        const auto* input = (const uint8_t*)source;
+        char* output      = destination;
+
+        size_t wholeBytes   = sourceLength - remainder;
+        size_t bytesPerLine = (lineLength == 0) ? wholeBytes : charsPerLine / 4 * 3;
+        size_t position     = 0;
+
+        while (position < wholeBytes)
         {
-            char in[3]  = { 0 };
-            char out[4] = { 0 };
+            size_t count = std::min(bytesPerLine, wholeBytes - position);
+            output       = b64_encode_groups(input + position, count, output, alphabet);
+            position += count;
 
-            int len = 0;
+            if (lineLength != 0 && count == bytesPerLine)
+                *output++ = '\n';
+        }
 
-            for (int i = 0; i < 3; i++)
-            {
-                if (sourcePosition >= sourceLength)
-                    break;
+        if (remainder != 0)
+        {
+            const char* chars = cb64[alphabet];
+            uint32_t group    = input[position] << 16;
 
-                in[i] = source[sourcePosition++];
-                len++;
-            }
+            if (remainder == 2)
+                group |= input[position + 1] << 8;
 
-            if (len > 0)
-            {
-                b64_encode_block(in, out, len);
+            *output++ = chars[(group >> 18) & 0x3F];
+            *output++ = chars[(group >> 12) & 0x3F];
 
-                for (int i = 0; i < 4 && dstPosition < dstLength; i++, dstPosition++)
-                    destination[dstPosition] = out[i];
+            if (remainder == 2)
+                *output++ = chars[(group >> 6) & 0x3F];
+            else if (alphabet != BASE64_URL)
+                *output++ = '=';
 
-                blocksOut++;
-            }
+            if (alphabet != BASE64_URL)
+                *output++ = '=';
 
-            if (blocksOut >= lineLength / 4 || sourcePosition >= sourceLength)
-            {
-                if (blocksOut > 0 && dstPosition < dstLength)
-                    destination[dstPosition++] = '\n';
+            if ((b64_unbroken_size(sourceLength, alphabet) % charsPerLine) == 0)
+                *output++ = '\n';
+        }
+    }
 
-                blocksOut = 0;
-            }
+    char* b64_encode(const char* source, size_t sourceLength, size_t lineLength, size_t& dstLength,
+                     Base64Alphabet alphabet)
+    {
+        dstLength = b64_encoded_size(sourceLength, lineLength, alphabet);
+
+        if (dstLength == 0)
+            return nullptr;
+
+        char* destination = nullptr;
+
+        try
+        {
+            destination = new char[dstLength + 1];
         }
+        catch (std::bad_alloc&)
+        {
+            throw love::Exception(E_OUT_OF_MEMORY);
+        }
+
+        b64_encode_into(source, sourceLength, lineLength, destination, alphabet);
 
-        destination[dstPosition] = '\0';
+        destination[dstLength] = '\0';
         return destination;
     }
 
-    static void b64_decode_block(char in[4], char out[3])
+    static inline void b64_decode_group(const uint8_t values[4], uint8_t*& destination)
     {
-        out[0] = (char)(in[0] << 2 | in[1] >> 4);
-        out[1] = (char)(in[1] << 4 | in[2] >> 2);
-        out[2] = (char)(((in[2] << 6) & 0xc0) | in[3]);
+        uint32_t group = (values[0] << 18) | (values[1] << 12) | (values[2] << 6) | values[3];
+
+        *destination++ = (uint8_t)(group >> 16);
+        *destination++ = (uint8_t)(group >> 8);
+        *destination++ = (uint8_t)group;
     }
 
-    char* b64_decode(const char* source, size_t sourceLength, size_t& size)
+    char* b64_decode(const char* source, size_t sourceLength, size_t& size,
+                     Base64Alphabet alphabet, bool strict)
     {
-        size_t paddedSize = (sourceLength / 4) * 3;
+        // Unpadded input can end in a partial group of up to 2 bytes.
+        size_t capacity = (sourceLength / 4) * 3 + 2;
 
-        char* destination = nullptr;
+        uint8_t* destination = nullptr;
 
         try
         {
-            destination = new char[paddedSize];
+            destination = new uint8_t[capacity];
         }
         catch (std::bad_alloc&)
         {
             throw love::Exception(E_OUT_OF_MEMORY);
         }
 
-        auto* destCopy = destination;
+        const auto& table = cd64[alphabet];
+        uint8_t* output   = destination;
 
-        char in[4]  = { 0 };
-        char out[3] = { 0 };
-        size_t i, len, srcpos = 0;
+        uint8_t values[4] = { 0 };
+        size_t count      = 0;
+        size_t padding    = 0;
+        size_t position   = 0;
 
-        while (srcpos <= sourceLength)
+        try
         {
-            for (len = 0, i = 0; i < 4 && srcpos <= sourceLength; i++)
+            while (position < sourceLength)
             {
-                char v = 0;
-
-                while (srcpos <= sourceLength && v == 0)
+#if defined(LOVE_B64_NEON) || defined(LOVE_B64_SSSE3)
+                // Blocks only start at group boundaries.
+                while (count == 0 && padding == 0 &&
+                       sourceLength - position >= DECODE_VECTOR_READ &&
+                       decodeVector(source + position, output, alphabet))
                 {
-                    v = source[srcpos++];
-                    v = (char)((v < 43 || v > 122) ? 0 : cd64[v - 43]);
-                    if (v != 0)
-                        v = (char)((v == '$') ? 0 : v - 61);
+                    position += DECODE_VECTOR_INPUT;
+                    output += DECODE_VECTOR_OUTPUT;
                 }
 
-                if (srcpos <= sourceLength)
+                if (position == sourceLength)
+                    break;
+#endif
+
+                // Runs until the next group boundary, or past one character that the vector
+                // kernel refused.
+                do
                 {
-                    len++;
-                    if (v != 0)
-                        in[i] = (char)(v - 1);
-                }
-                else
-                    in[i] = 0;
+                    uint8_t value = table[(uint8_t)source[position]];
+
+                    if (value < 64 && padding == 0)
+                    {
+                        values[count++] = value;
+
+                        if (count == 4)
+                        {
+                            b64_decode_group(values, output);
+                            count = 0;
+                        }
+                    }
+                    else if (strict && value == B64_PADDING && count >= 2 && count + padding < 4)
+                        padding++;
+                    else if (strict && value != B64_NEWLINE)
+                        throw love::Exception(E_INVALID_BASE64_CHARACTER, position);
+
+                    position++;
+                } while (count != 0 && position < sourceLength);
             }
 
-            if (len)
+            if (strict && count == 1)
+                throw love::Exception(E_INVALID_BASE64_PADDING);
+
+            if (strict && count != 0 && (count + padding) != 4)
             {
-                b64_decode_block(in, out);
-                for (i = 0; i < len - 1; i++)
-                    *(destCopy++) = out[i];
+                if (padding != 0 || alphabet != BASE64_URL)
+                    throw love::Exception(E_INVALID_BASE64_PADDING);
             }
         }
+        catch (love::Exception&)
+        {
+            delete[] destination;
+            throw;
+        }
 
-        size = (size_t)(ptrdiff_t)(destCopy - destination);
-        return destination;
+        // A trailing partial group holds count - 1 whole bytes.
+        if (count >= 2)
+        {
+            for (size_t index = count; index < 4; index++)
+                values[index] = 0;
+
+            uint8_t last[3];
+            uint8_t* lastOutput = last;
+            b64_decode_group(values, lastOutput);
+
+            for (size_t index = 0; index < count - 1; index++)
+                *output++ = last[index];
+        }
+
+        size = (size_t)(output - destination);
+        return (char*)destination;
     }
 } // namespace love
@@ -0,0 +1,251 @@
+#include "common/hex.hpp"
+#include "common/Exception.hpp"
+
+#include <array>
+#include <cstdint>
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define LOVE_HEX_NEON
+#elif defined(__SSSE3__)
+    #include <tmmintrin.h>
+    #define LOVE_HEX_SSSE3
+#endif
+
+namespace love
+{
+    static constexpr char hexChars[2][17] = { "0123456789abcdef", "0123456789ABCDEF" };
+
+    static constexpr uint8_t HEX_INVALID = 0xFF;
+
+    static constexpr std::array<uint8_t, 256> makeNibbleTable()
+    {
+        std::array<uint8_t, 256> table {};
+
+        for (auto& value : table)
+            value = HEX_INVALID;
+
+        for (uint8_t index = 0; index < 16; index++)
+        {
+            table[(uint8_t)hexChars[0][index]] = index;
+            table[(uint8_t)hexChars[1][index]] = index;
+        }
+
+        return table;
+    }
+
+    static constexpr std::array<uint8_t, 256> nibbles = makeNibbleTable();
+
+    /*
+    ** Vector kernels turn 16 bytes into 32 characters and back, looking nibbles up with a byte
+    ** shuffle. The decoder refuses a block holding anything but hex digits and leaves it to
+    ** the scalar code, which knows how to report or zero it.
+    */
+
+#if defined(LOVE_HEX_NEON)
+    static void encodeVector(const uint8_t* source, char* destination, bool uppercase)
+    {
+        const uint8x16_t table = vld1q_u8((const uint8_t*)hexChars[uppercase]);
+
+        uint8x16_t input = vld1q_u8(source);
+        uint8x16x2_t output;
+
+        output.val[0] = vqtbl1q_u8(table, vshrq_n_u8(input, 4));
+        output.val[1] = vqtbl1q_u8(table, vandq_u8(input, vdupq_n_u8(0x0F)));
+
+        vst2q_u8((uint8_t*)destination, output);
+    }
+
+    static bool decodeVector(const char* source, uint8_t* destination)
+    {
+        uint8x16x2_t input = vld2q_u8((const uint8_t*)source);
+        uint8x16_t valid   = vdupq_n_u8(0xFF);
+
+        for (auto& lane : input.val)
+        {
+            uint8x16_t digit  = vsubq_u8(lane, vdupq_n_u8('0'));
+            uint8x16_t letter = vsubq_u8(vorrq_u8(lane, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+
+            uint8x16_t isDigit  = vcltq_u8(digit, vdupq_n_u8(10));
+            uint8x16_t isLetter = vcltq_u8(letter, vdupq_n_u8(6));
+
+            valid = vandq_u8(valid, vorrq_u8(isDigit, isLetter));
+            lane  = vbslq_u8(isDigit, digit, vaddq_u8(letter, vdupq_n_u8(10)));
+        }
+
+        if (vminvq_u8(valid) == 0)
+            return false;
+
+        vst1q_u8(destination, vorrq_u8(vshlq_n_u8(input.val[0], 4), input.val[1]));
+        return true;
+    }
+#elif defined(LOVE_HEX_SSSE3)
+    static void encodeVector(const uint8_t* source, char* destination, bool uppercase)
+    {
+        const __m128i table = _mm_loadu_si128((const __m128i*)hexChars[uppercase]);
+        const __m128i mask  = _mm_set1_epi8(0x0F);
+
+        __m128i input = _mm_loadu_si128((const __m128i*)source);
+        __m128i high  = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(input, 4), mask));
+        __m128i low   = _mm_shuffle_epi8(table, _mm_and_si128(input, mask));
+
+        _mm_storeu_si128((__m128i*)destination, _mm_unpacklo_epi8(high, low));
+        _mm_storeu_si128((__m128i*)destination + 1, _mm_unpackhi_epi8(high, low));
+    }
+
+    static inline __m128i inRange(__m128i input, char first, char last)
+    {
+        return _mm_and_si128(_mm_cmpgt_epi8(input, _mm_set1_epi8(first - 1)),
+                             _mm_cmpgt_epi8(_mm_set1_epi8(last + 1), input));
+    }
+
+    // Returns 8 bytes as 16-bit lanes, or sets `valid` to false.
+    static inline __m128i decodeHalf(const char* source, bool& valid)
+    {
+        __m128i input  = _mm_loadu_si128((const __m128i*)source);
+        __m128i folded = _mm_or_si128(input, _mm_set1_epi8(0x20));
+
+        __m128i isDigit  = inRange(input, '0', '9');
+        __m128i isLetter = inRange(folded, 'a', 'f');
+
+        if (_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) != 0xFFFF)
+            valid = false;
+
+        __m128i digit  = _mm_and_si128(isDigit, _mm_sub_epi8(input, _mm_set1_epi8('0')));
+        __m128i letter = _mm_and_si128(isLetter, _mm_sub_epi8(folded, _mm_set1_epi8('a' - 10)));
+
+        // Each pair becomes high * 16 + low.
+        return _mm_maddubs_epi16(_mm_or_si128(digit, letter), _mm_set1_epi16(0x0110));
+    }
+
+    static bool decodeVector(const char* source, uint8_t* destination)
+    {
+        bool valid  = true;
+        __m128i low = decodeHalf(source, valid);
+        __m128i top = decodeHalf(source + 16, valid);
+
+        if (!valid)
+            return false;
+
+        _mm_storeu_si128((__m128i*)destination, _mm_packus_epi16(low, top));
+        return true;
+    }
+#endif
+
+    void hex_encode_into(const char* source, size_t sourceLength, char* destination,
+                         bool uppercase)
+    {
+        const auto* input = (const uint8_t*)source;
+        const char* chars = hexChars[uppercase];
+        size_t position   = 0;
+
+#if defined(LOVE_HEX_NEON) || defined(LOVE_HEX_SSSE3)
+        for (; sourceLength - position >= 16; position += 16)
+            encodeVector(input + position, destination + position * 2, uppercase);
+#endif
+
+        for (; position < sourceLength; position++)
+        {
+            destination[position * 2 + 0] = chars[input[position] >> 4];
+            destination[position * 2 + 1] = chars[input[position] & 0x0F];
+        }
+    }
+
+    char* hex_encode(const char* source, size_t sourceLength, size_t& destinationLength,
+                     bool uppercase)
+    {
+        destinationLength = sourceLength * 2;
+
+        if (destinationLength == 0)
+            return nullptr;
+
+        char* destination = nullptr;
+
+        try
+        {
+            destination = new char[destinationLength + 1];
+        }
+        catch (std::bad_alloc&)
+        {
+            throw love::Exception(E_OUT_OF_MEMORY);
+        }
+
+        hex_encode_into(source, sourceLength, destination, uppercase);
+
+        destination[destinationLength] = '\0';
+        return destination;
+    }
+
+    char* hex_decode(const char* source, size_t sourceLength, size_t& size, bool strict)
+    {
+        size_t prefix = 0;
+
+        if (sourceLength >= 2 && source[0] == '0' && (source[1] == 'x' || source[1] == 'X'))
+            prefix = 2;
+
+        source += prefix;
+        sourceLength -= prefix;
+
+        if (strict && (sourceLength % 2) != 0)
+            throw love::Exception(E_INVALID_HEX_LENGTH);
+
+        size = (sourceLength + 1) / 2;
+
+        if (size == 0)
+            return nullptr;
+
+        uint8_t* destination = nullptr;
+
+        try
+        {
+            destination = new uint8_t[size];
+        }
+        catch (std::bad_alloc&)
+        {
+            throw love::Exception(E_OUT_OF_MEMORY);
+        }
+
+        size_t whole = sourceLength / 2;
+        size_t index = 0;
+
+        while (index < whole)
+        {
+#if defined(LOVE_HEX_NEON) || defined(LOVE_HEX_SSSE3)
+            while (whole - index >= 16 && decodeVector(source + index * 2, destination + index))
+                index += 16;
+#endif
+
+            // One block's worth, or whatever is left after the last block.
+            size_t end = index + 16 < whole ? index + 16 : whole;
+
+            for (; index < end; index++)
+            {
+                uint8_t high = nibbles[(uint8_t)source[index * 2]];
+                uint8_t low  = nibbles[(uint8_t)source[index * 2 + 1]];
+
+                if (((high | low) & 0xF0) != 0)
+                {
+                    if (strict)
+                    {
+                        size_t offset = prefix + index * 2 + (high == HEX_INVALID ? 0 : 1);
+                        delete[] destination;
+                        throw love::Exception(E_INVALID_HEX_CHARACTER, offset);
+                    }
+
+                    high = (high == HEX_INVALID) ? 0 : high;
+                    low  = (low == HEX_INVALID) ? 0 : low;
+                }
+
+                destination[index] = (uint8_t)((high << 4) | low);
+            }
+        }
+
+        if (whole < size)
+        {
+            uint8_t high = nibbles[(uint8_t)source[whole * 2]];
+            destination[whole] = (high == HEX_INVALID) ? 0 : (uint8_t)(high << 4);
+        }
+
+        return (char*)destination;
+    }
+} // namespace love
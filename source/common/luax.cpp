@@ -3,13 +3,32 @@
 #include "common/Module.hpp"
 #include "common/Object.hpp"
 
-#include <cmath>
+#include <bit>
 #include <cstring>
 
 #define LOVE_UNUSED(x) (void)sizeof(x)
 
 namespace love
 {
+    // The objects table and each type's metatable are also kept in the registry under light
+    // userdata keys, so pushing an object can fetch them with raw gets rather than interning
+    // their string names every time.
+    static const char OBJECTS_KEY = 0;
+
+    static void luax_rawgetregistry(lua_State* L, const void* key)
+    {
+        lua_pushlightuserdata(L, (void*)key);
+        lua_rawget(L, LUA_REGISTRYINDEX);
+    }
+
+    // Stores the value at the top of the stack, popping it.
+    static void luax_rawsetregistry(lua_State* L, const void* key)
+    {
+        lua_pushlightuserdata(L, (void*)key);
+        lua_insert(L, -2);
+        lua_rawset(L, LUA_REGISTRYINDEX);
+    }
+
     // #region Startup
 
     int luax_preload(lua_State* L, lua_CFunction function, const char* name)
@@ -112,7 +131,29 @@ namespace love
             case REGISTRY_MODULES:
                 return luax_insistlove(L, MODULES_REGISTRY_KEY);
             case REGISTRY_OBJECTS:
-                return luax_insist(L, LUA_REGISTRYINDEX, OBJECTS_REGISTRY_KEY);
+            {
+                luax_rawgetregistry(L, &OBJECTS_KEY);
+
+                if (lua_istable(L, -1))
+                    return 1;
+
+                lua_pop(L, 1);
+                lua_newtable(L);
+
+                // Values are weak, so proxies are only reused while Lua still holds them.
+                lua_newtable(L);
+                lua_pushliteral(L, "v");
+                lua_setfield(L, -2, "__mode");
+                lua_setmetatable(L, -2);
+
+                lua_pushvalue(L, -1);
+                lua_setfield(L, LUA_REGISTRYINDEX, OBJECTS_REGISTRY_KEY);
+
+                lua_pushvalue(L, -1);
+                luax_rawsetregistry(L, &OBJECTS_KEY);
+
+                return 1;
+            }
             default:
                 return luaL_error(L, "Attempted to use invalid registry.");
         }
@@ -125,7 +166,7 @@ namespace love
             case REGISTRY_MODULES:
                 return luax_getlove(L, MODULES_REGISTRY_KEY);
             case REGISTRY_OBJECTS:
-                lua_getfield(L, LUA_REGISTRYINDEX, OBJECTS_REGISTRY_KEY);
+                luax_rawgetregistry(L, &OBJECTS_KEY);
                 return 1;
             default:
                 return luaL_error(L, "Attempted to use invalid registry.");
@@ -187,14 +228,14 @@ namespace love
 
     static ObjectKey luax_computeobjectkey(lua_State* L, Object* object)
     {
-        const size_t min_align = sizeof(void*) == 8 ? alignof(std::max_align_t) : 1;
-        uintptr_t key          = (uintptr_t)object;
+        constexpr size_t min_align = sizeof(void*) == 8 ? alignof(std::max_align_t) : 1;
+        constexpr int shift        = std::countr_zero(min_align);
+
+        uintptr_t key = (uintptr_t)object;
 
         if ((key & (min_align - 1)) != 0)
             luaL_error(L, E_UNEXPECTED_ALIGNMENT, object, (int)min_align);
 
-        static const size_t shift = (size_t)std::log2(min_align);
-
         key >>= shift;
         return (ObjectKey)key;
     }
@@ -216,7 +257,7 @@ namespace love
                 ObjectKey key = luax_computeobjectkey(L, object);
                 luax_pushobjectkey(L, key);
                 lua_pushnil(L);
-                lua_settable(L, -3);
+                lua_rawset(L, -3);
             }
 
             lua_pop(L, 1);
@@ -373,17 +414,26 @@ namespace love
         proxy->object = object;
         proxy->type   = &type;
 
-        const char* name = type.getName();
-        luaL_newmetatable(L, name);
-
-        lua_getfield(L, -1, "__gc");
-        bool has_gc = !lua_isnoneornil(L, -1);
-        lua_pop(L, 1);
+        luax_rawgetregistry(L, &type);
 
-        if (!has_gc)
+        // Only types that were never registered get here more than once per state.
+        if (!lua_istable(L, -1))
         {
-            lua_pushcfunction(L, w__gc);
-            lua_setfield(L, -2, "__gc");
+            lua_pop(L, 1);
+            luaL_newmetatable(L, type.getName());
+
+            lua_getfield(L, -1, "__gc");
+            bool has_gc = !lua_isnoneornil(L, -1);
+            lua_pop(L, 1);
+
+            if (!has_gc)
+            {
+                lua_pushcfunction(L, w__gc);
+                lua_setfield(L, -2, "__gc");
+            }
+
+            lua_pushvalue(L, -1);
+            luax_rawsetregistry(L, &type);
         }
 
         lua_setmetatable(L, -2);
@@ -408,7 +458,7 @@ namespace love
         ObjectKey key = luax_computeobjectkey(L, object);
         luax_pushobjectkey(L, key);
 
-        lua_gettable(L, -2);
+        lua_rawget(L, -2);
 
         if (lua_type(L, -1) != LUA_TUSERDATA)
         {
@@ -419,7 +469,7 @@ namespace love
             luax_pushobjectkey(L, key);
             lua_pushvalue(L, -2);
 
-            lua_settable(L, -4);
+            lua_rawset(L, -4);
         }
 
         lua_remove(L, -2);
@@ -451,17 +501,23 @@ namespace love
                 break;
             case Variant::TABLE:
             {
-                auto& table = data.table->pairs;
-                int tsize   = (int)table.size();
+                const auto* table = data.table.table;
 
-                lua_createtable(L, 0, tsize);
+                // Each level of nesting keeps its table and a key on the stack.
+                luaL_checkstack(L, 3, "tables nested too deeply");
+                lua_createtable(L, (int)table->arrayLength, (int)table->pairCount);
 
-                for (int i = 0; i < tsize; ++i)
+                for (size_t index = 0; index < table->arrayLength; index++)
                 {
-                    std::pair<Variant, Variant>& kv = table[i];
-                    luax_pushvariant(L, kv.first);
-                    luax_pushvariant(L, kv.second);
-                    lua_settable(L, -3);
+                    luax_pushvariant(L, table->array[index]);
+                    lua_rawseti(L, -2, (int)(index + 1));
+                }
+
+                for (size_t index = 0; index < table->pairCount; index++)
+                {
+                    luax_pushvariant(L, table->pairs[index].first);
+                    luax_pushvariant(L, table->pairs[index].second);
+                    lua_rawset(L, -3);
                 }
 
                 break;
@@ -473,96 +529,183 @@ namespace love
         }
     }
 
-    Variant luax_checkvariant(lua_State* L, int index, bool allowuserdata,
-                              std::set<const void*>* tableSet)
+    // Converts a value and every table nested in it, keeping all the tables in one SharedTable.
+    class VariantConverter
     {
-        size_t len;
-        const char* str;
-        Proxy* p = nullptr;
+      public:
+        VariantConverter(lua_State* L, bool allowUserdata) :
+            L(L),
+            allowUserdata(allowUserdata),
+            shared(nullptr)
+        {}
 
-        if (index < 0) // Fix the stack position, we might modify it later
-            index += lua_gettop(L) + 1;
+        ~VariantConverter()
+        {
+            if (this->shared != nullptr)
+                this->shared->release();
+        }
 
-        switch (lua_type(L, index))
+        Variant convert(int index)
         {
-            case LUA_TBOOLEAN:
-                return Variant(luax_toboolean(L, index));
-            case LUA_TNUMBER:
-                return Variant(lua_tonumber(L, index));
-            case LUA_TSTRING:
-                str = lua_tolstring(L, index, &len);
-                return Variant(str, len);
-            case LUA_TLIGHTUSERDATA:
-                return Variant(lua_touserdata(L, index));
-            case LUA_TUSERDATA:
-                if (!allowuserdata)
-                {
-                    luax_typeerror(L, index, "copyable Lua value");
+            if (lua_type(this->L, index) != LUA_TTABLE)
+                return this->convertValue(index);
+
+            this->shared = new Variant::SharedTable();
+            const auto* table = this->convertTable(index);
+
+            if (table == nullptr)
+                return Variant::unknown();
+
+            return Variant(this->shared, table);
+        }
+
+      private:
+        Variant convertValue(int index)
+        {
+            size_t length      = 0;
+            const char* string = nullptr;
+            Proxy* proxy       = nullptr;
+
+            switch (lua_type(this->L, index))
+            {
+                case LUA_TBOOLEAN:
+                    return Variant(luax_toboolean(this->L, index));
+                case LUA_TNUMBER:
+                    return Variant(lua_tonumber(this->L, index));
+                case LUA_TSTRING:
+                    string = lua_tolstring(this->L, index, &length);
+                    return Variant(string, length);
+                case LUA_TLIGHTUSERDATA:
+                    return Variant(lua_touserdata(this->L, index));
+                case LUA_TUSERDATA:
+                    if (!this->allowUserdata)
+                    {
+                        luax_typeerror(this->L, index, "copyable Lua value");
+                        return Variant();
+                    }
+
+                    proxy = luax_tryextractproxy(this->L, index);
+
+                    if (proxy != nullptr)
+                        return Variant(proxy->type, proxy->object);
+
+                    luax_typeerror(this->L, index, "love type");
                     return Variant();
-                }
-                p = luax_tryextractproxy(L, index);
-                if (p != nullptr)
-                    return Variant(p->type, p->object);
-                else
-                {
-                    luax_typeerror(L, index, "love type");
+                case LUA_TNIL:
                     return Variant();
+                case LUA_TTABLE:
+                {
+                    // Nested tables belong to the top-level Variant's SharedTable, and are
+                    // stored inside it without a reference to it.
+                    const auto* table = this->convertTable(index);
+
+                    if (table != nullptr)
+                        return Variant(nullptr, table);
+
+                    break;
                 }
-            case LUA_TNIL:
-                return Variant();
-            case LUA_TTABLE:
+            }
+
+            return Variant::unknown();
+        }
+
+        // Returns nullptr when a key or value cannot be converted.
+        Variant::SharedTable::Table* convertTable(int index)
+        {
+            const void* pointer = lua_topointer(this->L, index);
+
+            // Only the tables being converted are kept, so this stays as short as the nesting.
+            if (std::find(this->visiting.begin(), this->visiting.end(), pointer) !=
+                this->visiting.end())
             {
-                bool success = true;
-                std::set<const void*> topTableSet;
+                throw love::Exception(E_TABLE_CYCLE, "copied out of Lua");
+            }
 
-                // We can use a pointer to a stack-allocated variable because it's
-                // never used after the stack-allocated variable is destroyed.
-                if (tableSet == nullptr)
-                    tableSet = &topTableSet;
+            this->visiting.push_back(pointer);
 
-                // Now make sure this table wasn't already serialised
-                const void* tablePointer = lua_topointer(L, index);
-                {
-                    auto result = tableSet->insert(tablePointer);
-                    if (!result.second) // insertion failed
-                        throw love::Exception("Cycle detected in table");
-                }
+            size_t arrayLength = lua_objlen(this->L, index);
+            auto* table        = this->shared->newTable(arrayLength);
 
-                Variant::SharedTable* table = new Variant::SharedTable();
+            // Pairs of the tables being converted are stacked here, each table's on top of its
+            // parent's, until they can be moved into the SharedTable in one go.
+            size_t firstPair = this->pairs.size();
+            bool success     = true;
 
-                size_t len = luax_objlen(L, -1);
-                if (len > 0)
-                    table->pairs.reserve(len);
+            lua_pushnil(this->L);
 
-                lua_pushnil(L);
+            while (lua_next(this->L, index))
+            {
+                Variant value = this->convertValue(lua_gettop(this->L));
 
-                while (lua_next(L, index))
+                if (value.getType() == Variant::UNKNOWN)
                 {
-                    table->pairs.emplace_back(luax_checkvariant(L, -2, allowuserdata, tableSet),
-                                              luax_checkvariant(L, -1, allowuserdata, tableSet));
-                    lua_pop(L, 1);
+                    lua_pop(this->L, 2);
+                    success = false;
+                    break;
+                }
 
-                    const auto& p = table->pairs.back();
-                    if (p.first.getType() == Variant::UNKNOWN ||
-                        p.second.getType() == Variant::UNKNOWN)
+                // lua_next already walks the array part, so its keys go straight to their slots.
+                size_t slot = getArraySlot(lua_gettop(this->L) - 1, arrayLength);
+
+                if (slot < arrayLength)
+                    table->array[slot] = std::move(value);
+                else
+                {
+                    Variant key = this->convertValue(lua_gettop(this->L) - 1);
+
+                    if (key.getType() == Variant::UNKNOWN)
                     {
+                        lua_pop(this->L, 2);
                         success = false;
                         break;
                     }
-                }
 
-                // And remove the table from the set again
-                tableSet->erase(tablePointer);
+                    this->pairs.emplace_back(std::move(key), std::move(value));
+                }
 
-                if (success)
-                    return Variant(table);
-                else
-                    table->release();
+                lua_pop(this->L, 1);
             }
-            break;
+
+            this->shared->setPairs(table, this->pairs.data() + firstPair,
+                                   this->pairs.size() - firstPair);
+
+            this->pairs.resize(firstPair);
+            this->visiting.pop_back();
+
+            return success ? table : nullptr;
         }
 
-        return Variant::unknown();
+        // Returns the array index of an integer key from 1 to `length`, or `length` otherwise.
+        size_t getArraySlot(int index, size_t length) const
+        {
+            if (lua_type(this->L, index) != LUA_TNUMBER)
+                return length;
+
+            double key = lua_tonumber(this->L, index);
+
+            if (!(key >= 1 && key <= (double)length) || key != (double)(size_t)key)
+                return length;
+
+            return (size_t)key - 1;
+        }
+
+        lua_State* L;
+        bool allowUserdata;
+
+        Variant::SharedTable* shared;
+
+        std::vector<const void*> visiting;
+        std::vector<std::pair<Variant, Variant>> pairs;
+    };
+
+    Variant luax_checkvariant(lua_State* L, int index, bool allowuserdata)
+    {
+        // Fix the stack position, since converting tables pushes onto it.
+        if (index < 0)
+            index += lua_gettop(L) + 1;
+
+        VariantConverter converter(L, allowuserdata);
+        return converter.convert(index);
     }
 
     bool luax_toboolean(lua_State* L, int index)
@@ -738,27 +881,14 @@ namespace love
     {
         type->initialize();
 
-        luax_getregistry(L, REGISTRY_OBJECTS);
-
-        if (!lua_istable(L, -1))
-        {
-            lua_newtable(L);
-            lua_replace(L, -2);
-
-            lua_newtable(L);
-
-            lua_pushliteral(L, "v");
-            lua_setfield(L, -2, "__mode");
-
-            lua_setmetatable(L, -2);
-
-            lua_setfield(L, LUA_REGISTRYINDEX, OBJECTS_REGISTRY_KEY);
-        }
-        else
-            lua_pop(L, 1);
+        luax_insistregistry(L, REGISTRY_OBJECTS);
+        lua_pop(L, 1);
 
         luaL_newmetatable(L, type->getName());
 
+        lua_pushvalue(L, -1);
+        luax_rawsetregistry(L, type);
+
         lua_pushvalue(L, -1);
         lua_setfield(L, -2, "__index");
 
@@ -1,46 +1,38 @@
-#include <unordered_map>
+#include <atomic>
 
 #include "common/types.hpp"
 
+#include "common/Data.hpp"
+#include "common/Object.hpp"
+#include "common/Stream.hpp"
+
 namespace love
 {
-    static std::unordered_map<std::string, Type*> types;
-
-    Type::Type(const char* name, Type* parent) :
-        name(name),
-        parent(parent),
-        id(0),
-        initialized(false)
-    {}
+    // Written when types are registered with a Lua state, which any thread may do.
+    static std::atomic<Type*> types[Type::ID_MAX_ENUM];
 
-    void Type::initialize()
+    // The types getParentId() can return, which are registered along with their descendants.
+    static Type* getBaseType(Type::Id id)
     {
-        static uint32_t nextId = 1;
-
-        if (this->initialized)
-            return;
-
-        types[this->name] = this;
-
-        this->id             = nextId++;
-        this->bits[this->id] = true;
-        this->initialized    = true;
-
-        if (!this->parent)
-            return;
-
-        if (!this->parent->initialized)
-            this->parent->initialize();
-
-        this->bits |= this->parent->bits;
+        switch (id)
+        {
+            case Type::ID_OBJECT:
+                return &Object::type;
+            case Type::ID_DATA:
+                return &Data::type;
+            case Type::ID_STREAM:
+                return &Stream::type;
+            default:
+                return nullptr;
+        }
     }
 
-    uint32_t Type::getId()
+    void Type::initialize()
     {
-        if (!this->initialized)
-            this->initialize();
+        types[this->id].store(this, std::memory_order_relaxed);
 
-        return this->id;
+        for (Id id = getParentId((Id)this->id); id != ID_INVALID; id = getParentId(id))
+            types[id].store(getBaseType(id), std::memory_order_relaxed);
     }
 
     const char* Type::getName() const
@@ -48,12 +40,16 @@ namespace love
         return this->name;
     }
 
-    Type* Type::byName(const char* name)
+    Type* Type::byName(std::string_view name)
     {
-        auto it = types.find(name);
-        if (it == types.end())
-            return nullptr;
+        for (const auto& entry : types)
+        {
+            Type* type = entry.load(std::memory_order_relaxed);
+
+            if (type != nullptr && name == type->name)
+                return type;
+        }
 
-        return it->second;
+        return nullptr;
     }
 } // namespace love
@@ -1,3 +1,4 @@
+#include "common/Allocator.hpp"
 #include "common/Exception.hpp"
 
 #include "modules/data/ByteData.hpp"
@@ -7,17 +8,14 @@
 
 namespace love
 {
-    Type ByteData::type("ByteData", &Data::type);
+    Type ByteData::type("ByteData", Type::ID_BYTE_DATA);
 
-    ByteData::ByteData(size_t size, bool clear) : size(size)
+    ByteData::ByteData(size_t size, bool clear) : size(size), adopted(false)
     {
-        this->create();
-
-        if (clear)
-            std::fill_n(this->data, size, 0);
+        this->create(clear);
     }
 
-    ByteData::ByteData(const void* data, size_t size) : size(size)
+    ByteData::ByteData(const void* data, size_t size) : size(size), adopted(false)
     {
         this->create();
 
@@ -25,7 +23,7 @@ namespace love
             std::copy_n((const char*)data, size, this->data);
     }
 
-    ByteData::ByteData(void* data, size_t size, bool owned) : size(size)
+    ByteData::ByteData(void* data, size_t size, bool owned) : size(size), adopted(owned)
     {
         if (owned)
             this->data = (char*)data;
@@ -38,7 +36,7 @@ namespace love
         }
     }
 
-    ByteData::ByteData(const ByteData& other) : size(other.size)
+    ByteData::ByteData(const ByteData& other) : size(other.size), adopted(false)
     {
         this->create();
 
@@ -47,22 +45,18 @@ namespace love
 
     ByteData::~ByteData()
     {
-        delete[] this->data;
+        if (this->adopted)
+            delete[] this->data;
+        else
+            Allocator::deallocate(this->data, this->size);
     }
 
-    void ByteData::create()
+    void ByteData::create(bool clear)
     {
         if (this->size == 0)
             throw love::Exception("ByteData size must be greater than 0.");
 
-        try
-        {
-            this->data = new char[this->size];
-        }
-        catch (std::bad_alloc& e)
-        {
-            throw love::Exception(E_OUT_OF_MEMORY);
-        }
+        this->data = (char*)Allocator::allocate(this->size, clear);
     }
 
     ByteData* ByteData::clone() const
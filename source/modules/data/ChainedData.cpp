@@ -0,0 +1,126 @@
+#include "common/Allocator.hpp"
+#include "common/Exception.hpp"
+
+#include "modules/data/ChainedData.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace love
+{
+    Type ChainedData::type("ChainedData", Type::ID_CHAINED_DATA);
+
+    ChainedData::ChainedData() : size(0), flattened(nullptr), retired(nullptr), retiredSize(0)
+    {}
+
+    ChainedData::ChainedData(const ChainedData& other) :
+        segments(other.segments),
+        size(other.size),
+        flattened(nullptr),
+        retired(nullptr),
+        retiredSize(0)
+    {}
+
+    ChainedData::~ChainedData()
+    {
+        Allocator::deallocate(this->flattened, this->size);
+        Allocator::deallocate(this->retired, this->retiredSize);
+    }
+
+    ChainedData* ChainedData::clone() const
+    {
+        return new ChainedData(*this);
+    }
+
+    void* ChainedData::getData() const
+    {
+        if (this->size == 0)
+            return nullptr;
+
+        std::unique_lock lock(this->flattenMutex);
+
+        if (this->flattened == nullptr)
+            this->flattened = (char*)Allocator::allocate(this->size);
+
+        this->copyTo(this->flattened);
+        return this->flattened;
+    }
+
+    size_t ChainedData::getSize() const
+    {
+        return this->size;
+    }
+
+    void ChainedData::append(Data* data, size_t offset, size_t size)
+    {
+        if (offset > data->getSize() || size > data->getSize() - offset)
+            throw love::Exception(E_OFFSET_AND_SIZE_ARGS_FIT_WITHIN_DATA);
+
+        if (size == 0)
+            return;
+
+        this->segments.push_back({ data, offset, size });
+        this->grow(size);
+    }
+
+    void ChainedData::append(ChainedData* chain, size_t offset, size_t size)
+    {
+        if (offset > chain->size || size > chain->size - offset)
+            throw love::Exception(E_OFFSET_AND_SIZE_ARGS_FIT_WITHIN_DATA);
+
+        // Collected first, since `chain` may be this object.
+        std::vector<Segment> range;
+
+        chain->forEachRange(offset, size, [&](const Segment& segment, size_t start, size_t length) {
+            range.push_back({ segment.data, segment.offset + start, length });
+        });
+
+        this->segments.insert(this->segments.end(), range.begin(), range.end());
+        this->grow(size);
+    }
+
+    // Callers may still hold the current buffer, so it is kept until the chain grows again.
+    void ChainedData::grow(size_t size)
+    {
+        std::unique_lock lock(this->flattenMutex);
+
+        if (this->flattened != nullptr)
+        {
+            Allocator::deallocate(this->retired, this->retiredSize);
+
+            this->retired     = this->flattened;
+            this->retiredSize = this->size;
+            this->flattened   = nullptr;
+        }
+
+        this->size += size;
+    }
+
+    ChainedData* ChainedData::slice(size_t offset, size_t size) const
+    {
+        if (offset > this->size || size > this->size - offset)
+            throw love::Exception(E_OFFSET_AND_SIZE_ARGS_FIT_WITHIN_DATA);
+
+        auto* result = new ChainedData();
+
+        this->forEachRange(offset, size, [&](const Segment& segment, size_t start, size_t length) {
+            result->segments.push_back({ segment.data, segment.offset + start, length });
+        });
+
+        result->size = size;
+        return result;
+    }
+
+    const std::vector<ChainedData::Segment>& ChainedData::getSegments() const
+    {
+        return this->segments;
+    }
+
+    void ChainedData::copyTo(char* destination) const
+    {
+        this->forEachSegment([&](const char* bytes, size_t size) {
+            std::memcpy(destination, bytes, size);
+            destination += size;
+        });
+    }
+} // namespace love
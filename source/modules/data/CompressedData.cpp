@@ -4,7 +4,7 @@
 
 namespace love
 {
-    Type CompressedData::type("CompressedData", &Data::type);
+    Type CompressedData::type("CompressedData", Type::ID_COMPRESSED_DATA);
 
     CompressedData::CompressedData(Compressor::Format format, char* data, size_t size,
                                    size_t rawSize, bool own) :
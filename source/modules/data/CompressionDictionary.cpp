@@ -0,0 +1,81 @@
+#include "common/Exception.hpp"
+
+#include "modules/data/CompressionDictionary.hpp"
+
+namespace
+{
+    love::Compressor* getCompressor(love::Compressor::Format format)
+    {
+        love::Compressor* compressor = love::Compressor::getCompressor(format);
+
+        if (compressor == nullptr)
+            throw love::Exception("Invalid compression format.");
+
+        return compressor;
+    }
+} // namespace
+
+namespace love
+{
+    Type CompressionDictionary::type("CompressionDictionary", Type::ID_COMPRESSION_DICTIONARY);
+
+    CompressionDictionary::CompressionDictionary(Compressor::Format format, const void* data,
+                                                 size_t size) :
+        dictionary(nullptr)
+    {
+        Compressor* compressor = getCompressor(format);
+        this->dictionary.reset(compressor->newDictionary(format, (const char*)data, size));
+    }
+
+    CompressionDictionary::CompressionDictionary(Compressor::Format format,
+                                                 const std::vector<std::string_view>& samples) :
+        dictionary(nullptr)
+    {
+        Compressor* compressor = getCompressor(format);
+
+        std::vector<const char*> pointers;
+        std::vector<size_t> sizes;
+
+        for (const auto& sample : samples)
+        {
+            pointers.push_back(sample.data());
+            sizes.push_back(sample.size());
+        }
+
+        auto* result = compressor->trainDictionary(format, pointers.data(), sizes.data(),
+                                                   samples.size());
+        this->dictionary.reset(result);
+    }
+
+    CompressionDictionary::CompressionDictionary(const CompressionDictionary& other) :
+        dictionary(other.dictionary)
+    {}
+
+    CompressionDictionary::~CompressionDictionary()
+    {}
+
+    CompressionDictionary* CompressionDictionary::clone() const
+    {
+        return new CompressionDictionary(*this);
+    }
+
+    Compressor::Format CompressionDictionary::getFormat() const
+    {
+        return this->dictionary->getFormat();
+    }
+
+    Compressor::Dictionary& CompressionDictionary::getDictionary() const
+    {
+        return *this->dictionary;
+    }
+
+    void* CompressionDictionary::getData() const
+    {
+        return (void*)this->dictionary->getContent().data();
+    }
+
+    size_t CompressionDictionary::getSize() const
+    {
+        return this->dictionary->getContent().size();
+    }
+} // namespace love
@@ -0,0 +1,60 @@
+#include "common/Exception.hpp"
+
+#include "modules/data/CompressionStream.hpp"
+
+namespace love
+{
+    Type CompressionStream::type("CompressionStream", Type::ID_COMPRESSION_STREAM);
+
+    CompressionStream::CompressionStream(Mode mode, Compressor::Format format, int level) :
+        mode(mode),
+        format(format),
+        stream(nullptr)
+    {
+        Compressor* compressor = Compressor::getCompressor(format);
+
+        if (compressor == nullptr)
+            throw love::Exception("Invalid compression format.");
+
+        if (mode == MODE_COMPRESS)
+            this->stream.reset(compressor->newCompressionStream(format, level));
+        else
+            this->stream.reset(compressor->newDecompressionStream(format));
+    }
+
+    CompressionStream::~CompressionStream()
+    {}
+
+    CompressionStream::Mode CompressionStream::getMode() const
+    {
+        return this->mode;
+    }
+
+    Compressor::Format CompressionStream::getFormat() const
+    {
+        return this->format;
+    }
+
+    std::string_view CompressionStream::push(const char* input, size_t size)
+    {
+        if (!this->stream)
+            throw love::Exception(E_COMPRESSION_STREAM_FINISHED);
+
+        this->output.clear();
+        this->stream->push(input, size, this->output);
+
+        return std::string_view(this->output.data(), this->output.size());
+    }
+
+    std::string_view CompressionStream::finish()
+    {
+        if (!this->stream)
+            throw love::Exception(E_COMPRESSION_STREAM_FINISHED);
+
+        this->output.clear();
+        this->stream->finish(this->output);
+        this->stream.reset();
+
+        return std::string_view(this->output.data(), this->output.size());
+    }
+} // namespace love
@@ -1,116 +1,114 @@
 #include "modules/data/DataModule.hpp"
 
+#include "common/StrongRef.hpp"
+#include "common/ThreadPool.hpp"
 #include "common/b64.hpp"
+#include "common/hex.hpp"
 #include "common/int.hpp"
 
+#include "modules/data/misc/Serializer.hpp"
+
+#include <algorithm>
 #include <cmath>
 #include <list>
+#include <memory>
+#include <numeric>
+#include <vector>
 
-namespace
+namespace love
 {
-    static constexpr char hexChars[17] = "0123456789abcdef";
-
-    char* bytesToHex(const uint8_t* source, size_t sourceLength, size_t& destinationLength)
+    namespace data
     {
-        destinationLength = sourceLength * 2;
+        static Compressor* getCompressor(Compressor::Format format,
+                                         CompressionDictionary* dictionary)
+        {
+            auto* compressor = Compressor::getCompressor(format);
 
-        if (destinationLength == 0)
-            return nullptr;
+            if (compressor == nullptr)
+                throw love::Exception("Invalid compression format.");
 
-        char* destination = nullptr;
+            if (dictionary != nullptr && dictionary->getFormat() != format)
+                throw love::Exception(E_DICTIONARY_FORMAT_MISMATCH);
 
-        try
-        {
-            destination = new char[destinationLength + 1];
-        }
-        catch (std::bad_alloc& e)
-        {
-            throw love::Exception(E_OUT_OF_MEMORY);
+            return compressor;
         }
 
-        for (size_t index = 0; index < sourceLength; index++)
+        CompressedData* compress(Compressor::Format format, const char* bytes, size_t size,
+                                 int level, CompressionDictionary* dictionary)
         {
-            uint8_t byte = source[index];
-
-            destination[index * 2 + 0] = hexChars[byte >> 4];
-            destination[index * 2 + 1] = hexChars[byte & 0x0F];
-        }
-
-        destination[destinationLength] = '\0';
-        return destination;
-    }
-
-    uint8_t nibble(char c)
-    {
-        if (c >= '0' && c <= '9')
-            return (uint8_t)(c - '0');
+            auto* compressor      = getCompressor(format, dictionary);
+            size_t compressedSize = 0;
+            char* compressedBytes = nullptr;
 
-        if (c >= 'A' && c <= 'F')
-            return (uint8_t)(c - 'A' + 0x0A);
+            if (dictionary != nullptr)
+            {
+                auto& prepared  = dictionary->getDictionary();
+                compressedBytes = compressor->compress(format, prepared, bytes, size, level,
+                                                       compressedSize);
+            }
+            else
+                compressedBytes = compressor->compress(format, bytes, size, level, compressedSize);
 
-        if (c >= 'a' && c <= 'f')
-            return (uint8_t)(c - 'a' + 0x0A);
+            CompressedData* data = nullptr;
 
-        return 0;
-    }
+            try
+            {
+                data = new CompressedData(format, compressedBytes, compressedSize, size, true);
+            }
+            catch (love::Exception&)
+            {
+                delete[] compressedBytes;
+                throw;
+            }
 
-    uint8_t* hexToBytes(const char* source, size_t sourceLength, size_t& destinationLength)
-    {
-        if (sourceLength >= 2 && source[0] == '0' && (source[1] == 'x' || source[1] == 'X'))
-        {
-            source += 2;
-            sourceLength -= 2;
+            return data;
         }
 
-        destinationLength = (sourceLength + 1) / 2;
-
-        if (destinationLength == 0)
-            return nullptr;
-
-        uint8_t* destination = nullptr;
-
-        try
-        {
-            destination = new uint8_t[destinationLength];
-        }
-        catch (std::bad_alloc&)
+        CompressedData* compress(Compressor::Format format, ChainedData* chain, int level,
+                                 CompressionDictionary* dictionary)
         {
-            throw love::Exception(E_OUT_OF_MEMORY);
-        }
+            const auto& segments = chain->getSegments();
 
-        for (size_t i = 0; i < destinationLength; i++)
-        {
-            destination[i] = nibble(source[i * 2]) << 4;
+            if (segments.size() == 1)
+            {
+                return compress(format, segments[0].getBytes(), segments[0].size, level,
+                                dictionary);
+            }
 
-            if (i * 2 + 1 < sourceLength)
-                destination[i] |= nibble(source[i * 2 + 1]);
-        }
+            if (format == Compressor::FORMAT_LZ4 || dictionary != nullptr)
+            {
+                return compress(format, (const char*)chain->getData(), chain->getSize(), level,
+                                dictionary);
+            }
 
-        return destination;
-    }
-} // namespace
+            auto* compressor = getCompressor(format, nullptr);
+            std::unique_ptr<Compressor::Stream> stream(
+                compressor->newCompressionStream(format, level));
 
-namespace love
-{
-    namespace data
-    {
-        CompressedData* compress(Compressor::Format format, const char* bytes, size_t size,
-                                 int level)
-        {
-            auto* compressor = Compressor::getCompressor(format);
+            std::vector<char> output;
+            chain->forEachSegment(
+                [&](const char* bytes, size_t size) { stream->push(bytes, size, output); });
+            stream->finish(output);
 
-            if (compressor == nullptr)
-                throw love::Exception("Invalid compression format.");
+            char* compressedBytes = nullptr;
 
-            size_t compressedSize = 0;
-            auto* compressedBytes =
-                compressor->compress(format, bytes, size, level, compressedSize);
+            try
+            {
+                compressedBytes = new char[output.size()];
+            }
+            catch (std::bad_alloc&)
+            {
+                throw love::Exception(E_OUT_OF_MEMORY);
+            }
+
+            std::copy(output.begin(), output.end(), compressedBytes);
 
             CompressedData* data = nullptr;
 
             try
             {
-                data = new CompressedData(format, compressedBytes, compressedSize, size, true);
+                data = new CompressedData(format, compressedBytes, output.size(),
+                                          chain->getSize(), true);
             }
             catch (love::Exception&)
             {
@@ -121,50 +119,106 @@ namespace love
             return data;
         }
 
-        char* decompress(Compressor::Format format, const char* bytes, size_t size, size_t& rawSize)
+        char* decompress(Compressor::Format format, const char* bytes, size_t size, size_t& rawSize,
+                         CompressionDictionary* dictionary)
         {
-            auto* compressor = Compressor::getCompressor(format);
+            auto* compressor = getCompressor(format, dictionary);
 
-            if (compressor == nullptr)
-                throw love::Exception("Invalid compression format.");
+            if (dictionary != nullptr)
+            {
+                auto& prepared = dictionary->getDictionary();
+                return compressor->decompress(format, prepared, bytes, size, rawSize);
+            }
 
             return compressor->decompress(format, bytes, size, rawSize);
         }
 
-        char* decompress(CompressedData* data, size_t& decompressedSize)
+        char* decompress(CompressedData* data, size_t& decompressedSize,
+                         CompressionDictionary* dictionary)
         {
             size_t rawSize = data->getDecompressedSize();
 
             auto* bytes = decompress(data->getFormat(), (const char*)data->getData(),
-                                     data->getSize(), rawSize);
+                                     data->getSize(), rawSize, dictionary);
 
             decompressedSize = rawSize;
             return bytes;
         }
 
+        size_t decompressInto(Compressor::Format format, const char* bytes, size_t size,
+                              char* destination, size_t capacity)
+        {
+            auto* compressor = getCompressor(format, nullptr);
+            return compressor->decompressInto(format, bytes, size, destination, capacity);
+        }
+
+        size_t decompressInto(CompressedData* data, char* destination, size_t capacity)
+        {
+            if (data->getDecompressedSize() > capacity)
+                throw love::Exception(E_DECOMPRESS_DESTINATION_TOO_SMALL);
+
+            return decompressInto(data->getFormat(), (const char*)data->getData(),
+                                  data->getSize(), destination, capacity);
+        }
+
         char* encode(EncodeFormat format, const void* source, size_t size,
-                     size_t& destinationLength, size_t lineLength)
+                     size_t& destinationLength, size_t lineLength, bool uppercase)
         {
             switch (format)
             {
                 default:
                 case ENCODE_BASE64:
                     return b64_encode((const char*)source, size, lineLength, destinationLength);
+                case ENCODE_BASE64URL:
+                    return b64_encode((const char*)source, size, lineLength, destinationLength,
+                                      BASE64_URL);
                 case ENCODE_HEX:
-                    return bytesToHex((const uint8_t*)source, size, destinationLength);
+                    return hex_encode((const char*)source, size, destinationLength, uppercase);
             }
         }
 
+        size_t encodeInto(EncodeFormat format, const void* source, size_t size,
+                          char* destination, size_t capacity, size_t lineLength, bool uppercase)
+        {
+            auto alphabet = (format == ENCODE_BASE64URL) ? BASE64_URL : BASE64_STANDARD;
+            size_t length = 0;
+
+            if (format == ENCODE_HEX)
+                length = size * 2;
+            else
+                length = b64_encoded_size(size, lineLength, alphabet);
+
+            if (length > capacity)
+                throw love::Exception(E_ENCODE_DESTINATION_TOO_SMALL);
+
+            // Encoded output is larger than its input, so writing over the input would replace
+            // bytes before they are read.
+            auto sourceStart = (uintptr_t)source;
+            auto targetStart = (uintptr_t)destination;
+
+            if (sourceStart < targetStart + length && targetStart < sourceStart + size)
+                throw love::Exception(E_ENCODE_SOURCE_OVERLAPS);
+
+            if (format == ENCODE_HEX)
+                hex_encode_into((const char*)source, size, destination, uppercase);
+            else
+                b64_encode_into((const char*)source, size, lineLength, destination, alphabet);
+
+            return length;
+        }
+
         char* decode(EncodeFormat format, const char* source, size_t size,
-                     size_t& destinationLength)
+                     size_t& destinationLength, bool strict)
         {
             switch (format)
             {
                 default:
                 case ENCODE_BASE64:
-                    return b64_decode(source, size, destinationLength);
+                    return b64_decode(source, size, destinationLength, BASE64_STANDARD, strict);
+                case ENCODE_BASE64URL:
+                    return b64_decode(source, size, destinationLength, BASE64_URL, strict);
                 case ENCODE_HEX:
-                    return (char*)hexToBytes(source, size, destinationLength);
+                    return hex_decode(source, size, destinationLength, strict);
             }
         }
 
@@ -179,6 +233,28 @@ namespace love
             hashFunction->hash(function, input, size, output);
         }
 
+        void hash(HashFunction::Function function, ChainedData* input, HashFunction::Value& output)
+        {
+            HashFunction* hashFunction = HashFunction::getHashFunction(function);
+
+            if (hashFunction == nullptr)
+                throw love::Exception("Invalid hash function.");
+
+            const auto& segments = input->getSegments();
+
+            if (segments.size() == 1)
+            {
+                const auto& segment = segments[0];
+                return hashFunction->hash(function, segment.getBytes(), segment.size, output);
+            }
+
+            std::unique_ptr<HashFunction::Context> context(hashFunction->newContext(function));
+
+            input->forEachSegment(
+                [&](const char* bytes, size_t size) { context->update(bytes, size); });
+            context->finalize(output);
+        }
+
         void hash(HashFunction::Function function, Data* input, HashFunction::Value& output)
         {
             hash(function, (const char*)input->getData(), input->getSize(), output);
@@ -196,6 +272,170 @@ namespace love
         {
             return hash(function, (const char*)input->getData(), input->getSize());
         }
+
+        void hashBatch(HashFunction::Function function, const char* const* inputs,
+                       const uint64_t* sizes, HashFunction::Value* outputs, size_t count)
+        {
+            // Inputs up to this size are hashed in groups rather than one task each.
+            static constexpr uint64_t SMALL_INPUT_SIZE = 4096;
+            static constexpr size_t SMALL_GROUP_SIZE   = 16;
+
+            HashFunction* hashFunction = HashFunction::getHashFunction(function);
+
+            if (hashFunction == nullptr)
+                throw love::Exception("Invalid hash function.");
+
+            // Largest first, so the long tasks start early and similar sizes share lanes.
+            std::vector<size_t> order(count);
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(),
+                             [&](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+
+            std::vector<std::pair<size_t, size_t>> tasks;
+            for (size_t start = 0; start < count;)
+            {
+                size_t end = start + 1;
+
+                if (sizes[order[start]] <= SMALL_INPUT_SIZE)
+                    end = std::min(count, start + SMALL_GROUP_SIZE);
+
+                tasks.emplace_back(start, end);
+                start = end;
+            }
+
+            ThreadPool::getInstance().parallelFor(tasks.size(), [&](size_t task) {
+                auto [start, end] = tasks[task];
+
+                if (end - start == 1)
+                {
+                    size_t index = order[start];
+                    hashFunction->hash(function, inputs[index], sizes[index], outputs[index]);
+
+                    return;
+                }
+
+                const char* groupInputs[SMALL_GROUP_SIZE];
+                uint64_t groupSizes[SMALL_GROUP_SIZE];
+                HashFunction::Value groupOutputs[SMALL_GROUP_SIZE];
+
+                for (size_t index = start; index < end; index++)
+                {
+                    groupInputs[index - start] = inputs[order[index]];
+                    groupSizes[index - start]  = sizes[order[index]];
+                }
+
+                size_t groupCount = end - start;
+                hashFunction->hashMany(function, groupInputs, groupSizes, groupOutputs, groupCount);
+
+                for (size_t index = start; index < end; index++)
+                    outputs[order[index]] = groupOutputs[index - start];
+            });
+        }
+
+        // Serialized values start with the encoding version and a compression code, or 0.
+        // Compressed values follow that with the size of the encoding as a varint.
+        static constexpr size_t SERIALIZED_HEADER_SIZE = 2;
+
+        // The format each compression code stands for. Codes are stored in serialized data, so
+        // they stay fixed whatever order Compressor::Format is in.
+        // clang-format off
+        static constexpr Compressor::Format SERIALIZED_COMPRESSION_FORMATS[] =
+        {
+            Compressor::FORMAT_MAX_ENUM, // Not compressed.
+            Compressor::FORMAT_LZ4,
+            Compressor::FORMAT_LZ4FRAME,
+            Compressor::FORMAT_GZIP,
+            Compressor::FORMAT_ZLIB,
+            Compressor::FORMAT_DEFLATE,
+            Compressor::FORMAT_ZSTD
+        };
+        // clang-format on
+
+        static uint8_t getCompressionCode(Compressor::Format format)
+        {
+            for (size_t code = 1; code < std::size(SERIALIZED_COMPRESSION_FORMATS); code++)
+            {
+                if (SERIALIZED_COMPRESSION_FORMATS[code] == format)
+                    return (uint8_t)code;
+            }
+
+            throw love::Exception("Invalid compression format.");
+        }
+
+        // The most each format can expand its input, so that sizes claimed by untrusted data can
+        // be rejected before anything is allocated for them.
+        static uint64_t getMaxExpansion(Compressor::Format format)
+        {
+            switch (format)
+            {
+                case Compressor::FORMAT_LZ4:
+                case Compressor::FORMAT_LZ4FRAME:
+                    return 256; // Each extra byte of match length adds up to 255 bytes.
+                case Compressor::FORMAT_ZSTD:
+                    return 32768; // A 4-byte RLE block holds at most 128 KB.
+                default:
+                    return 1032; // Deflate's limit.
+            }
+        }
+
+        void serialize(const Variant& value, std::vector<char>& output, Compressor::Format format,
+                       int level)
+        {
+            bool compressed = format != Compressor::FORMAT_MAX_ENUM;
+
+            output.push_back((char)Serializer::VERSION);
+            output.push_back(compressed ? (char)getCompressionCode(format) : 0);
+
+            if (!compressed)
+            {
+                Serializer::encode(value, output);
+                return;
+            }
+
+            std::vector<char> encoded;
+            Serializer::encode(value, encoded);
+
+            StrongRef<CompressedData> data(compress(format, encoded.data(), encoded.size(), level),
+                                           Acquire::NO_RETAIN);
+
+            const char* bytes = (const char*)data->getData();
+
+            Serializer::writeVarint(output, encoded.size());
+            output.insert(output.end(), bytes, bytes + data->getSize());
+        }
+
+        Variant deserialize(const char* bytes, size_t size)
+        {
+            if (size < SERIALIZED_HEADER_SIZE || (uint8_t)bytes[0] != Serializer::VERSION)
+                throw love::Exception(E_SERIALIZED_DATA_INVALID);
+
+            uint8_t compression = (uint8_t)bytes[1];
+
+            if (compression == 0)
+                return Serializer::decode(bytes + SERIALIZED_HEADER_SIZE,
+                                         size - SERIALIZED_HEADER_SIZE);
+            else if (compression >= std::size(SERIALIZED_COMPRESSION_FORMATS))
+                throw love::Exception(E_SERIALIZED_DATA_INVALID);
+
+            const char* cursor = bytes + SERIALIZED_HEADER_SIZE;
+            const char* end    = bytes + size;
+            uint64_t rawSize   = 0;
+
+            Compressor::Format format = SERIALIZED_COMPRESSION_FORMATS[compression];
+
+            if (!Serializer::readVarint(cursor, end, rawSize) || rawSize == 0 || rawSize > SIZE_MAX)
+                throw love::Exception(E_SERIALIZED_DATA_INVALID);
+
+            if (rawSize / getMaxExpansion(format) > (uint64_t)(end - cursor))
+                throw love::Exception(E_SERIALIZED_DATA_INVALID);
+
+            auto raw = std::make_unique_for_overwrite<char[]>((size_t)rawSize);
+
+            if (decompressInto(format, cursor, end - cursor, raw.get(), rawSize) != rawSize)
+                throw love::Exception(E_SERIALIZED_DATA_INVALID);
+
+            return Serializer::decode(raw.get(), rawSize);
+        }
     } // namespace data
 
     DataModule::DataModule() : Module(M_DATA, "love.data")
@@ -206,9 +446,14 @@ namespace love
         return new DataView(data, offset, size);
     }
 
-    ByteData* DataModule::newByteData(size_t size) const
+    ChainedData* DataModule::newChainedData() const
+    {
+        return new ChainedData();
+    }
+
+    ByteData* DataModule::newByteData(size_t size, bool clear) const
     {
-        return new ByteData(size);
+        return new ByteData(size, clear);
     }
 
     ByteData* DataModule::newByteData(const void* data, size_t size) const
@@ -220,4 +465,37 @@ namespace love
     {
         return new ByteData(data, size, own);
     }
+
+    Hasher* DataModule::newHasher(HashFunction::Function function) const
+    {
+        return new Hasher(function);
+    }
+
+    PackFormat* DataModule::newPackFormat(const char* format) const
+    {
+        return new PackFormat(format);
+    }
+
+    CompressionStream* DataModule::newCompressionStream(Compressor::Format format, int level) const
+    {
+        return new CompressionStream(CompressionStream::MODE_COMPRESS, format, level);
+    }
+
+    CompressionStream* DataModule::newDecompressionStream(Compressor::Format format) const
+    {
+        return new CompressionStream(CompressionStream::MODE_DECOMPRESS, format);
+    }
+
+    CompressionDictionary* DataModule::newCompressionDictionary(Compressor::Format format,
+                                                                const void* data,
+                                                                size_t size) const
+    {
+        return new CompressionDictionary(format, data, size);
+    }
+
+    CompressionDictionary* DataModule::newCompressionDictionary(
+        Compressor::Format format, const std::vector<std::string_view>& samples) const
+    {
+        return new CompressionDictionary(format, samples);
+    }
 } // namespace love
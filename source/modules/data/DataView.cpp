@@ -5,7 +5,7 @@
 
 namespace love
 {
-    Type DataView::type("DataView", &Data::type);
+    Type DataView::type("DataView", Type::ID_DATA_VIEW);
 
     DataView::DataView(Data* data, size_t offset, size_t size) :
         data(data),
@@ -0,0 +1,43 @@
+#include "common/Exception.hpp"
+
+#include "modules/data/Hasher.hpp"
+
+namespace love
+{
+    Type Hasher::type("Hasher", Type::ID_HASHER);
+
+    Hasher::Hasher(HashFunction::Function function) : function(function), context(nullptr)
+    {
+        HashFunction* hashFunction = HashFunction::getHashFunction(function);
+
+        if (hashFunction == nullptr)
+            throw love::Exception("Invalid hash function.");
+
+        this->context.reset(hashFunction->newContext(function));
+    }
+
+    Hasher::~Hasher()
+    {}
+
+    HashFunction::Function Hasher::getFunction() const
+    {
+        return this->function;
+    }
+
+    void Hasher::update(const char* input, uint64_t length)
+    {
+        if (!this->context)
+            throw love::Exception(E_HASHER_ALREADY_FINISHED);
+
+        this->context->update(input, length);
+    }
+
+    void Hasher::finish(HashFunction::Value& output)
+    {
+        if (!this->context)
+            throw love::Exception(E_HASHER_ALREADY_FINISHED);
+
+        this->context->finalize(output);
+        this->context.reset();
+    }
+} // namespace love
@@ -0,0 +1,341 @@
+#include "common/Exception.hpp"
+
+#include "modules/data/PackFormat.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstring>
+
+namespace love
+{
+    Type PackFormat::type("PackFormat", Type::ID_PACK_FORMAT);
+
+    static constexpr bool NATIVE_LITTLE = std::endian::native == std::endian::little;
+
+    // Alignment '!' asks for without a size, and the largest size string.pack accepts.
+    static constexpr size_t MAX_ALIGN =
+        std::max({ alignof(double), alignof(void*), alignof(int64_t) });
+    static constexpr size_t MAX_SIZE  = std::min<size_t>(SIZE_MAX, INT_MAX);
+
+    struct Settings
+    {
+        bool little;
+        size_t maxAlign;
+    };
+
+    static bool isDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    static size_t readNumber(const char*& format, size_t fallback)
+    {
+        if (!isDigit(*format))
+            return fallback;
+
+        size_t number = 0;
+
+        do
+        {
+            number = number * 10 + (*format++ - '0');
+        } while (isDigit(*format) && number <= (MAX_SIZE - 9) / 10);
+
+        return number;
+    }
+
+    static size_t readIntegerSize(const char*& format, size_t fallback)
+    {
+        size_t size = readNumber(format, fallback);
+
+        if (size == 0 || size > PackFormat::MAX_INTEGER_SIZE)
+            throw love::Exception(E_PACK_INTEGER_SIZE, size, PackFormat::MAX_INTEGER_SIZE);
+
+        return size;
+    }
+
+    // Reads one option into `field`. Returns false for options that only change the settings.
+    static bool readOption(const char*& format, Settings& settings, PackFormat::Field& field)
+    {
+        char option = *format++;
+
+        auto set = [&](PackFormat::FieldType type, size_t size) {
+            field = { type, settings.little, 1, size };
+            return true;
+        };
+
+        switch (option)
+        {
+            case 'b':
+                return set(PackFormat::FIELD_INT, sizeof(char));
+            case 'B':
+                return set(PackFormat::FIELD_UINT, sizeof(char));
+            case 'h':
+                return set(PackFormat::FIELD_INT, sizeof(short));
+            case 'H':
+                return set(PackFormat::FIELD_UINT, sizeof(short));
+            case 'l':
+                return set(PackFormat::FIELD_INT, sizeof(long));
+            case 'L':
+                return set(PackFormat::FIELD_UINT, sizeof(long));
+            case 'j': // lua_Integer
+                return set(PackFormat::FIELD_INT, sizeof(ptrdiff_t));
+            case 'J':
+                return set(PackFormat::FIELD_UINT, sizeof(ptrdiff_t));
+            case 'T':
+                return set(PackFormat::FIELD_UINT, sizeof(size_t));
+            case 'f':
+                return set(PackFormat::FIELD_FLOAT, sizeof(float));
+            case 'd':
+            case 'n':
+                return set(PackFormat::FIELD_FLOAT, sizeof(double));
+            case 'i':
+                return set(PackFormat::FIELD_INT, readIntegerSize(format, sizeof(int)));
+            case 'I':
+                return set(PackFormat::FIELD_UINT, readIntegerSize(format, sizeof(int)));
+            case 's':
+                return set(PackFormat::FIELD_STRING, readIntegerSize(format, sizeof(size_t)));
+            case 'c':
+            {
+                if (!isDigit(*format))
+                    throw love::Exception(E_PACK_MISSING_CHAR_SIZE);
+
+                return set(PackFormat::FIELD_CHARS, readNumber(format, 0));
+            }
+            case 'z':
+                return set(PackFormat::FIELD_ZSTRING, 0);
+            case 'x':
+                return set(PackFormat::FIELD_PADDING, 1);
+            case 'X':
+                return set(PackFormat::FIELD_PADDING, 0);
+            case ' ':
+                break;
+            case '<':
+                settings.little = true;
+                break;
+            case '>':
+                settings.little = false;
+                break;
+            case '=':
+                settings.little = NATIVE_LITTLE;
+                break;
+            case '!':
+                settings.maxAlign = readIntegerSize(format, MAX_ALIGN);
+                break;
+            default:
+                throw love::Exception(E_INVALID_PACK_OPTION, option);
+        }
+
+        return false;
+    }
+
+    PackFormat::PackFormat(const char* format) :
+        format(format),
+        valueCount(0),
+        size(0),
+        fixedSize(true)
+    {
+        Settings settings { NATIVE_LITTLE, 1 };
+
+        while (*format != '\0')
+        {
+            Field field {};
+
+            if (!readOption(format, settings, field))
+                continue;
+
+            size_t align = field.size;
+
+            // 'X' takes its alignment from the option after it, which is otherwise ignored.
+            if (field.type == FIELD_PADDING && field.size == 0)
+            {
+                Field next {};
+
+                if (*format == '\0' || !readOption(format, settings, next) ||
+                    next.type == FIELD_CHARS || next.size == 0)
+                {
+                    throw love::Exception(E_PACK_INVALID_ALIGN_OPTION);
+                }
+
+                align = next.size;
+            }
+
+            if (align > 1 && field.type != FIELD_CHARS)
+            {
+                align = std::min(align, settings.maxAlign);
+
+                if (!std::has_single_bit(align))
+                    throw love::Exception(E_PACK_ALIGNMENT_NOT_POWER_OF_2);
+
+                field.align = align;
+            }
+
+            size_t used = getPadding(this->size, field.align) + field.size;
+
+            if (this->size > MAX_SIZE - used)
+                throw love::Exception(E_PACK_FORMAT_TOO_LARGE);
+
+            this->size += used;
+
+            if (field.type == FIELD_STRING || field.type == FIELD_ZSTRING)
+                this->fixedSize = false;
+
+            if (field.type != FIELD_PADDING)
+                this->valueCount++;
+
+            this->fields.push_back(field);
+        }
+    }
+
+    PackFormat::~PackFormat()
+    {}
+
+    const std::string& PackFormat::getFormat() const
+    {
+        return this->format;
+    }
+
+    const std::vector<PackFormat::Field>& PackFormat::getFields() const
+    {
+        return this->fields;
+    }
+
+    size_t PackFormat::getValueCount() const
+    {
+        return this->valueCount;
+    }
+
+    bool PackFormat::isFixedSize() const
+    {
+        return this->fixedSize;
+    }
+
+    size_t PackFormat::getSize() const
+    {
+        return this->size;
+    }
+
+    template<typename T>
+    static void store(char* destination, T value)
+    {
+        std::memcpy(destination, &value, sizeof(T));
+    }
+
+    template<typename T>
+    static T load(const char* source)
+    {
+        T value;
+        std::memcpy(&value, source, sizeof(T));
+
+        return value;
+    }
+
+    static void copyWithEndian(char* destination, const char* source, size_t size, bool little)
+    {
+        if (little == NATIVE_LITTLE)
+            std::memcpy(destination, source, size);
+        else
+            std::reverse_copy(source, source + size, destination);
+    }
+
+    void PackFormat::packInteger(char* destination, uint64_t value, bool negative, size_t size,
+                                 bool little)
+    {
+        if (little == NATIVE_LITTLE)
+        {
+            switch (size)
+            {
+                case 1:
+                    return store<uint8_t>(destination, value);
+                case 2:
+                    return store<uint16_t>(destination, value);
+                case 4:
+                    return store<uint32_t>(destination, value);
+                case 8:
+                    return store<uint64_t>(destination, value);
+                default:
+                    break;
+            }
+        }
+
+        for (size_t index = 0; index < size; index++)
+        {
+            uint8_t byte = index < 8 ? (uint8_t)(value >> (index * 8)) : (negative ? 0xFF : 0);
+            destination[little ? index : size - 1 - index] = (char)byte;
+        }
+    }
+
+    bool PackFormat::unpackInteger(const char* source, size_t size, bool little, bool isSigned,
+                                   uint64_t& value)
+    {
+        if (little == NATIVE_LITTLE)
+        {
+            switch (size)
+            {
+                case 1:
+                    value = isSigned ? load<int8_t>(source) : load<uint8_t>(source);
+                    return true;
+                case 2:
+                    value = isSigned ? load<int16_t>(source) : load<uint16_t>(source);
+                    return true;
+                case 4:
+                    value = isSigned ? load<int32_t>(source) : load<uint32_t>(source);
+                    return true;
+                case 8:
+                    value = load<uint64_t>(source);
+                    return true;
+                default:
+                    break;
+            }
+        }
+
+        auto byteAt = [&](size_t index) {
+            return (uint8_t)source[little ? index : size - 1 - index];
+        };
+
+        value = 0;
+
+        for (size_t index = std::min<size_t>(size, 8); index-- > 0;)
+            value = (value << 8) | byteAt(index);
+
+        if (size < 8 && isSigned)
+        {
+            uint64_t sign = (uint64_t)1 << (size * 8 - 1);
+            value         = (value ^ sign) - sign;
+        }
+
+        // Bytes past the eighth must only extend the sign.
+        uint8_t extension = (isSigned && (int64_t)value < 0) ? 0xFF : 0;
+
+        for (size_t index = 8; index < size; index++)
+        {
+            if (byteAt(index) != extension)
+                return false;
+        }
+
+        return true;
+    }
+
+    void PackFormat::packFloat(char* destination, double value, size_t size, bool little)
+    {
+        char bytes[sizeof(double)];
+
+        if (size == sizeof(float))
+            store<float>(bytes, (float)value);
+        else
+            store<double>(bytes, value);
+
+        copyWithEndian(destination, bytes, size, little);
+    }
+
+    double PackFormat::unpackFloat(const char* source, size_t size, bool little)
+    {
+        char bytes[sizeof(double)];
+        copyWithEndian(bytes, source, size, little);
+
+        if (size == sizeof(float))
+            return load<float>(bytes);
+
+        return load<double>(bytes);
+    }
+} // namespace love
@@ -0,0 +1,747 @@
+#include "modules/data/misc/ArrayKernels.hpp"
+
+#include "common/Allocator.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+namespace love
+{
+    /*
+    ** The kernels are written once with GCC vector extensions, which become NEON or SSE
+    ** registers where the target has them and plain scalar code where it does not. No vector
+    ** is wider than 16 bytes, since wider ones are split into scalar code rather than into
+    ** registers. The last partial step of an array goes through a zeroed vector so that no
+    ** code path reads or writes past its end.
+    */
+
+    template<typename T, size_t N>
+    struct VectorOf
+    {
+        typedef T type __attribute__((vector_size(sizeof(T) * N)));
+    };
+
+    // Wide:  element-wise arithmetic, wide enough to saturate integer results afterwards. One
+    //        16-byte vector of it is one step.
+    // Total: sums and dot products.
+    template<typename T>
+    struct Element;
+
+    template<>
+    struct Element<float>
+    {
+        using Wide  = float;
+        using Total = double;
+    };
+
+    template<>
+    struct Element<int16_t>
+    {
+        using Wide  = int32_t;
+        using Total = int64_t;
+    };
+
+    template<>
+    struct Element<int32_t>
+    {
+        using Wide  = int64_t;
+        using Total = int64_t;
+    };
+
+    // Products of two uint32 values can outgrow int64, so they are computed as doubles. Those
+    // are exact up to 2^53, and anything larger saturates anyway.
+    template<>
+    struct Element<uint32_t>
+    {
+        using Wide  = double;
+        using Total = int64_t;
+    };
+
+    template<>
+    struct Element<uint8_t>
+    {
+        using Wide  = int32_t;
+        using Total = int64_t;
+    };
+
+    // Wide can also be double, for operations whose scalars integer arithmetic cannot hold.
+    template<typename T, typename Wide = typename Element<T>::Wide>
+    static constexpr size_t LANES = 16 / sizeof(Wide);
+
+    template<typename T, typename Wide = typename Element<T>::Wide>
+    using Vector = typename VectorOf<T, LANES<T, Wide>>::type;
+
+    template<typename T, typename Wide = typename Element<T>::Wide>
+    using WideVector = typename VectorOf<Wide, LANES<T, Wide>>::type;
+
+    template<typename T>
+    using TotalVector = typename VectorOf<typename Element<T>::Total, 2>::type;
+
+    template<typename V, typename T>
+    static V broadcast(T value)
+    {
+        return V {} + value;
+    }
+
+    template<typename V, typename T>
+    static V load(const T* source, size_t count)
+    {
+        V vector {};
+        std::memcpy(&vector, source, count * sizeof(T));
+
+        return vector;
+    }
+
+    template<typename V, typename T>
+    static void store(T* target, const V& vector, size_t count)
+    {
+        std::memcpy(target, &vector, count * sizeof(T));
+    }
+
+    template<typename T>
+    static T toElement(double value)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+            return (T)value;
+        else
+        {
+            if (std::isnan(value))
+                return 0;
+
+            double low  = (double)std::numeric_limits<T>::min();
+            double high = (double)std::numeric_limits<T>::max();
+
+            return (T)std::round(std::clamp(value, low, high));
+        }
+    }
+
+    // Rounds halves away from zero, like std::round, for values that fit in an integer as wide as
+    // one of them.
+    template<typename Values>
+    static Values roundHalfAway(Values values)
+    {
+        using Value    = std::remove_cvref_t<decltype(values[0])>;
+        using Integer  = std::conditional_t<sizeof(Value) == 8, int64_t, int32_t>;
+        using Integers = typename VectorOf<Integer, sizeof(Values) / sizeof(Value)>::type;
+
+        const auto half = broadcast<Values>((Value)0.5);
+
+        auto integers   = __builtin_convertvector(values, Integers);
+        Values whole    = __builtin_convertvector(integers, Values);
+        Values fraction = values - whole;
+
+        whole = fraction >= half ? whole + 1 : whole;
+        return fraction <= -half ? whole - 1 : whole;
+    }
+
+    template<typename T, typename Wide>
+    static Vector<T, Wide> narrow(WideVector<T, Wide> values)
+    {
+        if constexpr (std::is_integral_v<T>)
+        {
+            const auto low  = broadcast<WideVector<T, Wide>>((Wide)std::numeric_limits<T>::min());
+            const auto high = broadcast<WideVector<T, Wide>>((Wide)std::numeric_limits<T>::max());
+
+            if constexpr (std::is_floating_point_v<Wide>)
+                values = values == values ? values : broadcast<WideVector<T, Wide>>((Wide)0);
+
+            values = values < low ? low : values;
+            values = values > high ? high : values;
+
+            if constexpr (std::is_floating_point_v<Wide>)
+                values = roundHalfAway(values);
+        }
+
+        return __builtin_convertvector(values, Vector<T, Wide>);
+    }
+
+    template<typename T, typename Wide = typename Element<T>::Wide>
+    class Source
+    {
+      public:
+        Source(const ArrayKernels::Operand& operand) :
+            array((const T*)operand.array),
+            scalar(broadcast<WideVector<T, Wide>>((Wide)operand.scalar))
+        {}
+
+        WideVector<T, Wide> get(size_t index, size_t count) const
+        {
+            if (this->array == nullptr)
+                return this->scalar;
+
+            return __builtin_convertvector(load<Vector<T, Wide>>(this->array + index, count),
+                                           WideVector<T, Wide>);
+        }
+
+      private:
+        const T* array;
+        WideVector<T, Wide> scalar;
+    };
+
+    // Whether Element<T>::Wide holds the operand exactly. Integer operations with any other
+    // operand are computed in double precision, so that scalars such as 0.5 are not rounded
+    // before they are used and only the result is rounded and saturated.
+    template<typename T>
+    static bool isExact(const ArrayKernels::Operand& operand)
+    {
+        if constexpr (std::is_integral_v<T>)
+        {
+            double scalar = operand.scalar;
+            return operand.array != nullptr || (double)toElement<T>(scalar) == scalar;
+        }
+        else
+            return true;
+    }
+
+    // Stores function(index, count) for every step of the target, saturated to T.
+    template<typename T, typename Wide = typename Element<T>::Wide, typename Function>
+    static void map(void* target, size_t count, Function function)
+    {
+        constexpr size_t STEP = LANES<T, Wide>;
+
+        T* output    = (T*)target;
+        size_t index = 0;
+
+        for (; count - index >= STEP; index += STEP)
+            store(output + index, narrow<T, Wide>(function(index, STEP)), STEP);
+
+        if (index < count)
+            store(output + index, narrow<T, Wide>(function(index, count - index)), count - index);
+    }
+
+    // Calls function(std::type_identity<T>) with the C++ type of the element type.
+    template<typename Function>
+    static auto dispatch(ArrayKernels::ElementType type, Function function)
+    {
+        switch (type)
+        {
+            case ArrayKernels::ELEMENT_FLOAT32:
+            default:
+                return function(std::type_identity<float> {});
+            case ArrayKernels::ELEMENT_INT16:
+                return function(std::type_identity<int16_t> {});
+            case ArrayKernels::ELEMENT_INT32:
+                return function(std::type_identity<int32_t> {});
+            case ArrayKernels::ELEMENT_UINT32:
+                return function(std::type_identity<uint32_t> {});
+            case ArrayKernels::ELEMENT_UINT8:
+                return function(std::type_identity<uint8_t> {});
+        }
+    }
+
+    size_t ArrayKernels::getElementSize(ElementType type)
+    {
+        return dispatch(type, []<typename T>(std::type_identity<T>) { return sizeof(T); });
+    }
+
+    void ArrayKernels::fill(ElementType type, void* target, size_t count, double value)
+    {
+        dispatch(type, [&]<typename T>(std::type_identity<T>) {
+            Source<T> source({ nullptr, (double)toElement<T>(value) });
+            map<T>(target, count, [&](size_t index, size_t n) { return source.get(index, n); });
+        });
+    }
+
+    template<typename T, typename Wide>
+    static void applyArrays(ArrayKernels::Operation operation, void* target,
+                            const ArrayKernels::Operand& a, const ArrayKernels::Operand& b,
+                            size_t count)
+    {
+        Source<T, Wide> first(a);
+        Source<T, Wide> second(b);
+
+        switch (operation)
+        {
+            case ArrayKernels::OPERATION_ADD:
+            default:
+                map<T, Wide>(target, count, [&](size_t index, size_t n) {
+                    return first.get(index, n) + second.get(index, n);
+                });
+                break;
+            case ArrayKernels::OPERATION_SUBTRACT:
+                map<T, Wide>(target, count, [&](size_t index, size_t n) {
+                    return first.get(index, n) - second.get(index, n);
+                });
+                break;
+            case ArrayKernels::OPERATION_MULTIPLY:
+                map<T, Wide>(target, count, [&](size_t index, size_t n) {
+                    return first.get(index, n) * second.get(index, n);
+                });
+                break;
+        }
+    }
+
+    void ArrayKernels::apply(Operation operation, ElementType type, void* target,
+                             const Operand& a, const Operand& b, size_t count)
+    {
+        dispatch(type, [&]<typename T>(std::type_identity<T>) {
+            if (isExact<T>(a) && isExact<T>(b))
+                applyArrays<T, typename Element<T>::Wide>(operation, target, a, b, count);
+            else
+                applyArrays<T, double>(operation, target, a, b, count);
+        });
+    }
+
+    template<typename T, typename Wide>
+    static void fmaArrays(void* target, const ArrayKernels::Operand& a,
+                          const ArrayKernels::Operand& b, const ArrayKernels::Operand& c,
+                          size_t count)
+    {
+        Source<T, Wide> first(a);
+        Source<T, Wide> second(b);
+        Source<T, Wide> third(c);
+
+        map<T, Wide>(target, count, [&](size_t index, size_t n) {
+            return first.get(index, n) * second.get(index, n) + third.get(index, n);
+        });
+    }
+
+    void ArrayKernels::fma(ElementType type, void* target, const Operand& a, const Operand& b,
+                           const Operand& c, size_t count)
+    {
+        dispatch(type, [&]<typename T>(std::type_identity<T>) {
+            if (isExact<T>(a) && isExact<T>(b) && isExact<T>(c))
+                fmaArrays<T, typename Element<T>::Wide>(target, a, b, c, count);
+            else
+                fmaArrays<T, double>(target, a, b, c, count);
+        });
+    }
+
+    void ArrayKernels::clamp(ElementType type, void* target, size_t count, double low,
+                             double high)
+    {
+        dispatch(type, [&]<typename T>(std::type_identity<T>) {
+            Source<T> values({ target, 0.0 });
+
+            double lowest  = low;
+            double highest = high;
+
+            // Integers only keep the whole numbers inside the range, rather than rounding it.
+            if constexpr (std::is_integral_v<T>)
+            {
+                lowest  = std::ceil(low);
+                highest = std::floor(high);
+            }
+
+            const auto lows  = Source<T>({ nullptr, (double)toElement<T>(lowest) }).get(0, 0);
+            const auto highs = Source<T>({ nullptr, (double)toElement<T>(highest) }).get(0, 0);
+
+            map<T>(target, count, [&](size_t index, size_t n) {
+                auto value = values.get(index, n);
+
+                value = value < lows ? lows : value;
+                return value > highs ? highs : value;
+            });
+        });
+    }
+
+    template<typename To, typename From>
+    static void convertArray(To* target, const From* source, size_t count, double scale,
+                             double bias)
+    {
+        constexpr bool precise = (std::is_integral_v<To> && sizeof(To) == 4) ||
+                                 (std::is_integral_v<From> && sizeof(From) == 4);
+
+        using Compute = std::conditional_t<precise, double, float>;
+
+        constexpr size_t STEP = 16 / sizeof(Compute);
+
+        using Input    = typename VectorOf<From, STEP>::type;
+        using Output   = typename VectorOf<To, STEP>::type;
+        using Values   = typename VectorOf<Compute, STEP>::type;
+        using Integers = typename VectorOf<int32_t, STEP>::type;
+
+        const auto scales = broadcast<Values>((Compute)scale);
+        const auto biases = broadcast<Values>((Compute)bias);
+
+        auto step = [&](size_t index, size_t n) {
+            Values values = __builtin_convertvector(load<Input>(source + index, n), Values);
+            values        = values * scales + biases;
+
+            if constexpr (std::is_integral_v<To>)
+            {
+                const auto zero = broadcast<Values>((Compute)0);
+                const auto low  = broadcast<Values>((Compute)std::numeric_limits<To>::min());
+                const auto high = broadcast<Values>((Compute)std::numeric_limits<To>::max());
+
+                values = values == values ? values : zero;
+                values = values < low ? low : values;
+                values = values > high ? high : values;
+                values = roundHalfAway(values);
+            }
+
+            // Through int32 first, since most targets only convert floats to 32-bit integers
+            // directly; the range is already clamped.
+            if constexpr (std::is_integral_v<To> && sizeof(To) < 4)
+            {
+                auto integers = __builtin_convertvector(values, Integers);
+                store(target + index, __builtin_convertvector(integers, Output), n);
+            }
+            else
+                store(target + index, __builtin_convertvector(values, Output), n);
+        };
+
+        size_t index = 0;
+
+        for (; count - index >= STEP; index += STEP)
+            step(index, STEP);
+
+        if (index < count)
+            step(index, count - index);
+    }
+
+    void ArrayKernels::convert(ElementType targetType, void* target, ElementType sourceType,
+                               const void* source, size_t count, double scale, double bias)
+    {
+        dispatch(targetType, [&]<typename To>(std::type_identity<To>) {
+            dispatch(sourceType, [&]<typename From>(std::type_identity<From>) {
+                convertArray((To*)target, (const From*)source, count, scale, bias);
+            });
+        });
+    }
+
+    void ArrayKernels::fromNumbers(ElementType type, void* target, const double* source,
+                                   size_t count)
+    {
+        dispatch(type, [&]<typename T>(std::type_identity<T>) {
+            for (size_t index = 0; index < count; index++)
+            {
+                T value = toElement<T>(source[index]);
+                std::memcpy((char*)target + index * sizeof(T), &value, sizeof(T));
+            }
+        });
+    }
+
+    void ArrayKernels::toNumbers(ElementType type, double* target, const void* source,
+                                 size_t count)
+    {
+        dispatch(type, [&]<typename T>(std::type_identity<T>) {
+            for (size_t index = 0; index < count; index++)
+            {
+                T value;
+                std::memcpy(&value, (const char*)source + index * sizeof(T), sizeof(T));
+                target[index] = (double)value;
+            }
+        });
+    }
+
+    // Adds the lanes of `values` to the two lanes of `totals`.
+    template<typename Totals, typename Values>
+    static void accumulate(Totals& totals, const Values& values)
+    {
+        using Value = std::remove_cvref_t<decltype(values[0])>;
+
+        if constexpr (sizeof(Values) / sizeof(Value) == 2)
+            totals += __builtin_convertvector(values, Totals);
+        else
+        {
+            using Half = typename VectorOf<Value, sizeof(Values) / sizeof(Value) / 2>::type;
+
+            Half halves[2];
+            std::memcpy(halves, &values, sizeof(Values));
+
+            for (const auto& half : halves)
+                accumulate(totals, half);
+        }
+    }
+
+    template<typename T>
+    static double sumArray(const T* source, size_t count)
+    {
+        Source<T> values({ source, 0.0 });
+        TotalVector<T> totals {};
+
+        size_t index = 0;
+
+        for (; count - index >= LANES<T>; index += LANES<T>)
+            accumulate(totals, values.get(index, LANES<T>));
+
+        if (index < count)
+            accumulate(totals, values.get(index, count - index));
+
+        return (double)(totals[0] + totals[1]);
+    }
+
+    // Compares the elements themselves, so steps hold 16 bytes of T rather than of Wide.
+    template<typename T, bool Minimum>
+    static double extremeOfArray(const T* source, size_t count)
+    {
+        constexpr size_t STEP = 16 / sizeof(T);
+        using Values          = typename VectorOf<T, STEP>::type;
+
+        auto best    = broadcast<Values>(source[0]);
+        size_t steps = count / STEP;
+
+        for (size_t step = 0; step < steps; step++)
+        {
+            auto values = load<Values>(source + step * STEP, STEP);
+
+            if constexpr (Minimum)
+                best = values < best ? values : best;
+            else
+                best = values > best ? values : best;
+        }
+
+        T result = source[0];
+
+        for (size_t lane = 0; lane < STEP; lane++)
+            result = Minimum ? std::min<T>(result, best[lane]) : std::max<T>(result, best[lane]);
+
+        for (size_t index = steps * STEP; index < count; index++)
+            result = Minimum ? std::min(result, source[index]) : std::max(result, source[index]);
+
+        return (double)result;
+    }
+
+    double ArrayKernels::reduce(Reduction reduction, ElementType type, const void* source,
+                                size_t count)
+    {
+        return dispatch(type, [&]<typename T>(std::type_identity<T>) {
+            switch (reduction)
+            {
+                case REDUCTION_SUM:
+                default:
+                    return sumArray((const T*)source, count);
+                case REDUCTION_MIN:
+                    return extremeOfArray<T, true>((const T*)source, count);
+                case REDUCTION_MAX:
+                    return extremeOfArray<T, false>((const T*)source, count);
+            }
+        });
+    }
+
+    template<typename T>
+    static double dotArrays(const T* a, const T* b, size_t count)
+    {
+        // Sums of 32-bit products can outgrow 64 bits, so those are added up as doubles.
+        using Totals = std::conditional_t<sizeof(T) == 4, typename VectorOf<double, 2>::type,
+                                          TotalVector<T>>;
+
+        Source<T> first({ a, 0.0 });
+        Source<T> second({ b, 0.0 });
+        Totals totals {};
+
+        // Integer products fit in Wide, which is double for uint32. Float products do not, so
+        // those lanes are widened to double before they are multiplied.
+        auto step = [&](size_t index, size_t n) {
+            auto x = first.get(index, n);
+            auto y = second.get(index, n);
+
+            if constexpr (std::is_integral_v<T>)
+                accumulate(totals, x * y);
+            else
+            {
+                using Half = typename VectorOf<float, 2>::type;
+
+                Half halves[2][2];
+                std::memcpy(halves[0], &x, sizeof(x));
+                std::memcpy(halves[1], &y, sizeof(y));
+
+                for (size_t half = 0; half < 2; half++)
+                {
+                    auto left  = __builtin_convertvector(halves[0][half], Totals);
+                    auto right = __builtin_convertvector(halves[1][half], Totals);
+
+                    totals += left * right;
+                }
+            }
+        };
+
+        size_t index = 0;
+
+        for (; count - index >= LANES<T>; index += LANES<T>)
+            step(index, LANES<T>);
+
+        if (index < count)
+            step(index, count - index);
+
+        return (double)(totals[0] + totals[1]);
+    }
+
+    double ArrayKernels::dot(ElementType type, const void* a, const void* b, size_t count)
+    {
+        return dispatch(type, [&]<typename T>(std::type_identity<T>) {
+            return dotArrays((const T*)a, (const T*)b, count);
+        });
+    }
+
+    // Maps keys to unsigned integers that sort in the same order.
+    template<typename T>
+    static auto toRadixKey(T value)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            uint32_t bits = std::bit_cast<uint32_t>(value);
+            return (bits & 0x80000000u) != 0 ? ~bits : (bits | 0x80000000u);
+        }
+        else
+        {
+            using Key = std::make_unsigned_t<T>;
+
+            if constexpr (std::is_signed_v<T>)
+                return (Key)((Key)value ^ ((Key)1 << (sizeof(T) * 8 - 1)));
+            else
+                return (Key)value;
+        }
+    }
+
+    // Sorts items by key(item), one counting pass per key byte, moving them back and forth
+    // between `items` and `scratch`. Passes where every key has the same byte are skipped.
+    // Returns whichever of the two holds the result.
+    template<typename Item, typename Key>
+    static Item* radixSort(Item* items, Item* scratch, size_t count, Key key)
+    {
+        constexpr size_t BYTES = sizeof(key(items[0]));
+
+        uint32_t histograms[BYTES][256] {};
+
+        for (size_t index = 0; index < count; index++)
+        {
+            auto value = key(items[index]);
+
+            for (size_t byte = 0; byte < BYTES; byte++)
+                histograms[byte][(value >> (byte * 8)) & 0xFF]++;
+        }
+
+        Item* from = items;
+        Item* to   = scratch;
+
+        for (size_t byte = 0; byte < BYTES; byte++)
+        {
+            auto& histogram = histograms[byte];
+            size_t shift    = byte * 8;
+
+            if (histogram[(key(from[0]) >> shift) & 0xFF] == count)
+                continue;
+
+            uint32_t offset = 0;
+
+            for (auto& bucket : histogram)
+                offset += std::exchange(bucket, offset);
+
+            for (size_t index = 0; index < count; index++)
+                to[histogram[(key(from[index]) >> shift) & 0xFF]++] = from[index];
+
+            std::swap(from, to);
+        }
+
+        return from;
+    }
+
+    class ScratchBuffer
+    {
+      public:
+        ScratchBuffer(size_t size) : data(Allocator::allocate(size)), size(size)
+        {}
+
+        ~ScratchBuffer()
+        {
+            Allocator::deallocate(this->data, this->size);
+        }
+
+        template<typename T>
+        T* get() const
+        {
+            return (T*)this->data;
+        }
+
+      private:
+        void* data;
+        size_t size;
+    };
+
+    template<typename T>
+    static void sortRecords(char* records, size_t count, size_t stride, size_t keyOffset)
+    {
+        if (stride == sizeof(T))
+        {
+            ScratchBuffer scratch(count * sizeof(T));
+
+            T* result = radixSort((T*)records, scratch.get<T>(), count, toRadixKey<T>);
+
+            if (result != (T*)records)
+                std::memcpy(records, result, count * sizeof(T));
+
+            return;
+        }
+
+        // Records are sorted as (key, index) pairs and moved once at the end, rather than
+        // copied whole on every pass.
+        using Key = decltype(toRadixKey(T {}));
+
+        struct Item
+        {
+            Key key;
+            uint32_t index;
+        };
+
+        ScratchBuffer items(count * sizeof(Item) * 2);
+        ScratchBuffer moved(count * stride);
+
+        Item* first = items.get<Item>();
+
+        for (size_t index = 0; index < count; index++)
+        {
+            T value;
+            std::memcpy(&value, records + index * stride + keyOffset, sizeof(T));
+
+            first[index] = { toRadixKey(value), (uint32_t)index };
+        }
+
+        auto key     = [](const Item& item) { return item.key; };
+        Item* result = radixSort(first, first + count, count, key);
+
+        for (size_t index = 0; index < count; index++)
+            std::memcpy(moved.get<char>() + index * stride, records + result[index].index * stride,
+                        stride);
+
+        std::memcpy(records, moved.get<char>(), count * stride);
+    }
+
+    void ArrayKernels::sort(ElementType type, void* records, size_t count, size_t stride,
+                            size_t keyOffset)
+    {
+        if (count < 2)
+            return;
+
+        dispatch(type, [&]<typename T>(std::type_identity<T>) {
+            sortRecords<T>((char*)records, count, stride, keyOffset);
+        });
+    }
+
+    size_t ArrayKernels::search(ElementType type, const void* records, size_t count,
+                                size_t stride, size_t keyOffset, double value, bool& found)
+    {
+        return dispatch(type, [&]<typename T>(std::type_identity<T>) {
+            const char* keys = (const char*)records + keyOffset;
+
+            auto keyAt = [&](size_t index) {
+                T key;
+                std::memcpy(&key, keys + index * stride, sizeof(T));
+
+                return (double)key;
+            };
+
+            size_t low  = 0;
+            size_t high = count;
+
+            while (low < high)
+            {
+                size_t middle = low + (high - low) / 2;
+
+                if (keyAt(middle) < value)
+                    low = middle + 1;
+                else
+                    high = middle;
+            }
+
+            found = low < count && keyAt(low) == value;
+            return low;
+        });
+    }
+} // namespace love
@@ -1,5 +1,15 @@
 #include "modules/data/misc/LZ4Compressor.hpp"
 #include "modules/data/misc/ZlibCompressor.hpp"
+#include "modules/data/misc/ZstdCompressor.hpp"
+
+#include <atomic>
+
+namespace
+{
+    std::atomic<uint64_t> contextsCreated = 0;
+    std::atomic<uint64_t> contextsReused  = 0;
+    std::atomic<uint64_t> bytesSaved      = 0;
+} // namespace
 
 namespace love
 {
@@ -7,8 +17,9 @@ namespace love
     {
         static LZ4Compressor lz4;
         static ZlibCompressor zlib;
+        static ZstdCompressor zstd;
 
-        Compressor* compressors[] = { &lz4, &zlib };
+        Compressor* compressors[] = { &lz4, &zlib, &zstd };
         for (auto* compressor : compressors)
         {
             if (compressor->isSupported(format))
@@ -17,4 +28,20 @@ namespace love
 
         return nullptr;
     }
+
+    Compressor::Stats Compressor::getStats()
+    {
+        return Stats { contextsCreated.load(), contextsReused.load(), bytesSaved.load() };
+    }
+
+    void Compressor::countCreated()
+    {
+        contextsCreated.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Compressor::countReused(size_t size)
+    {
+        contextsReused.fetch_add(1, std::memory_order_relaxed);
+        bytesSaved.fetch_add(size, std::memory_order_relaxed);
+    }
 } // namespace love
@@ -1,9 +1,16 @@
 #include "modules/data/misc/HashFunction.hpp"
+#include "modules/data/misc/HashKernels.hpp"
 
+#include "modules/data/misc/BLAKE3.hpp"
+#include "modules/data/misc/CRC32C.hpp"
+#include "modules/data/misc/FNV1a.hpp"
 #include "modules/data/misc/MD5.hpp"
 #include "modules/data/misc/SHA1.hpp"
 #include "modules/data/misc/SHA256.hpp"
 #include "modules/data/misc/SHA512.hpp"
+#include "modules/data/misc/XXHash.hpp"
+
+#include <memory>
 
 namespace love
 {
@@ -21,6 +28,16 @@ namespace love
             case FUNCTION_SHA384:
             case FUNCTION_SHA512:
                 return &sha512;
+            case FUNCTION_XXH3_64:
+            case FUNCTION_XXH3_128:
+            case FUNCTION_XXH64:
+                return &xxhash;
+            case FUNCTION_CRC32C:
+                return &crc32c;
+            case FUNCTION_FNV1A32:
+                return &fnv1a;
+            case FUNCTION_BLAKE3:
+                return &blake3;
             case FUNCTION_MAX_ENUM:
                 return nullptr;
                 // No default for compiler warnings
@@ -28,4 +45,26 @@ namespace love
 
         return nullptr;
     }
+
+    HashFunction::Backend HashFunction::getBackend()
+    {
+        static const Backend backend = kernels::detectBackend();
+        return backend;
+    }
+
+    void HashFunction::hash(Function function, const char* input, uint64_t length,
+                            Value& output) const
+    {
+        std::unique_ptr<Context> context(this->newContext(function));
+
+        context->update(input, length);
+        context->finalize(output);
+    }
+
+    void HashFunction::hashMany(Function function, const char* const* inputs,
+                                const uint64_t* lengths, Value* outputs, size_t count) const
+    {
+        for (size_t index = 0; index < count; index++)
+            this->hash(function, inputs[index], lengths[index], outputs[index]);
+    }
 } // namespace love
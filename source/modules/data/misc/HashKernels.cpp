@@ -0,0 +1,410 @@
+#include "modules/data/misc/HashKernels.hpp"
+
+#if defined(LOVE_HASH_ARMV8)
+    #include <arm_neon.h>
+#endif
+
+#if defined(LOVE_HASH_SHANI)
+    #include <cpuid.h>
+    #include <immintrin.h>
+
+    #define LOVE_TARGET_SHANI __attribute__((target("sha,sse4.1,ssse3")))
+    #define LOVE_TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+
+#if defined(LOVE_HASH_ARMV8_CRC)
+    #include <arm_acle.h>
+#endif
+
+#include <cstring>
+
+namespace love
+{
+    namespace kernels
+    {
+        // clang-format off
+        alignas(16) static constexpr uint32_t SHA256_K[64] = {
+            0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+            0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+            0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+            0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+            0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+            0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+            0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+            0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+        };
+        // clang-format on
+
+        static constexpr uint32_t SHA1_K[4] = { 0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xCA62C1D6 };
+
+#if defined(LOVE_HASH_ARMV8)
+        static void sha1CompressARMv8(uint32_t* state, const uint8_t* blocks, uint64_t count)
+        {
+            uint32x4_t abcd = vld1q_u32(state);
+            uint32_t e      = state[4];
+
+            for (uint64_t block = 0; block < count; block++, blocks += 64)
+            {
+                uint32x4_t abcdSaved = abcd;
+                uint32_t eSaved      = e;
+
+                uint32x4_t message[4];
+                for (int index = 0; index < 4; index++)
+                {
+                    uint8x16_t bytes = vrev32q_u8(vld1q_u8(blocks + index * 16));
+                    message[index]   = vreinterpretq_u32_u8(bytes);
+                }
+
+                for (int group = 0; group < 20; group++)
+                {
+                    uint32x4_t& words = message[group % 4];
+                    uint32x4_t temp   = vaddq_u32(words, vdupq_n_u32(SHA1_K[group / 5]));
+
+                    uint32_t eNext = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+
+                    if (group < 5)
+                        abcd = vsha1cq_u32(abcd, e, temp);
+                    else if (group < 10 || group >= 15)
+                        abcd = vsha1pq_u32(abcd, e, temp);
+                    else
+                        abcd = vsha1mq_u32(abcd, e, temp);
+
+                    e = eNext;
+
+                    if (group < 16)
+                    {
+                        const auto& second = message[(group + 1) % 4];
+                        const auto& third  = message[(group + 2) % 4];
+
+                        words = vsha1su0q_u32(words, second, third);
+                        words = vsha1su1q_u32(words, message[(group + 3) % 4]);
+                    }
+                }
+
+                abcd = vaddq_u32(abcd, abcdSaved);
+                e += eSaved;
+            }
+
+            vst1q_u32(state, abcd);
+            state[4] = e;
+        }
+
+        static void sha256CompressARMv8(uint32_t* state, const uint8_t* blocks, uint64_t count)
+        {
+            uint32x4_t state0 = vld1q_u32(&state[0]);
+            uint32x4_t state1 = vld1q_u32(&state[4]);
+
+            for (uint64_t block = 0; block < count; block++, blocks += 64)
+            {
+                uint32x4_t state0Saved = state0;
+                uint32x4_t state1Saved = state1;
+
+                uint32x4_t message[4];
+                for (int index = 0; index < 4; index++)
+                {
+                    uint8x16_t bytes = vrev32q_u8(vld1q_u8(blocks + index * 16));
+                    message[index]   = vreinterpretq_u32_u8(bytes);
+                }
+
+                for (int group = 0; group < 16; group++)
+                {
+                    uint32x4_t& words = message[group % 4];
+                    uint32x4_t temp   = vaddq_u32(words, vld1q_u32(&SHA256_K[group * 4]));
+
+                    if (group < 12)
+                        words = vsha256su0q_u32(words, message[(group + 1) % 4]);
+
+                    uint32x4_t previous = state0;
+                    state0              = vsha256hq_u32(state0, state1, temp);
+                    state1              = vsha256h2q_u32(state1, previous, temp);
+
+                    if (group < 12)
+                    {
+                        const auto& third  = message[(group + 2) % 4];
+                        const auto& fourth = message[(group + 3) % 4];
+
+                        words = vsha256su1q_u32(words, third, fourth);
+                    }
+                }
+
+                state0 = vaddq_u32(state0, state0Saved);
+                state1 = vaddq_u32(state1, state1Saved);
+            }
+
+            vst1q_u32(&state[0], state0);
+            vst1q_u32(&state[4], state1);
+        }
+#endif
+
+#if defined(LOVE_HASH_SHANI)
+        LOVE_TARGET_SHANI
+        static void sha1CompressSHANI(uint32_t* state, const uint8_t* blocks, uint64_t count)
+        {
+            const __m128i mask = _mm_set_epi64x(0x0001020304050607ULL, 0x08090A0B0C0D0E0FULL);
+
+            __m128i abcd = _mm_loadu_si128((const __m128i*)state);
+            __m128i e0   = _mm_set_epi32((int)state[4], 0, 0, 0);
+            abcd         = _mm_shuffle_epi32(abcd, 0x1B);
+
+            for (uint64_t block = 0; block < count; block++, blocks += 64)
+            {
+                __m128i abcdSaved = abcd;
+                __m128i e0Saved   = e0;
+                __m128i e1        = _mm_setzero_si128();
+
+                __m128i message[4];
+                for (int index = 0; index < 4; index++)
+                {
+                    __m128i words  = _mm_loadu_si128((const __m128i*)(blocks + index * 16));
+                    message[index] = _mm_shuffle_epi8(words, mask);
+                }
+
+#pragma GCC unroll 20
+                for (int group = 0; group < 20; group++)
+                {
+                    __m128i& words = message[group % 4];
+
+                    // The E register alternates between e0 and e1 every four rounds.
+                    __m128i& current = (group % 2 == 0) ? e0 : e1;
+                    __m128i& next    = (group % 2 == 0) ? e1 : e0;
+
+                    if (group == 0)
+                        current = _mm_add_epi32(current, words);
+                    else
+                        current = _mm_sha1nexte_epu32(current, words);
+
+                    next = abcd;
+
+                    if (group >= 3 && group <= 18)
+                    {
+                        __m128i& following = message[(group + 1) % 4];
+                        following          = _mm_sha1msg2_epu32(following, words);
+                    }
+
+                    switch (group / 5)
+                    {
+                        case 0:
+                            abcd = _mm_sha1rnds4_epu32(abcd, current, 0);
+                            break;
+                        case 1:
+                            abcd = _mm_sha1rnds4_epu32(abcd, current, 1);
+                            break;
+                        case 2:
+                            abcd = _mm_sha1rnds4_epu32(abcd, current, 2);
+                            break;
+                        default:
+                            abcd = _mm_sha1rnds4_epu32(abcd, current, 3);
+                            break;
+                    }
+
+                    if (group >= 1 && group <= 16)
+                    {
+                        __m128i& previous = message[(group + 3) % 4];
+                        previous          = _mm_sha1msg1_epu32(previous, words);
+                    }
+
+                    if (group >= 2 && group <= 17)
+                    {
+                        __m128i& other = message[(group + 2) % 4];
+                        other          = _mm_xor_si128(other, words);
+                    }
+                }
+
+                e0   = _mm_sha1nexte_epu32(e0, e0Saved);
+                abcd = _mm_add_epi32(abcd, abcdSaved);
+            }
+
+            abcd = _mm_shuffle_epi32(abcd, 0x1B);
+            _mm_storeu_si128((__m128i*)state, abcd);
+            state[4] = (uint32_t)_mm_extract_epi32(e0, 3);
+        }
+
+        LOVE_TARGET_SHANI
+        static void sha256CompressSHANI(uint32_t* state, const uint8_t* blocks, uint64_t count)
+        {
+            const __m128i mask = _mm_set_epi64x(0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL);
+
+            __m128i temp   = _mm_loadu_si128((const __m128i*)&state[0]);
+            __m128i state1 = _mm_loadu_si128((const __m128i*)&state[4]);
+
+            temp           = _mm_shuffle_epi32(temp, 0xB1);          // CDAB
+            state1         = _mm_shuffle_epi32(state1, 0x1B);        // EFGH
+            __m128i state0 = _mm_alignr_epi8(temp, state1, 8);       // ABEF
+            state1         = _mm_blend_epi16(state1, temp, 0xF0);    // CDGH
+
+            for (uint64_t block = 0; block < count; block++, blocks += 64)
+            {
+                __m128i state0Saved = state0;
+                __m128i state1Saved = state1;
+
+                __m128i message[4];
+                for (int index = 0; index < 4; index++)
+                {
+                    __m128i words  = _mm_loadu_si128((const __m128i*)(blocks + index * 16));
+                    message[index] = _mm_shuffle_epi8(words, mask);
+                }
+
+#pragma GCC unroll 16
+                for (int group = 0; group < 16; group++)
+                {
+                    __m128i& words    = message[group % 4];
+                    __m128i constants = _mm_load_si128((const __m128i*)&SHA256_K[group * 4]);
+                    __m128i schedule  = _mm_add_epi32(words, constants);
+
+                    state1 = _mm_sha256rnds2_epu32(state1, state0, schedule);
+
+                    if (group >= 3 && group <= 14)
+                    {
+                        __m128i& following = message[(group + 1) % 4];
+                        __m128i shifted    = _mm_alignr_epi8(words, message[(group + 3) % 4], 4);
+
+                        following = _mm_add_epi32(following, shifted);
+                        following = _mm_sha256msg2_epu32(following, words);
+                    }
+
+                    schedule = _mm_shuffle_epi32(schedule, 0x0E);
+                    state0   = _mm_sha256rnds2_epu32(state0, state1, schedule);
+
+                    if (group >= 1 && group <= 12)
+                    {
+                        __m128i& previous = message[(group + 3) % 4];
+                        previous          = _mm_sha256msg1_epu32(previous, words);
+                    }
+                }
+
+                state0 = _mm_add_epi32(state0, state0Saved);
+                state1 = _mm_add_epi32(state1, state1Saved);
+            }
+
+            temp   = _mm_shuffle_epi32(state0, 0x1B);       // FEBA
+            state1 = _mm_shuffle_epi32(state1, 0xB1);       // DCHG
+            state0 = _mm_blend_epi16(temp, state1, 0xF0);   // DCBA
+            state1 = _mm_alignr_epi8(state1, temp, 8);      // HGFE
+
+            _mm_storeu_si128((__m128i*)&state[0], state0);
+            _mm_storeu_si128((__m128i*)&state[4], state1);
+        }
+#endif
+
+#if defined(LOVE_HASH_ARMV8_CRC)
+        static uint32_t crc32cARMv8(uint32_t crc, const uint8_t* bytes, uint64_t length)
+        {
+            for (; length >= 8; length -= 8, bytes += 8)
+            {
+                uint64_t word;
+                std::memcpy(&word, bytes, sizeof(word));
+                crc = __crc32cd(crc, word);
+            }
+
+            for (; length > 0; length--, bytes++)
+                crc = __crc32cb(crc, *bytes);
+
+            return crc;
+        }
+#endif
+
+#if defined(LOVE_HASH_SSE42)
+        LOVE_TARGET_SSE42
+        static uint32_t crc32cSSE42(uint32_t crc, const uint8_t* bytes, uint64_t length)
+        {
+    #if defined(__x86_64__)
+            uint64_t wide = crc;
+            for (; length >= 8; length -= 8, bytes += 8)
+            {
+                uint64_t word;
+                std::memcpy(&word, bytes, sizeof(word));
+                wide = _mm_crc32_u64(wide, word);
+            }
+            crc = (uint32_t)wide;
+    #endif
+
+            for (; length >= 4; length -= 4, bytes += 4)
+            {
+                uint32_t word;
+                std::memcpy(&word, bytes, sizeof(word));
+                crc = _mm_crc32_u32(crc, word);
+            }
+
+            for (; length > 0; length--, bytes++)
+                crc = _mm_crc32_u8(crc, *bytes);
+
+            return crc;
+        }
+#endif
+
+        HashFunction::Backend detectBackend()
+        {
+#if defined(LOVE_HASH_ARMV8)
+            return HashFunction::BACKEND_ARMV8;
+#elif defined(LOVE_HASH_SHANI)
+            unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+                return HashFunction::BACKEND_SCALAR;
+
+            const bool hasSSSE3 = (ecx & bit_SSSE3) != 0;
+            const bool hasSSE41 = (ecx & bit_SSE4_1) != 0;
+
+            if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+                return HashFunction::BACKEND_SCALAR;
+
+            if (hasSSSE3 && hasSSE41 && (ebx & bit_SHA) != 0)
+                return HashFunction::BACKEND_SHANI;
+
+            return HashFunction::BACKEND_SCALAR;
+#else
+            return HashFunction::BACKEND_SCALAR;
+#endif
+        }
+
+        CompressFunction getSHA1Kernel(HashFunction::Backend backend)
+        {
+            switch (backend)
+            {
+#if defined(LOVE_HASH_ARMV8)
+                case HashFunction::BACKEND_ARMV8:
+                    return sha1CompressARMv8;
+#endif
+#if defined(LOVE_HASH_SHANI)
+                case HashFunction::BACKEND_SHANI:
+                    return sha1CompressSHANI;
+#endif
+                default:
+                    return nullptr;
+            }
+        }
+
+        CompressFunction getSHA256Kernel(HashFunction::Backend backend)
+        {
+            switch (backend)
+            {
+#if defined(LOVE_HASH_ARMV8)
+                case HashFunction::BACKEND_ARMV8:
+                    return sha256CompressARMv8;
+#endif
+#if defined(LOVE_HASH_SHANI)
+                case HashFunction::BACKEND_SHANI:
+                    return sha256CompressSHANI;
+#endif
+                default:
+                    return nullptr;
+            }
+        }
+
+        CRC32CFunction getCRC32CKernel()
+        {
+#if defined(LOVE_HASH_ARMV8_CRC)
+            return crc32cARMv8;
+#elif defined(LOVE_HASH_SSE42)
+            unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+
+            if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_SSE4_2) != 0)
+                return crc32cSSE42;
+
+            return nullptr;
+#else
+            return nullptr;
+#endif
+        }
+    } // namespace kernels
+} // namespace love
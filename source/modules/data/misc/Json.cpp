@@ -0,0 +1,688 @@
+#include "modules/data/misc/Json.hpp"
+
+#include "common/Exception.hpp"
+#include "common/error.hpp"
+
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace love
+{
+    /*
+    ** The first stage compares 16 bytes at a time using GCC vector extensions, which become NEON
+    ** or SSE compares where the target has them, and turns each comparison into a mask with one
+    ** bit per byte of a 64-byte block. Strings are then found with bit arithmetic on the masks
+    ** alone: a quote after an odd run of backslashes is escaped, and a prefix XOR of the other
+    ** quotes sets the bits of every byte from an opening quote up to its closing one. The last
+    ** partial block is copied into a block padded with spaces.
+    */
+    namespace
+    {
+        typedef uint8_t Bytes __attribute__((vector_size(16)));
+
+        constexpr size_t BLOCK_SIZE = 64;
+
+        // Exact powers of ten, which is as far as a double holds them.
+        constexpr double POWERS_OF_TEN[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                             1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                             1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+        constexpr uint64_t MAX_EXACT_MANTISSA = (uint64_t)1 << 53;
+
+        struct ScanState
+        {
+            // All ones while the previous block ended inside a string.
+            uint64_t inString;
+            // Whether the previous block ended with an odd run of backslashes.
+            uint64_t oddBackslash;
+            // Whether the previous block ended with a byte a token cannot continue past.
+            uint64_t previousBreak;
+        };
+
+        struct Frame
+        {
+            uint32_t token;
+            bool object;
+        };
+
+        enum State
+        {
+            STATE_VALUE,
+            STATE_VALUE_OR_CLOSE,
+            STATE_KEY,
+            STATE_KEY_OR_CLOSE,
+            STATE_COLON,
+            STATE_COMMA_OR_CLOSE,
+            STATE_DONE
+        };
+
+        // The comparison's bytes are all ones or all zeros. Each keeps a different bit, and the
+        // multiplication adds all eight of a half into its top byte without any carries.
+        uint64_t toMask(Bytes matches)
+        {
+            constexpr uint64_t BITS = 0x8040201008040201;
+            constexpr uint64_t SUM  = 0x0101010101010101;
+
+            uint64_t halves[2];
+            std::memcpy(halves, &matches, sizeof(halves));
+
+#if defined(__LOVE_BIG_ENDIAN__)
+            halves[0] = __builtin_bswap64(halves[0]);
+            halves[1] = __builtin_bswap64(halves[1]);
+#endif
+
+            uint64_t low  = ((halves[0] & BITS) * SUM) >> 56;
+            uint64_t high = ((halves[1] & BITS) * SUM) >> 56;
+
+            return low | high << 8;
+        }
+
+        Bytes load(const char* source)
+        {
+            Bytes bytes;
+            std::memcpy(&bytes, source, sizeof(bytes));
+
+            return bytes;
+        }
+
+        bool isSpace(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+        }
+
+        // Finds the first backslash or control character, or quote when `quotes` is set.
+        const char* findSpecial(const char* begin, const char* end, bool quotes)
+        {
+            const char* cursor = begin;
+
+            for (; end - cursor >= (ptrdiff_t)sizeof(Bytes); cursor += sizeof(Bytes))
+            {
+                Bytes bytes   = load(cursor);
+                Bytes special = (Bytes)((bytes == '\\') | (bytes < 0x20));
+
+                if (quotes)
+                    special |= (Bytes)(bytes == '"');
+
+                uint64_t mask = toMask(special);
+
+                if (mask != 0)
+                    return cursor + std::countr_zero(mask);
+            }
+
+            for (; cursor < end; cursor++)
+            {
+                uint8_t c = (uint8_t)*cursor;
+
+                if (c == '\\' || c < 0x20 || (quotes && c == '"'))
+                    return cursor;
+            }
+
+            return end;
+        }
+
+        // Bits of bytes right after an odd run of backslashes, which are escaped.
+        uint64_t findEscaped(uint64_t backslashes, uint64_t& oddBackslash)
+        {
+            constexpr uint64_t EVEN_BITS = 0x5555555555555555;
+            constexpr uint64_t ODD_BITS  = ~EVEN_BITS;
+
+            uint64_t starts     = backslashes & ~(backslashes << 1);
+            uint64_t evenStart  = EVEN_BITS ^ oddBackslash;
+            uint64_t evenStarts = starts & evenStart;
+            uint64_t oddStarts  = starts & ~evenStart;
+
+            // Adding a run's start to it carries to the byte after the run.
+            uint64_t evenCarries = backslashes + evenStarts;
+            uint64_t oddCarries  = backslashes + oddStarts;
+            bool overflow        = oddCarries < backslashes;
+
+            oddCarries |= oddBackslash;
+            oddBackslash = overflow ? 1 : 0;
+
+            uint64_t evenStartOddEnd = evenCarries & ~backslashes & ODD_BITS;
+            uint64_t oddStartEvenEnd = oddCarries & ~backslashes & EVEN_BITS;
+
+            return evenStartOddEnd | oddStartEvenEnd;
+        }
+
+        uint64_t prefixXor(uint64_t bits)
+        {
+            for (int shift = 1; shift < 64; shift *= 2)
+                bits ^= bits << shift;
+
+            return bits;
+        }
+
+        // Positions of the structural characters outside strings, both quotes of every string
+        // and the first byte of every number and literal.
+        uint64_t scanBlock(const char* block, ScanState& state)
+        {
+            uint64_t quotes = 0, backslashes = 0, operators = 0, spaces = 0;
+
+            for (size_t offset = 0; offset < BLOCK_SIZE; offset += sizeof(Bytes))
+            {
+                Bytes bytes = load(block + offset);
+
+                // '[' and ']' differ from '{' and '}' by the bit 0x20 alone.
+                Bytes folded = bytes | 0x20;
+
+                Bytes isOperator =
+                    (Bytes)((folded == '{') | (folded == '}') | (bytes == ':') | (bytes == ','));
+
+                Bytes isSpace = (Bytes)((bytes == ' ') | (bytes == '\t') | (bytes == '\n') |
+                                        (bytes == '\r'));
+
+                quotes |= toMask((Bytes)(bytes == '"')) << offset;
+                backslashes |= toMask((Bytes)(bytes == '\\')) << offset;
+                operators |= toMask(isOperator) << offset;
+                spaces |= toMask(isSpace) << offset;
+            }
+
+            quotes &= ~findEscaped(backslashes, state.oddBackslash);
+
+            uint64_t inString = prefixXor(quotes) ^ state.inString;
+            state.inString    = (uint64_t)((int64_t)inString >> 63);
+
+            operators &= ~inString;
+
+            // Anything else outside a string begins a token when the byte before it ends one.
+            uint64_t breaks = operators | spaces | quotes;
+            uint64_t starts = ~breaks & ~inString & (breaks << 1 | state.previousBreak);
+
+            state.previousBreak = breaks >> 63;
+
+            return operators | quotes | starts;
+        }
+
+        void appendPositions(std::vector<Json::Token>& tokens, uint64_t bits, uint32_t base)
+        {
+            size_t count = tokens.size();
+            tokens.resize(count + std::popcount(bits));
+
+            for (; bits != 0; bits &= bits - 1)
+                tokens[count++] = { base + (uint32_t)std::countr_zero(bits), 0 };
+        }
+
+        void findTokens(const char* json, size_t size, std::vector<Json::Token>& tokens)
+        {
+            ScanState state { 0, 0, 1 };
+            size_t offset = 0;
+
+            for (; size - offset >= BLOCK_SIZE; offset += BLOCK_SIZE)
+                appendPositions(tokens, scanBlock(json + offset, state), (uint32_t)offset);
+
+            if (offset < size)
+            {
+                char block[BLOCK_SIZE];
+
+                std::memset(block, ' ', BLOCK_SIZE);
+                std::memcpy(block, json + offset, size - offset);
+
+                appendPositions(tokens, scanBlock(block, state), (uint32_t)offset);
+            }
+
+            if (state.inString != 0)
+                throw love::Exception(E_JSON_SYNTAX, size);
+        }
+
+        void appendUtf8(std::string& output, uint32_t code)
+        {
+            if (code < 0x80)
+                output.push_back((char)code);
+            else if (code < 0x800)
+            {
+                output.push_back((char)(0xC0 | code >> 6));
+                output.push_back((char)(0x80 | (code & 0x3F)));
+            }
+            else if (code < 0x10000)
+            {
+                output.push_back((char)(0xE0 | code >> 12));
+                output.push_back((char)(0x80 | (code >> 6 & 0x3F)));
+                output.push_back((char)(0x80 | (code & 0x3F)));
+            }
+            else
+            {
+                output.push_back((char)(0xF0 | code >> 18));
+                output.push_back((char)(0x80 | (code >> 12 & 0x3F)));
+                output.push_back((char)(0x80 | (code >> 6 & 0x3F)));
+                output.push_back((char)(0x80 | (code & 0x3F)));
+            }
+        }
+
+        // Reads the four hex digits of a \u escape at `cursor`. Returns false if there are not.
+        bool readHex(const char* cursor, const char* end, uint32_t& code)
+        {
+            if (end - cursor < 4)
+                return false;
+
+            code = 0;
+
+            for (int index = 0; index < 4; index++)
+            {
+                char c = cursor[index];
+                code <<= 4;
+
+                if (c >= '0' && c <= '9')
+                    code |= c - '0';
+                else if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f')
+                    code |= (c | 0x20) - 'a' + 10;
+                else
+                    return false;
+            }
+
+            return true;
+        }
+
+        const char* matchLiteral(const char* begin, const char* end, std::string_view literal)
+        {
+            if ((size_t)(end - begin) < literal.size() ||
+                std::memcmp(begin, literal.data(), literal.size()) != 0)
+            {
+                return nullptr;
+            }
+
+            return begin + literal.size();
+        }
+    } // namespace
+
+    void Json::tokenize(const char* json, size_t size, std::vector<Token>& tokens)
+    {
+        if (size >= UINT32_MAX)
+            throw love::Exception(E_JSON_TOO_LARGE);
+
+        tokens.clear();
+        findTokens(json, size, tokens);
+
+        // Checks the grammar while compacting the tokens into values and keys. Nothing is
+        // written past the token being read, so this happens in place.
+        std::vector<Frame> stack;
+
+        size_t count = tokens.size();
+        size_t write = 0;
+        State state  = STATE_VALUE;
+
+        for (size_t read = 0; read < count;)
+        {
+            Token token = tokens[read++];
+            char c      = json[token.position];
+
+            bool isString = false;
+
+            switch (state)
+            {
+                case STATE_COLON:
+                    if (c != ':')
+                        throw love::Exception(E_JSON_SYNTAX, token.position);
+
+                    state = STATE_VALUE;
+                    continue;
+                case STATE_COMMA_OR_CLOSE:
+                    if (c == ',')
+                    {
+                        state = stack.back().object ? STATE_KEY : STATE_VALUE;
+                        continue;
+                    }
+
+                    break;
+                case STATE_KEY:
+                case STATE_KEY_OR_CLOSE:
+                    if (c == '"')
+                    {
+                        tokens[stack.back().token].count++;
+                        isString = true;
+                        state    = STATE_COLON;
+                    }
+                    else if (state == STATE_KEY)
+                        throw love::Exception(E_JSON_SYNTAX, token.position);
+
+                    break;
+                case STATE_VALUE:
+                case STATE_VALUE_OR_CLOSE:
+                    if (c == '}' || c == ']')
+                    {
+                        if (state == STATE_VALUE)
+                            throw love::Exception(E_JSON_SYNTAX, token.position);
+
+                        break;
+                    }
+                    else if (c == ',' || c == ':')
+                        throw love::Exception(E_JSON_SYNTAX, token.position);
+
+                    // Object members were counted at their keys.
+                    if (!stack.empty() && !stack.back().object)
+                        tokens[stack.back().token].count++;
+
+                    if (c == '{' || c == '[')
+                    {
+                        if (stack.size() >= MAX_DEPTH)
+                            throw love::Exception(E_JSON_TOO_DEEP, MAX_DEPTH);
+
+                        stack.push_back({ (uint32_t)write, c == '{' });
+                        tokens[write++] = { token.position, 0 };
+
+                        state = c == '{' ? STATE_KEY_OR_CLOSE : STATE_VALUE_OR_CLOSE;
+                        continue;
+                    }
+
+                    state = stack.empty() ? STATE_DONE : STATE_COMMA_OR_CLOSE;
+
+                    if (c == '"')
+                    {
+                        isString = true;
+                        break;
+                    }
+
+                    // Numbers and literals run up to the next token, and are checked when read.
+                    tokens[write++] = { token.position,
+                                        read < count ? tokens[read].position : (uint32_t)size };
+                    continue;
+                case STATE_DONE:
+                default:
+                    throw love::Exception(E_JSON_SYNTAX, token.position);
+            }
+
+            if (isString)
+            {
+                // Nothing inside a string is a token, so the next one is its closing quote.
+                if (read == count || json[tokens[read].position] != '"')
+                    throw love::Exception(E_JSON_SYNTAX, token.position);
+
+                tokens[write++] = { token.position, tokens[read++].position };
+                continue;
+            }
+
+            // What is left closes the innermost object or array.
+            if ((c != '}' && c != ']') || stack.back().object != (c == '}'))
+                throw love::Exception(E_JSON_SYNTAX, token.position);
+
+            stack.pop_back();
+            state = stack.empty() ? STATE_DONE : STATE_COMMA_OR_CLOSE;
+        }
+
+        if (state != STATE_DONE)
+            throw love::Exception(E_JSON_SYNTAX, size);
+
+        tokens.resize(write);
+    }
+
+    Json::ScalarType Json::parseScalar(const char* json, const Token& token, double& number)
+    {
+        const char* begin = json + token.position;
+        const char* end   = json + token.count;
+
+        ScalarType type    = SCALAR_NUMBER;
+        const char* cursor = nullptr;
+
+        switch (*begin)
+        {
+            case 'n':
+                type   = SCALAR_NULL;
+                cursor = matchLiteral(begin, end, "null");
+                break;
+            case 'f':
+                type   = SCALAR_FALSE;
+                cursor = matchLiteral(begin, end, "false");
+                break;
+            case 't':
+                type   = SCALAR_TRUE;
+                cursor = matchLiteral(begin, end, "true");
+                break;
+            default:
+                cursor = parseNumber(begin, end, number);
+                break;
+        }
+
+        if (cursor == nullptr)
+            throw love::Exception(E_JSON_SYNTAX, token.position);
+
+        // Only spaces can come between a token and the next.
+        for (; cursor < end; cursor++)
+        {
+            if (!isSpace(*cursor))
+                throw love::Exception(E_JSON_SYNTAX, cursor - json);
+        }
+
+        return type;
+    }
+
+    std::string_view Json::parseString(const char* json, const Token& token,
+                                       std::string& scratch)
+    {
+        const char* begin  = json + token.position + 1;
+        const char* end    = json + token.count;
+        const char* cursor = findSpecial(begin, end, false);
+
+        if (cursor == end)
+            return std::string_view(begin, end - begin);
+
+        scratch.assign(begin, cursor);
+
+        while (cursor < end)
+        {
+            if (*cursor != '\\')
+            {
+                // Control characters have to be escaped.
+                if ((uint8_t)*cursor < 0x20)
+                    throw love::Exception(E_JSON_SYNTAX, cursor - json);
+
+                const char* next = findSpecial(cursor + 1, end, false);
+                scratch.append(cursor, next);
+
+                cursor = next;
+                continue;
+            }
+
+            // A closing quote is never escaped, so every backslash has a character after it.
+            char escape = cursor[1];
+            cursor += 2;
+
+            switch (escape)
+            {
+                case '"':
+                case '\\':
+                case '/':
+                    scratch.push_back(escape);
+                    break;
+                case 'b':
+                    scratch.push_back('\b');
+                    break;
+                case 'f':
+                    scratch.push_back('\f');
+                    break;
+                case 'n':
+                    scratch.push_back('\n');
+                    break;
+                case 'r':
+                    scratch.push_back('\r');
+                    break;
+                case 't':
+                    scratch.push_back('\t');
+                    break;
+                case 'u':
+                {
+                    uint32_t code = 0, low = 0;
+
+                    if (!readHex(cursor, end, code))
+                        throw love::Exception(E_JSON_SYNTAX, cursor - 2 - json);
+
+                    cursor += 4;
+
+                    // Characters outside the BMP are escaped as a pair of surrogates. Ones
+                    // without a partner are kept as they are.
+                    if (code >= 0xD800 && code < 0xDC00 && end - cursor >= 6 && cursor[0] == '\\' &&
+                        cursor[1] == 'u' && readHex(cursor + 2, end, low) && low >= 0xDC00 &&
+                        low < 0xE000)
+                    {
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        cursor += 6;
+                    }
+
+                    appendUtf8(scratch, code);
+                    break;
+                }
+                default:
+                    throw love::Exception(E_JSON_SYNTAX, cursor - 2 - json);
+            }
+        }
+
+        return scratch;
+    }
+
+    const char* Json::parseNumber(const char* begin, const char* end, double& number)
+    {
+        const char* cursor = begin;
+        bool negative      = cursor < end && *cursor == '-';
+
+        if (negative)
+            cursor++;
+
+        if (cursor == end || *cursor < '0' || *cursor > '9')
+            return nullptr;
+
+        uint64_t mantissa = 0;
+        int digits        = 0;
+        int exponent      = 0;
+
+        // Leading zeros are not allowed.
+        if (*cursor == '0')
+            cursor++;
+        else
+        {
+            for (; cursor < end && *cursor >= '0' && *cursor <= '9'; cursor++, digits++)
+                mantissa = mantissa * 10 + (*cursor - '0');
+        }
+
+        if (cursor < end && *cursor == '.')
+        {
+            const char* fraction = ++cursor;
+
+            for (; cursor < end && *cursor >= '0' && *cursor <= '9'; cursor++)
+            {
+                // Zeros before the first significant digit do not make the mantissa inexact.
+                if (mantissa != 0 || *cursor != '0')
+                    digits++;
+
+                mantissa = mantissa * 10 + (*cursor - '0');
+                exponent--;
+            }
+
+            if (cursor == fraction)
+                return nullptr;
+        }
+
+        if (cursor < end && (*cursor | 0x20) == 'e')
+        {
+            cursor++;
+            bool negativeExponent = cursor < end && *cursor == '-';
+
+            if (cursor < end && (*cursor == '-' || *cursor == '+'))
+                cursor++;
+
+            const char* start = cursor;
+            int value         = 0;
+
+            for (; cursor < end && *cursor >= '0' && *cursor <= '9'; cursor++)
+            {
+                if (value < 100000)
+                    value = value * 10 + (*cursor - '0');
+            }
+
+            if (cursor == start)
+                return nullptr;
+
+            exponent += negativeExponent ? -value : value;
+        }
+
+        // With no more than 19 digits the mantissa did not overflow, and when it and the power
+        // of ten are both exact doubles one multiplication or division rounds correctly.
+        if (digits <= 19 && mantissa <= MAX_EXACT_MANTISSA && exponent >= -22 && exponent <= 22)
+        {
+            double value = (double)mantissa;
+
+            if (exponent >= 0)
+                value *= POWERS_OF_TEN[exponent];
+            else
+                value /= POWERS_OF_TEN[-exponent];
+
+            number = negative ? -value : value;
+            return cursor;
+        }
+
+        // std::from_chars rounds correctly too, and also does not depend on the locale.
+        auto result = std::from_chars(begin, cursor, number);
+
+        if (result.ec == std::errc::result_out_of_range)
+        {
+            double value = exponent + digits > 0 ? HUGE_VAL : 0.0;
+            number       = negative ? -value : value;
+        }
+        else if (result.ec != std::errc() || result.ptr != cursor)
+            return nullptr;
+
+        return cursor;
+    }
+
+    void Json::writeString(std::string& output, const char* string, size_t length)
+    {
+        static constexpr char HEX[] = "0123456789abcdef";
+
+        const char* cursor = string;
+        const char* end    = string + length;
+
+        output.push_back('"');
+
+        while (cursor < end)
+        {
+            const char* special = findSpecial(cursor, end, true);
+            output.append(cursor, special);
+
+            if (special == end)
+                break;
+
+            switch (*special)
+            {
+                case '"':
+                    output.append("\\\"");
+                    break;
+                case '\\':
+                    output.append("\\\\");
+                    break;
+                case '\n':
+                    output.append("\\n");
+                    break;
+                case '\r':
+                    output.append("\\r");
+                    break;
+                case '\t':
+                    output.append("\\t");
+                    break;
+                default:
+                {
+                    char escape[] = { '\\', 'u', '0', '0', HEX[*special >> 4], HEX[*special & 15] };
+                    output.append(escape, sizeof(escape));
+                    break;
+                }
+            }
+
+            cursor = special + 1;
+        }
+
+        output.push_back('"');
+    }
+
+    bool Json::writeNumber(std::string& output, double number)
+    {
+        if (!std::isfinite(number))
+            return false;
+
+        // The shortest text that reads back as the same double, whatever the locale.
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+
+        output.append(buffer, result.ptr);
+
+        return true;
+    }
+} // namespace love
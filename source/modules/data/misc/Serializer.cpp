@@ -0,0 +1,374 @@
+#include "modules/data/misc/Serializer.hpp"
+
+#include "common/Exception.hpp"
+#include "common/error.hpp"
+
+#include <bit>
+#include <cmath>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace love
+{
+    namespace
+    {
+        enum Tag
+        {
+            TAG_NIL,
+            TAG_FALSE,
+            TAG_TRUE,
+            TAG_INTEGER,
+            TAG_NEGATIVE_INTEGER,
+            TAG_DOUBLE,
+            TAG_STRING,
+            TAG_STRING_REFERENCE,
+            TAG_TABLE,
+            TAG_MAX_ENUM
+        };
+
+        // Counts from this up are stored after the tag instead of in it.
+        static constexpr uint64_t INLINE_COUNT_LIMIT = 15;
+
+        // Shorter strings cost no more to repeat than to refer to.
+        static constexpr size_t MIN_NUMBERED_STRING_LENGTH = 2;
+
+        // Integers beyond this are not all representable by a double.
+        static constexpr double MAX_EXACT_INTEGER = 9007199254740992.0;
+
+        static std::string_view getString(const Variant& value)
+        {
+            const auto& data = value.getData();
+
+            if (value.getType() == Variant::SMALLSTRING)
+                return std::string_view(data.smallstring.str, data.smallstring.len);
+
+            return std::string_view(data.string->string, data.string->length);
+        }
+
+        class Encoder
+        {
+          public:
+            Encoder(std::vector<char>& output) : output(output)
+            {}
+
+            void writeValue(const Variant& value, int depth)
+            {
+                const auto& data = value.getData();
+
+                switch (value.getType())
+                {
+                    case Variant::NIL:
+                        this->output.push_back(TAG_NIL);
+                        break;
+                    case Variant::BOOLEAN:
+                        this->output.push_back(data.boolean ? TAG_TRUE : TAG_FALSE);
+                        break;
+                    case Variant::NUMBER:
+                        this->writeNumber(data.number);
+                        break;
+                    case Variant::STRING:
+                    case Variant::SMALLSTRING:
+                        this->writeString(getString(value));
+                        break;
+                    case Variant::TABLE:
+                        this->writeTable(*data.table.table, depth);
+                        break;
+                    default:
+                        throw love::Exception(E_SERIALIZE_UNSUPPORTED_TYPE);
+                }
+            }
+
+          private:
+            void writeTagged(Tag tag, uint64_t count)
+            {
+                if (count < INLINE_COUNT_LIMIT)
+                    this->output.push_back((char)(tag | count << 4));
+                else
+                {
+                    this->output.push_back((char)(tag | INLINE_COUNT_LIMIT << 4));
+                    Serializer::writeVarint(this->output, count - INLINE_COUNT_LIMIT);
+                }
+            }
+
+            void writeNumber(double number)
+            {
+                bool integral =
+                    std::trunc(number) == number && std::fabs(number) <= MAX_EXACT_INTEGER;
+
+                // -0 has to keep its sign, which only the double encoding does.
+                if (integral && !(number == 0 && std::signbit(number)))
+                {
+                    if (number >= 0)
+                        this->writeTagged(TAG_INTEGER, (uint64_t)number);
+                    else
+                        this->writeTagged(TAG_NEGATIVE_INTEGER, (uint64_t)(-number - 1));
+
+                    return;
+                }
+
+                uint64_t bits = std::bit_cast<uint64_t>(number);
+                this->output.push_back(TAG_DOUBLE);
+
+                for (int shift = 0; shift < 64; shift += 8)
+                    this->output.push_back((char)(bits >> shift));
+            }
+
+            void writeString(std::string_view string)
+            {
+                if (string.size() >= MIN_NUMBERED_STRING_LENGTH)
+                {
+                    uint64_t next          = this->strings.size();
+                    auto [entry, inserted] = this->strings.try_emplace(string, next);
+
+                    if (!inserted)
+                    {
+                        this->writeTagged(TAG_STRING_REFERENCE, entry->second);
+                        return;
+                    }
+                }
+
+                this->writeTagged(TAG_STRING, string.size());
+                this->output.insert(this->output.end(), string.begin(), string.end());
+            }
+
+            void writeTable(const Variant::SharedTable::Table& table, int depth)
+            {
+                if (depth >= Serializer::MAX_DEPTH)
+                    throw love::Exception(E_SERIALIZE_TOO_DEEP, Serializer::MAX_DEPTH);
+
+                this->writeTagged(TAG_TABLE, table.arrayLength);
+                Serializer::writeVarint(this->output, table.pairCount);
+
+                for (size_t index = 0; index < table.arrayLength; index++)
+                    this->writeValue(table.array[index], depth + 1);
+
+                for (size_t index = 0; index < table.pairCount; index++)
+                {
+                    this->writeValue(table.pairs[index].first, depth + 1);
+                    this->writeValue(table.pairs[index].second, depth + 1);
+                }
+            }
+
+            std::vector<char>& output;
+
+            // Points into the strings of the value being encoded, which outlive the encoder.
+            std::unordered_map<std::string_view, uint64_t> strings;
+        };
+
+        class Decoder
+        {
+          public:
+            Decoder(const char* bytes, size_t size) :
+                cursor(bytes),
+                end(bytes + size),
+                shared(nullptr)
+            {}
+
+            ~Decoder()
+            {
+                if (this->shared != nullptr)
+                    this->shared->release();
+            }
+
+            Variant readValue(int depth)
+            {
+                uint8_t tag = this->readByte();
+
+                switch (tag & 0x0F)
+                {
+                    case TAG_NIL:
+                        return Variant();
+                    case TAG_FALSE:
+                        return Variant(false);
+                    case TAG_TRUE:
+                        return Variant(true);
+                    case TAG_INTEGER:
+                        return Variant((double)this->readCount(tag));
+                    case TAG_NEGATIVE_INTEGER:
+                        return Variant(-(double)this->readCount(tag) - 1);
+                    case TAG_DOUBLE:
+                    {
+                        uint64_t bits = 0;
+
+                        for (int shift = 0; shift < 64; shift += 8)
+                            bits |= (uint64_t)this->readByte() << shift;
+
+                        return Variant(std::bit_cast<double>(bits));
+                    }
+                    case TAG_STRING:
+                    {
+                        uint64_t length = this->readCount(tag);
+
+                        if (length > this->getRemaining())
+                            throw love::Exception(E_SERIALIZED_DATA_INVALID);
+
+                        Variant string(this->cursor, (size_t)length);
+                        this->cursor += length;
+
+                        // Copies of long strings share one SharedString.
+                        if (length >= MIN_NUMBERED_STRING_LENGTH)
+                            this->strings.push_back(string);
+
+                        return string;
+                    }
+                    case TAG_STRING_REFERENCE:
+                    {
+                        uint64_t index = this->readCount(tag);
+
+                        if (index >= this->strings.size())
+                            throw love::Exception(E_SERIALIZED_DATA_INVALID);
+
+                        return this->strings[index];
+                    }
+                    case TAG_TABLE:
+                        return this->readTable(tag, depth);
+                    default:
+                        throw love::Exception(E_SERIALIZED_DATA_INVALID);
+                }
+            }
+
+            bool isFinished() const
+            {
+                return this->cursor == this->end;
+            }
+
+          private:
+            size_t getRemaining() const
+            {
+                return this->end - this->cursor;
+            }
+
+            uint8_t readByte()
+            {
+                if (this->cursor == this->end)
+                    throw love::Exception(E_SERIALIZED_DATA_INVALID);
+
+                return (uint8_t)*this->cursor++;
+            }
+
+            uint64_t readVarint()
+            {
+                uint64_t value = 0;
+
+                if (!Serializer::readVarint(this->cursor, this->end, value))
+                    throw love::Exception(E_SERIALIZED_DATA_INVALID);
+
+                return value;
+            }
+
+            uint64_t readCount(uint8_t tag)
+            {
+                uint64_t count = tag >> 4;
+
+                if (count < INLINE_COUNT_LIMIT)
+                    return count;
+
+                uint64_t rest = this->readVarint();
+
+                if (rest > UINT64_MAX - INLINE_COUNT_LIMIT)
+                    throw love::Exception(E_SERIALIZED_DATA_INVALID);
+
+                return count + rest;
+            }
+
+            Variant readTable(uint8_t tag, int depth)
+            {
+                if (depth >= Serializer::MAX_DEPTH)
+                    throw love::Exception(E_SERIALIZE_TOO_DEEP, Serializer::MAX_DEPTH);
+
+                uint64_t arrayLength = this->readCount(tag);
+                uint64_t pairCount   = this->readVarint();
+
+                // Every value takes at least a byte, so counts the rest of the input cannot hold
+                // are rejected before anything is allocated for them.
+                if (arrayLength > this->getRemaining() || pairCount > this->getRemaining() / 2)
+                    throw love::Exception(E_SERIALIZED_DATA_INVALID);
+
+                if (this->shared == nullptr)
+                    this->shared = new Variant::SharedTable();
+
+                auto* table = this->shared->newTable((size_t)arrayLength);
+
+                for (size_t index = 0; index < arrayLength; index++)
+                    table->array[index] = this->readValue(depth + 1);
+
+                // Pairs of nested tables are stacked on their parent's until each is done.
+                size_t firstPair = this->pairs.size();
+
+                for (size_t index = 0; index < pairCount; index++)
+                {
+                    Variant key = this->readValue(depth + 1);
+
+                    if (key.getType() == Variant::NIL ||
+                        (key.getType() == Variant::NUMBER && std::isnan(key.getData().number)))
+                    {
+                        throw love::Exception(E_SERIALIZED_DATA_INVALID);
+                    }
+
+                    Variant value = this->readValue(depth + 1);
+                    this->pairs.emplace_back(std::move(key), std::move(value));
+                }
+
+                this->shared->setPairs(table, this->pairs.data() + firstPair, pairCount);
+                this->pairs.resize(firstPair);
+
+                // Only the outermost table holds a reference to the SharedTable. The others are
+                // stored inside it, and copies of them take their own.
+                return Variant(depth == 0 ? this->shared : nullptr, table);
+            }
+
+            const char* cursor;
+            const char* end;
+
+            Variant::SharedTable* shared;
+
+            std::vector<Variant> strings;
+            std::vector<std::pair<Variant, Variant>> pairs;
+        };
+    } // namespace
+
+    void Serializer::encode(const Variant& value, std::vector<char>& output)
+    {
+        Encoder encoder(output);
+        encoder.writeValue(value, 0);
+    }
+
+    Variant Serializer::decode(const char* bytes, size_t size)
+    {
+        Decoder decoder(bytes, size);
+        Variant value = decoder.readValue(0);
+
+        if (!decoder.isFinished())
+            throw love::Exception(E_SERIALIZED_DATA_INVALID);
+
+        return value;
+    }
+
+    void Serializer::writeVarint(std::vector<char>& output, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            output.push_back((char)(value | 0x80));
+            value >>= 7;
+        }
+
+        output.push_back((char)value);
+    }
+
+    bool Serializer::readVarint(const char*& cursor, const char* end, uint64_t& value)
+    {
+        value = 0;
+
+        for (int shift = 0; shift < 64 && cursor != end; shift += 7)
+        {
+            uint8_t byte = (uint8_t)*cursor++;
+            value |= (uint64_t)(byte & 0x7F) << shift;
+
+            if ((byte & 0x80) == 0)
+                return shift < 63 || byte <= 1;
+        }
+
+        return false;
+    }
+} // namespace love
@@ -0,0 +1,182 @@
+#include "common/error.hpp"
+
+#include "modules/data/ByteData.hpp"
+#include "modules/data/DataModule.hpp"
+
+#include "modules/data/wrap_ChainedData.hpp"
+#include "modules/data/wrap_Data.hpp"
+#include "modules/data/wrap_DataModule.hpp"
+
+using namespace love;
+
+int Wrap_ChainedData::clone(lua_State* L)
+{
+    auto* self         = luax_checkchaineddata(L, 1);
+    ChainedData* clone = nullptr;
+
+    luax_catchexcept(L, [&] { clone = new ChainedData(*self); });
+
+    luax_pushtype(L, clone);
+    clone->release();
+
+    return 1;
+}
+
+int Wrap_ChainedData::append(lua_State* L)
+{
+    auto* self = luax_checkchaineddata(L, 1);
+    luax_appendtochain(L, self, 2, true);
+
+    lua_pushvalue(L, 1);
+
+    return 1;
+}
+
+int Wrap_ChainedData::slice(lua_State* L)
+{
+    auto* self = luax_checkchaineddata(L, 1);
+
+    lua_Integer offset = luaL_checkinteger(L, 2);
+    lua_Integer size   = luaL_optinteger(L, 3, (lua_Integer)self->getSize() - offset);
+
+    if (offset < 0 || size < 0)
+        return luaL_error(L, E_INVALID_OFFSET_AND_SIZE);
+
+    ChainedData* result = nullptr;
+    luax_catchexcept(L, [&] { result = self->slice((size_t)offset, (size_t)size); });
+
+    luax_pushtype(L, result);
+    result->release();
+
+    return 1;
+}
+
+int Wrap_ChainedData::flatten(lua_State* L)
+{
+    auto* self         = luax_checkchaineddata(L, 1);
+    auto containerType = data::CONTAINER_DATA;
+
+    if (!lua_isnoneornil(L, 2))
+        containerType = luax_checkcontainertype(L, 2);
+
+    if (containerType == data::CONTAINER_STRING)
+    {
+        luaL_Buffer buffer;
+        luaL_buffinit(L, &buffer);
+
+        self->forEachSegment([&](const char* bytes, size_t size) {
+            luaL_addlstring(&buffer, bytes, size);
+        });
+
+        luaL_pushresult(&buffer);
+
+        return 1;
+    }
+
+    if (self->getSize() == 0)
+        return luaL_error(L, "Cannot flatten an empty ChainedData into a ByteData.");
+
+    ByteData* result = nullptr;
+    luax_catchexcept(L, [&] {
+        result = new ByteData(self->getSize(), false);
+        self->copyTo((char*)result->getData());
+    });
+
+    luax_pushtype(L, Data::type, result);
+    result->release();
+
+    return 1;
+}
+
+int Wrap_ChainedData::getSegmentCount(lua_State* L)
+{
+    auto* self = luax_checkchaineddata(L, 1);
+
+    lua_pushinteger(L, (lua_Integer)self->getSegments().size());
+
+    return 1;
+}
+
+// clang-format off
+static constexpr luaL_Reg functions[] =
+{
+    { "clone",           Wrap_ChainedData::clone           },
+    { "append",          Wrap_ChainedData::append          },
+    { "slice",           Wrap_ChainedData::slice           },
+    { "flatten",         Wrap_ChainedData::flatten         },
+    { "getSegmentCount", Wrap_ChainedData::getSegmentCount }
+};
+// clang-format on
+
+namespace love
+{
+    ChainedData* luax_checkchaineddata(lua_State* L, int index)
+    {
+        return luax_checktype<ChainedData>(L, index);
+    }
+
+    void luax_appendtochain(lua_State* L, ChainedData* chain, int index, bool ranged)
+    {
+        bool isString     = lua_type(L, index) == LUA_TSTRING;
+        const char* bytes = nullptr;
+        Data* data        = nullptr;
+        size_t length     = 0;
+
+        if (isString)
+            bytes = lua_tolstring(L, index, &length);
+        else
+        {
+            data   = luax_checkdata(L, index);
+            length = data->getSize();
+        }
+
+        lua_Integer offset = 0;
+        lua_Integer size   = (lua_Integer)length;
+
+        if (ranged)
+        {
+            offset = luaL_optinteger(L, index + 1, 0);
+            size   = luaL_optinteger(L, index + 2, size - offset);
+
+            if (offset < 0 || size < 0)
+                luaL_error(L, E_INVALID_OFFSET_AND_SIZE);
+        }
+
+        if (isString)
+        {
+            if ((size_t)offset > length || (size_t)size > length - (size_t)offset)
+                luaL_error(L, E_OFFSET_AND_SIZE_ARGS_FIT_WITHIN_DATA);
+
+            if (size == 0)
+                return;
+
+            // The chain keeps its own reference, so ours is dropped whether or not it succeeds.
+            ByteData* copy = nullptr;
+
+            // clang-format off
+            luax_catchexcept(L,
+                [&] {
+                    copy = new ByteData(bytes + offset, (size_t)size);
+                    chain->append(copy, 0, (size_t)size);
+                },
+                [&](bool) { if (copy != nullptr) copy->release(); }
+            );
+            // clang-format on
+
+            return;
+        }
+
+        if (luax_istype(L, index, ChainedData::type))
+        {
+            auto* other = luax_totype<ChainedData>(L, index);
+            luax_catchexcept(L, [&] { chain->append(other, (size_t)offset, (size_t)size); });
+        }
+        else
+            luax_catchexcept(L, [&] { chain->append(data, (size_t)offset, (size_t)size); });
+    }
+
+    int open_chaineddata(lua_State* L)
+    {
+        return luax_register_type(L, &ChainedData::type, Wrap_Data::functions, functions);
+    }
+} // namespace love
@@ -0,0 +1,52 @@
+#include "modules/data/wrap_CompressionDictionary.hpp"
+#include "modules/data/wrap_Data.hpp"
+
+using namespace love;
+
+int Wrap_CompressionDictionary::clone(lua_State* L)
+{
+    auto* self            = luax_checkcompressiondictionary(L, 1);
+    CompressionDictionary* clone = nullptr;
+
+    luax_catchexcept(L, [&] { clone = self->clone(); });
+
+    luax_pushtype(L, clone);
+    clone->release();
+
+    return 1;
+}
+
+int Wrap_CompressionDictionary::getFormat(lua_State* L)
+{
+    auto* self  = luax_checkcompressiondictionary(L, 1);
+    auto format = self->getFormat();
+
+    std::string_view name {};
+    if (!Compressor::getConstant(format, name))
+        return luax_enumerror(L, "compression dictionary format", Compressor::formats, name);
+
+    luax_pushstring(L, name);
+
+    return 1;
+}
+
+// clang-format off
+static constexpr luaL_Reg functions[] =
+{
+    { "clone",     Wrap_CompressionDictionary::clone     },
+    { "getFormat", Wrap_CompressionDictionary::getFormat }
+};
+// clang-format on
+
+namespace love
+{
+    CompressionDictionary* luax_checkcompressiondictionary(lua_State* L, int index)
+    {
+        return luax_checktype<CompressionDictionary>(L, index);
+    }
+
+    int open_compressiondictionary(lua_State* L)
+    {
+        return luax_register_type(L, &CompressionDictionary::type, Wrap_Data::functions, functions);
+    }
+} // namespace love
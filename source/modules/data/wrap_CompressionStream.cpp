@@ -0,0 +1,90 @@
+#include "modules/data/wrap_CompressionStream.hpp"
+
+#include "modules/data/wrap_Data.hpp"
+
+using namespace love;
+
+int Wrap_CompressionStream::push(lua_State* L)
+{
+    auto* self = luax_checkcompressionstream(L, 1);
+
+    size_t size       = 0;
+    const char* bytes = nullptr;
+
+    if (lua_isstring(L, 2))
+        bytes = luaL_checklstring(L, 2, &size);
+    else
+    {
+        auto* data = luax_checkdata(L, 2);
+        bytes      = (const char*)data->getData();
+        size       = data->getSize();
+    }
+
+    std::string_view output {};
+    luax_catchexcept(L, [&] { output = self->push(bytes, size); });
+
+    lua_pushlstring(L, output.data(), output.size());
+
+    return 1;
+}
+
+int Wrap_CompressionStream::finish(lua_State* L)
+{
+    auto* self = luax_checkcompressionstream(L, 1);
+
+    std::string_view output {};
+    luax_catchexcept(L, [&] { output = self->finish(); });
+
+    lua_pushlstring(L, output.data(), output.size());
+
+    return 1;
+}
+
+int Wrap_CompressionStream::getFormat(lua_State* L)
+{
+    auto* self = luax_checkcompressionstream(L, 1);
+
+    std::string_view name {};
+    if (!Compressor::getConstant(self->getFormat(), name))
+        return luax_enumerror(L, "compressed data format", Compressor::formats, name);
+
+    luax_pushstring(L, name);
+
+    return 1;
+}
+
+int Wrap_CompressionStream::getMode(lua_State* L)
+{
+    auto* self = luax_checkcompressionstream(L, 1);
+
+    std::string_view name {};
+    if (!CompressionStream::getConstant(self->getMode(), name))
+        return luax_enumerror(L, "compression stream mode", CompressionStream::modes, name);
+
+    luax_pushstring(L, name);
+
+    return 1;
+}
+
+// clang-format off
+static constexpr luaL_Reg functions[] =
+{
+    { "push",      Wrap_CompressionStream::push      },
+    { "finish",    Wrap_CompressionStream::finish    },
+    { "getFormat", Wrap_CompressionStream::getFormat },
+    { "getMode",   Wrap_CompressionStream::getMode   }
+};
+// clang-format on
+
+namespace love
+{
+    CompressionStream* luax_checkcompressionstream(lua_State* L, int index)
+    {
+        return luax_checktype<CompressionStream>(L, index);
+    }
+
+    int open_compressionstream(lua_State* L)
+    {
+        return luax_register_type(L, &CompressionStream::type, functions);
+    }
+} // namespace love
@@ -1,6 +1,10 @@
 #include "modules/data/wrap_Data.hpp"
 #include "common/error.hpp"
 
+#include "modules/data/wrap_DataModule.hpp"
+
+#include <algorithm>
+
 using namespace love;
 
 int Wrap_Data::getString(lua_State* L)
@@ -64,6 +68,54 @@ int Wrap_Data::performAtomic(lua_State* L)
     return lua_gettop(L) - 1;
 }
 
+static constexpr size_t TABLE_BATCH_SIZE = 256;
+
+int Wrap_Data::toTable(lua_State* L)
+{
+    auto* self         = luax_checkdata(L, 1);
+    auto type          = luax_checkelementtype(L, 2);
+    int64_t offset     = (int64_t)luaL_checknumber(L, 3);
+    lua_Integer count  = luaL_checkinteger(L, 4);
+    size_t elementSize = ArrayKernels::getElementSize(type);
+
+    if (count <= 0)
+        return luaL_error(L, E_INVALID_COUNT_PARAMETER);
+
+    if (offset < 0 || (size_t)offset > self->getSize() ||
+        (size_t)count > (self->getSize() - (size_t)offset) / elementSize)
+    {
+        return luaL_error(L, E_INVALID_OFFSET_AND_SIZE);
+    }
+
+    if (lua_isnoneornil(L, 5))
+        lua_createtable(L, (int)count, 0);
+    else
+    {
+        luaL_checktype(L, 5, LUA_TTABLE);
+        lua_pushvalue(L, 5);
+    }
+
+    int table            = lua_gettop(L);
+    const char* elements = (const char*)self->getData() + offset;
+
+    // Elements are converted a batch at a time, like love.data.fromTable.
+    double numbers[TABLE_BATCH_SIZE];
+
+    for (size_t start = 0; start < (size_t)count; start += TABLE_BATCH_SIZE)
+    {
+        size_t batch = std::min((size_t)count - start, TABLE_BATCH_SIZE);
+        ArrayKernels::toNumbers(type, numbers, elements + start * elementSize, batch);
+
+        for (size_t index = 0; index < batch; index++)
+        {
+            lua_pushnumber(L, numbers[index]);
+            lua_rawseti(L, table, (int)(start + index + 1));
+        }
+    }
+
+    return 1;
+}
+
 template<typename T>
 static int wrap_Data_getT(lua_State* L)
 {
@@ -99,6 +151,7 @@ luaL_Reg Wrap_Data::functions[] =
 	{ "getUInt16",     wrap_Data_getT<uint16_t>  },
 	{ "getInt32",      wrap_Data_getT<int32_t>   },
 	{ "getUInt32",     wrap_Data_getT<uint32_t>  },
+    { "toTable",       Wrap_Data::toTable        },
     { "performAtomic", Wrap_Data::performAtomic  },
     { "getFFIPointer", Wrap_Data::getFFIPointer  }
 };
@@ -3,15 +3,25 @@
 #include "modules/data/DataModule.hpp"
 
 #include "modules/data/wrap_ByteData.hpp"
+#include "modules/data/wrap_ChainedData.hpp"
 #include "modules/data/wrap_CompressedData.hpp"
+#include "modules/data/wrap_CompressionDictionary.hpp"
+#include "modules/data/wrap_CompressionStream.hpp"
 #include "modules/data/wrap_Data.hpp"
 #include "modules/data/wrap_DataView.hpp"
+#include "modules/data/wrap_Hasher.hpp"
+#include "modules/data/wrap_Json.hpp"
+#include "modules/data/wrap_PackFormat.hpp"
 
+#include "common/Allocator.hpp"
 #include "common/b64.hpp"
 #include "modules/data/ByteData.hpp"
 #include "modules/data/CompressedData.hpp"
 #include "modules/data/DataView.hpp"
 
+#include <new>
+#include <vector>
+
 using namespace love;
 
 #define instance() DataModule::getInstance<DataModule>(Module::M_DATA)
@@ -29,9 +39,12 @@ int Wrap_DataModule::compress(lua_State* L)
     int level            = luaL_optinteger(L, 4, -1);
     size_t rawSize       = 0;
     const char* rawBytes = nullptr;
+    ChainedData* chain   = nullptr;
 
     if (lua_isstring(L, 3))
         rawBytes = luaL_checklstring(L, 3, &rawSize);
+    else if (luax_istype(L, 3, ChainedData::type))
+        chain = luax_checkchaineddata(L, 3);
     else
     {
         auto* rawData = luax_checktype<Data>(L, 3);
@@ -39,8 +52,17 @@ int Wrap_DataModule::compress(lua_State* L)
         rawBytes      = (const char*)rawData->getData();
     }
 
+    CompressionDictionary* dictionary = nullptr;
+    if (!lua_isnoneornil(L, 5))
+        dictionary = luax_checkcompressiondictionary(L, 5);
+
     CompressedData* data = nullptr;
-    luax_catchexcept(L, [&] { data = data::compress(format, rawBytes, rawSize, level); });
+    luax_catchexcept(L, [&] {
+        if (chain != nullptr)
+            data = data::compress(format, chain, level, dictionary);
+        else
+            data = data::compress(format, rawBytes, rawSize, level, dictionary);
+    });
 
     if (containerType == data::CONTAINER_DATA)
         luax_pushtype(L, data);
@@ -62,7 +84,12 @@ int Wrap_DataModule::decompress(lua_State* L)
     {
         auto* data = luax_checkcompresseddata(L, 2);
         size       = data->getDecompressedSize();
-        luax_catchexcept(L, [&] { rawBytes = data::decompress(data, size); });
+
+        CompressionDictionary* dictionary = nullptr;
+        if (!lua_isnoneornil(L, 3))
+            dictionary = luax_checkcompressiondictionary(L, 3);
+
+        luax_catchexcept(L, [&] { rawBytes = data::decompress(data, size, dictionary); });
     }
     else
     {
@@ -84,8 +111,13 @@ int Wrap_DataModule::decompress(lua_State* L)
         else
             cBytes = luaL_checklstring(L, 3, &compressedSize);
 
-        luax_catchexcept(
-            L, [&] { rawBytes = data::decompress(format, cBytes, compressedSize, size); });
+        CompressionDictionary* dictionary = nullptr;
+        if (!lua_isnoneornil(L, 4))
+            dictionary = luax_checkcompressiondictionary(L, 4);
+
+        luax_catchexcept(L, [&] {
+            rawBytes = data::decompress(format, cBytes, compressedSize, size, dictionary);
+        });
     }
 
     if (containerType == data::CONTAINER_DATA)
@@ -105,6 +137,53 @@ int Wrap_DataModule::decompress(lua_State* L)
     return 1;
 }
 
+int Wrap_DataModule::decompressInto(lua_State* L)
+{
+    auto* target   = luax_checkbytedata(L, 1);
+    int64_t offset = (int64_t)luaL_checknumber(L, 2);
+
+    if (offset < 0 || offset > (int64_t)target->getSize())
+        return luaL_error(L, E_INVALID_OFFSET_AND_SIZE);
+
+    char* destination = (char*)target->getData() + offset;
+    size_t capacity   = target->getSize() - (size_t)offset;
+    size_t written    = 0;
+
+    if (luax_istype(L, 3, CompressedData::type))
+    {
+        auto* data = luax_checkcompresseddata(L, 3);
+        luax_catchexcept(L, [&] { written = data::decompressInto(data, destination, capacity); });
+    }
+    else
+    {
+        auto format              = Compressor::FORMAT_LZ4;
+        const char* formatString = luaL_checkstring(L, 3);
+
+        if (!Compressor::getConstant(formatString, format))
+            return luax_enumerror(L, "compressed data format", Compressor::formats, formatString);
+
+        size_t compressedSize = 0;
+        const char* cBytes    = nullptr;
+
+        if (luax_istype(L, 4, Data::type))
+        {
+            auto* data     = luax_checktype<Data>(L, 4);
+            cBytes         = (const char*)data->getData();
+            compressedSize = data->getSize();
+        }
+        else
+            cBytes = luaL_checklstring(L, 4, &compressedSize);
+
+        luax_catchexcept(L, [&] {
+            written = data::decompressInto(format, cBytes, compressedSize, destination, capacity);
+        });
+    }
+
+    lua_pushinteger(L, (lua_Integer)written);
+
+    return 1;
+}
+
 int Wrap_DataModule::encode(lua_State* L)
 {
     auto containerType     = luax_checkcontainertype(L, 1);
@@ -127,12 +206,14 @@ int Wrap_DataModule::encode(lua_State* L)
         source = luaL_checklstring(L, 3, &srcLength);
 
     size_t lineLength = luaL_optinteger(L, 4, 0);
+    bool uppercase    = luax_optboolean(L, 5, false);
 
     size_t dstLength = 0;
     char* dst        = nullptr;
 
-    luax_catchexcept(L,
-                     [&] { dst = data::encode(format, source, srcLength, dstLength, lineLength); });
+    luax_catchexcept(L, [&] {
+        dst = data::encode(format, source, srcLength, dstLength, lineLength, uppercase);
+    });
 
     if (containerType == data::CONTAINER_DATA)
     {
@@ -159,6 +240,49 @@ int Wrap_DataModule::encode(lua_State* L)
     return 1;
 }
 
+int Wrap_DataModule::encodeInto(lua_State* L)
+{
+    auto* target   = luax_checkbytedata(L, 1);
+    int64_t offset = (int64_t)luaL_checknumber(L, 2);
+
+    if (offset < 0 || offset > (int64_t)target->getSize())
+        return luaL_error(L, E_INVALID_OFFSET_AND_SIZE);
+
+    const char* formatName = luaL_checkstring(L, 3);
+
+    data::EncodeFormat format = data::ENCODE_MAX_ENUM;
+    if (!data::getConstant(formatName, format))
+        return luax_enumerror(L, "encode format", data::encodeFormats, formatName);
+
+    size_t srcLength   = 0;
+    const char* source = nullptr;
+
+    if (luax_istype(L, 4, Data::type))
+    {
+        auto* data = luax_totype<Data>(L, 4);
+        source     = (const char*)data->getData();
+        srcLength  = data->getSize();
+    }
+    else
+        source = luaL_checklstring(L, 4, &srcLength);
+
+    size_t lineLength = luaL_optinteger(L, 5, 0);
+    bool uppercase    = luax_optboolean(L, 6, false);
+
+    char* destination = (char*)target->getData() + offset;
+    size_t capacity   = target->getSize() - (size_t)offset;
+    size_t written    = 0;
+
+    luax_catchexcept(L, [&] {
+        written = data::encodeInto(format, source, srcLength, destination, capacity, lineLength,
+                                   uppercase);
+    });
+
+    lua_pushinteger(L, (lua_Integer)written);
+
+    return 1;
+}
+
 int Wrap_DataModule::decode(lua_State* L)
 {
     auto containerType     = luax_checkcontainertype(L, 1);
@@ -180,9 +304,12 @@ int Wrap_DataModule::decode(lua_State* L)
     else
         source = luaL_checklstring(L, 3, &srcLength);
 
+    bool strict = luax_optboolean(L, 4, false);
+
     size_t dstLength = 0;
     char* dst        = nullptr;
-    luax_catchexcept(L, [&] { dst = data::decode(format, source, srcLength, dstLength); });
+    luax_catchexcept(L,
+                     [&] { dst = data::decode(format, source, srcLength, dstLength, strict); });
 
     if (containerType == data::CONTAINER_DATA)
     {
@@ -211,7 +338,13 @@ int Wrap_DataModule::decode(lua_State* L)
 
 int Wrap_DataModule::hash(lua_State* L)
 {
-    auto containerType = luax_checkcontainertype(L, 1);
+    // "number" returns the digest as 32-bit unsigned integers, most significant first, so
+    // 32 and 64-bit digests can be used as keys without building a string.
+    bool asNumbers     = std::strcmp(luaL_checkstring(L, 1), "number") == 0;
+    auto containerType = data::CONTAINER_STRING;
+
+    if (!asNumbers)
+        containerType = luax_checkcontainertype(L, 1);
 
     auto function            = HashFunction::FUNCTION_MAX_ENUM;
     const char* formatString = luaL_checkstring(L, 2);
@@ -226,12 +359,25 @@ int Wrap_DataModule::hash(lua_State* L)
         const char* bytes = luaL_checklstring(L, 3, &rawSize);
         luax_catchexcept(L, [&] { data::hash(function, bytes, rawSize, value); });
     }
+    else if (luax_istype(L, 3, ChainedData::type))
+    {
+        auto* chain = luax_checkchaineddata(L, 3);
+        luax_catchexcept(L, [&] { data::hash(function, chain, value); });
+    }
     else
     {
         auto* data = luax_checktype<Data>(L, 3);
         luax_catchexcept(L, [&] { data::hash(function, data, value); });
     }
 
+    if (asNumbers)
+    {
+        for (size_t offset = 0; offset < value.size; offset += 4)
+            lua_pushnumber(L, (lua_Number)load32be((const uint8_t*)value.data + offset));
+
+        return (int)(value.size / 4);
+    }
+
     if (containerType == data::CONTAINER_DATA)
     {
         Data* data = nullptr;
@@ -247,6 +393,118 @@ int Wrap_DataModule::hash(lua_State* L)
     return 1;
 }
 
+int Wrap_DataModule::hashBatch(lua_State* L)
+{
+    auto function            = HashFunction::FUNCTION_MAX_ENUM;
+    const char* formatString = luaL_checkstring(L, 1);
+
+    if (!HashFunction::getConstant(formatString, function))
+        return luax_enumerror(L, "hash function", HashFunction::hashFunctions, formatString);
+
+    luaL_checktype(L, 2, LUA_TTABLE);
+    size_t count = luax_objlen(L, 2);
+
+    // The table keeps every string and Data alive while the workers read them.
+    std::vector<const char*> inputs(count);
+    std::vector<uint64_t> sizes(count);
+
+    for (size_t index = 0; index < count; index++)
+    {
+        lua_rawgeti(L, 2, index + 1);
+
+        if (lua_type(L, -1) == LUA_TSTRING)
+        {
+            size_t rawSize = 0;
+            inputs[index]  = lua_tolstring(L, -1, &rawSize);
+            sizes[index]   = rawSize;
+        }
+        else
+        {
+            auto* data    = luax_checktype<Data>(L, -1);
+            inputs[index] = (const char*)data->getData();
+            sizes[index]  = data->getSize();
+        }
+
+        lua_pop(L, 1);
+    }
+
+    std::vector<HashFunction::Value> values(count);
+    luax_catchexcept(L, [&] {
+        data::hashBatch(function, inputs.data(), sizes.data(), values.data(), count);
+    });
+
+    lua_createtable(L, (int)count, 0);
+
+    for (size_t index = 0; index < count; index++)
+    {
+        lua_pushlstring(L, values[index].data, values[index].size);
+        lua_rawseti(L, -2, index + 1);
+    }
+
+    return 1;
+}
+
+int Wrap_DataModule::getHashBackend(lua_State* L)
+{
+    auto backend = HashFunction::getBackend();
+
+    std::string_view name {};
+    if (!HashFunction::getConstant(backend, name))
+        return luax_enumerror(L, "hash backend", HashFunction::backends, name);
+
+    luax_pushstring(L, name);
+
+    return 1;
+}
+
+int Wrap_DataModule::getCompressorStats(lua_State* L)
+{
+    auto stats = Compressor::getStats();
+
+    if (lua_istable(L, 1))
+        lua_pushvalue(L, 1);
+    else
+        lua_createtable(L, 0, 3);
+
+    lua_pushnumber(L, (lua_Number)stats.contextsCreated);
+    lua_setfield(L, -2, "contextsCreated");
+
+    lua_pushnumber(L, (lua_Number)stats.contextsReused);
+    lua_setfield(L, -2, "contextsReused");
+
+    lua_pushnumber(L, (lua_Number)stats.bytesSaved);
+    lua_setfield(L, -2, "bytesSaved");
+
+    return 1;
+}
+
+int Wrap_DataModule::getAllocatorStats(lua_State* L)
+{
+    auto stats = Allocator::getStats();
+
+    if (lua_istable(L, 1))
+        lua_pushvalue(L, 1);
+    else
+        lua_createtable(L, 0, 5);
+
+    lua_pushnumber(L, (lua_Number)stats.allocations);
+    lua_setfield(L, -2, "allocations");
+
+    lua_pushnumber(L, (lua_Number)stats.cacheHits);
+    lua_setfield(L, -2, "cacheHits");
+
+    lua_pushnumber(L, (lua_Number)stats.largeAllocations);
+    lua_setfield(L, -2, "largeAllocations");
+
+    lua_pushnumber(L, (lua_Number)stats.bytesInUse);
+    lua_setfield(L, -2, "bytesInUse");
+
+    lua_pushnumber(L, (lua_Number)stats.bytesCached);
+    lua_setfield(L, -2, "bytesCached");
+
+    return 1;
+}
+
 int Wrap_DataModule::pack(lua_State* L)
 {
     if (luax_istype(L, 1, ByteData::type))
@@ -313,6 +571,390 @@ int Wrap_DataModule::unpack(lua_State* L)
     return lua53_str_unpack(L, format, input, size, 2, 3);
 }
 
+int Wrap_DataModule::serialize(lua_State* L)
+{
+    auto containerType = luax_checkcontainertype(L, 1);
+    luaL_checkany(L, 2);
+
+    auto format = Compressor::FORMAT_MAX_ENUM;
+
+    if (!lua_isnoneornil(L, 3))
+    {
+        const char* formatName = luaL_checkstring(L, 3);
+
+        if (!Compressor::getConstant(formatName, format))
+            return luax_enumerror(L, "compressed data format", Compressor::formats, formatName);
+    }
+
+    int level = luaL_optinteger(L, 4, -1);
+
+    Variant value = luax_checkvariant(L, 2, false);
+    std::vector<char> output;
+
+    luax_catchexcept(L, [&] { data::serialize(value, output, format, level); });
+
+    if (containerType == data::CONTAINER_DATA)
+    {
+        ByteData* data = nullptr;
+        luax_catchexcept(L, [&] { data = instance()->newByteData(output.data(), output.size()); });
+
+        luax_pushtype(L, Data::type, data);
+        data->release();
+    }
+    else
+        lua_pushlstring(L, output.data(), output.size());
+
+    return 1;
+}
+
+static int destroyVariant(lua_State* L)
+{
+    ((Variant*)lua_touserdata(L, 1))->~Variant();
+    return 0;
+}
+
+int Wrap_DataModule::deserialize(lua_State* L)
+{
+    const char* input = nullptr;
+    size_t size       = 0;
+
+    if (luax_istype(L, 1, Data::type))
+    {
+        auto* data = luax_checkdata(L, 1);
+        input      = (const char*)data->getData();
+        size       = data->getSize();
+    }
+    else
+        input = luaL_checklstring(L, 1, &size);
+
+    // The decoded value lives in a userdata, so the garbage collector still frees it if pushing
+    // it raises a Lua error.
+    auto* value = new (lua_newuserdata(L, sizeof(Variant))) Variant();
+
+    if (luaL_newmetatable(L, "DeserializedValue"))
+    {
+        lua_pushcfunction(L, destroyVariant);
+        lua_setfield(L, -2, "__gc");
+    }
+
+    lua_setmetatable(L, -2);
+
+    luax_catchexcept(L, [&] { *value = data::deserialize(input, size); });
+
+    luax_pushvariant(L, *value);
+    *value = Variant();
+
+    return 1;
+}
+
+static size_t checkElementCount(lua_State* L, int index)
+{
+    lua_Integer count = luaL_checkinteger(L, index);
+
+    if (count <= 0)
+        luaL_error(L, E_INVALID_COUNT_PARAMETER);
+
+    return (size_t)count;
+}
+
+// Checks that `count` elements at the byte offset at `index` fit within the Data.
+static char* checkElements(lua_State* L, Data* data, int index, ArrayKernels::ElementType type,
+                           size_t count)
+{
+    lua_Integer offset = luaL_checkinteger(L, index);
+    size_t size        = data->getSize();
+
+    if (offset < 0 || (size_t)offset > size ||
+        count > (size - (size_t)offset) / ArrayKernels::getElementSize(type))
+    {
+        luaL_error(L, E_INVALID_OFFSET_AND_SIZE);
+    }
+
+    return (char*)data->getData() + offset;
+}
+
+// The kernels read each step of a source before writing that step of the target, so a target
+// may be exactly its source but must not partially overlap it.
+static void checkOverlap(lua_State* L, const char* target, size_t targetSize, const char* source,
+                         size_t sourceSize)
+{
+    bool same = target == source && targetSize == sourceSize;
+
+    if (!same && target < source + sourceSize && source < target + targetSize)
+        luaL_error(L, E_ARRAYS_PARTIALLY_OVERLAP);
+}
+
+// An operand is a number, or a Data followed by a byte offset. Returns the index after it.
+static int checkOperand(lua_State* L, int index, ArrayKernels::ElementType type, size_t count,
+                        const char* target, ArrayKernels::Operand& operand)
+{
+    if (lua_type(L, index) == LUA_TNUMBER)
+    {
+        operand = { nullptr, lua_tonumber(L, index) };
+        return index + 1;
+    }
+
+    auto* data   = luax_checkdata(L, index);
+    auto* source = checkElements(L, data, index + 1, type, count);
+    size_t size  = count * ArrayKernels::getElementSize(type);
+
+    checkOverlap(L, target, size, source, size);
+    operand = { source, 0.0 };
+
+    return index + 2;
+}
+
+int Wrap_DataModule::fill(lua_State* L)
+{
+    auto type    = luax_checkelementtype(L, 1);
+    size_t count = checkElementCount(L, 2);
+    auto* target = checkElements(L, luax_checkbytedata(L, 3), 4, type, count);
+    double value = luaL_checknumber(L, 5);
+
+    ArrayKernels::fill(type, target, count, value);
+
+    return 0;
+}
+
+static int applyOperation(lua_State* L, ArrayKernels::Operation operation)
+{
+    auto type    = luax_checkelementtype(L, 1);
+    size_t count = checkElementCount(L, 2);
+    auto* target = checkElements(L, luax_checkbytedata(L, 3), 4, type, count);
+
+    ArrayKernels::Operand a {};
+    ArrayKernels::Operand b {};
+
+    int index = checkOperand(L, 5, type, count, target, a);
+    checkOperand(L, index, type, count, target, b);
+
+    ArrayKernels::apply(operation, type, target, a, b, count);
+
+    return 0;
+}
+
+int Wrap_DataModule::add(lua_State* L)
+{
+    return applyOperation(L, ArrayKernels::OPERATION_ADD);
+}
+
+int Wrap_DataModule::subtract(lua_State* L)
+{
+    return applyOperation(L, ArrayKernels::OPERATION_SUBTRACT);
+}
+
+int Wrap_DataModule::multiply(lua_State* L)
+{
+    return applyOperation(L, ArrayKernels::OPERATION_MULTIPLY);
+}
+
+int Wrap_DataModule::fma(lua_State* L)
+{
+    auto type    = luax_checkelementtype(L, 1);
+    size_t count = checkElementCount(L, 2);
+    auto* target = checkElements(L, luax_checkbytedata(L, 3), 4, type, count);
+
+    ArrayKernels::Operand a {};
+    ArrayKernels::Operand b {};
+    ArrayKernels::Operand c {};
+
+    int index = checkOperand(L, 5, type, count, target, a);
+    index     = checkOperand(L, index, type, count, target, b);
+    checkOperand(L, index, type, count, target, c);
+
+    ArrayKernels::fma(type, target, a, b, c, count);
+
+    return 0;
+}
+
+int Wrap_DataModule::clamp(lua_State* L)
+{
+    auto type    = luax_checkelementtype(L, 1);
+    size_t count = checkElementCount(L, 2);
+    auto* target = checkElements(L, luax_checkbytedata(L, 3), 4, type, count);
+    double low   = luaL_checknumber(L, 5);
+    double high  = luaL_checknumber(L, 6);
+
+    ArrayKernels::clamp(type, target, count, low, high);
+
+    return 0;
+}
+
+int Wrap_DataModule::convert(lua_State* L)
+{
+    auto targetType = luax_checkelementtype(L, 1);
+    size_t count    = checkElementCount(L, 2);
+    auto* target    = checkElements(L, luax_checkbytedata(L, 3), 4, targetType, count);
+    auto sourceType = luax_checkelementtype(L, 5);
+    auto* source    = checkElements(L, luax_checkdata(L, 6), 7, sourceType, count);
+    double scale    = luaL_optnumber(L, 8, 1.0);
+    double bias     = luaL_optnumber(L, 9, 0.0);
+
+    checkOverlap(L, target, count * ArrayKernels::getElementSize(targetType), source,
+                 count * ArrayKernels::getElementSize(sourceType));
+
+    ArrayKernels::convert(targetType, target, sourceType, source, count, scale, bias);
+
+    return 0;
+}
+
+static int reduce(lua_State* L, ArrayKernels::Reduction reduction)
+{
+    auto type    = luax_checkelementtype(L, 1);
+    size_t count = checkElementCount(L, 2);
+    auto* source = checkElements(L, luax_checkdata(L, 3), 4, type, count);
+
+    lua_pushnumber(L, (lua_Number)ArrayKernels::reduce(reduction, type, source, count));
+
+    return 1;
+}
+
+int Wrap_DataModule::sum(lua_State* L)
+{
+    return reduce(L, ArrayKernels::REDUCTION_SUM);
+}
+
+int Wrap_DataModule::min(lua_State* L)
+{
+    return reduce(L, ArrayKernels::REDUCTION_MIN);
+}
+
+int Wrap_DataModule::max(lua_State* L)
+{
+    return reduce(L, ArrayKernels::REDUCTION_MAX);
+}
+
+int Wrap_DataModule::dot(lua_State* L)
+{
+    auto type    = luax_checkelementtype(L, 1);
+    size_t count = checkElementCount(L, 2);
+    auto* a      = checkElements(L, luax_checkdata(L, 3), 4, type, count);
+    auto* b      = checkElements(L, luax_checkdata(L, 5), 6, type, count);
+
+    lua_pushnumber(L, (lua_Number)ArrayKernels::dot(type, a, b, count));
+
+    return 1;
+}
+
+// Reads the optional stride and key offset at `index` and `index + 1`, then checks that `count`
+// records at the byte offset at `offsetIndex` fit within the Data.
+static char* checkRecords(lua_State* L, Data* data, int offsetIndex, ArrayKernels::ElementType type,
+                          size_t count, int index, size_t& stride, size_t& keyOffset)
+{
+    size_t keySize = ArrayKernels::getElementSize(type);
+
+    lua_Integer strideValue = luaL_optinteger(L, index, (lua_Integer)keySize);
+    lua_Integer keyValue    = luaL_optinteger(L, index + 1, 0);
+
+    if (keyValue < 0 || strideValue < keyValue || (size_t)(strideValue - keyValue) < keySize)
+        luaL_error(L, E_INVALID_RECORD_LAYOUT);
+
+    stride    = (size_t)strideValue;
+    keyOffset = (size_t)keyValue;
+
+    lua_Integer offset = luaL_checkinteger(L, offsetIndex);
+    size_t size        = data->getSize();
+
+    if (offset < 0 || (size_t)offset > size || count > (size - (size_t)offset) / stride)
+        luaL_error(L, E_INVALID_OFFSET_AND_SIZE);
+
+    return (char*)data->getData() + offset;
+}
+
+int Wrap_DataModule::sort(lua_State* L)
+{
+    auto* data   = luax_checkbytedata(L, 1);
+    auto type    = luax_checkelementtype(L, 2);
+    size_t count = checkElementCount(L, 4);
+
+    size_t stride    = 0;
+    size_t keyOffset = 0;
+    auto* records    = checkRecords(L, data, 3, type, count, 5, stride, keyOffset);
+
+    if (count > std::numeric_limits<uint32_t>::max())
+        return luaL_error(L, E_TOO_MANY_RECORDS);
+
+    luax_catchexcept(L, [&] { ArrayKernels::sort(type, records, count, stride, keyOffset); });
+
+    return 0;
+}
+
+int Wrap_DataModule::search(lua_State* L)
+{
+    auto* data   = luax_checkdata(L, 1);
+    auto type    = luax_checkelementtype(L, 2);
+    size_t count = checkElementCount(L, 4);
+    double value = luaL_checknumber(L, 5);
+
+    size_t stride    = 0;
+    size_t keyOffset = 0;
+    auto* records    = checkRecords(L, data, 3, type, count, 6, stride, keyOffset);
+
+    bool found   = false;
+    size_t index = ArrayKernels::search(type, records, count, stride, keyOffset, value, found);
+
+    lua_pushnumber(L, (lua_Number)index);
+    lua_pushboolean(L, found);
+
+    return 2;
+}
+
+static constexpr size_t TABLE_BATCH_SIZE = 256;
+
+int Wrap_DataModule::fromTable(lua_State* L)
+{
+    auto type = luax_checkelementtype(L, 1);
+    luaL_checktype(L, 2, LUA_TTABLE);
+
+    size_t count       = lua_objlen(L, 2);
+    size_t elementSize = ArrayKernels::getElementSize(type);
+    char* elements     = nullptr;
+
+    if (lua_isnoneornil(L, 3))
+    {
+        if (count == 0)
+            return luaL_error(L, E_DATA_SIZE_MUST_BE_POSITIVE);
+
+        ByteData* result = nullptr;
+        luax_catchexcept(L, [&] { result = instance()->newByteData(count * elementSize, false); });
+
+        luax_pushtype(L, result);
+        result->release();
+
+        elements = (char*)result->getData();
+    }
+    else
+    {
+        auto* target = luax_checkbytedata(L, 3);
+        elements     = checkElements(L, target, 4, type, count);
+
+        lua_pushvalue(L, 3);
+    }
+
+    // Numbers are read a batch at a time so the element conversion runs over whole arrays.
+    double numbers[TABLE_BATCH_SIZE];
+
+    for (size_t start = 0; start < count; start += TABLE_BATCH_SIZE)
+    {
+        size_t batch = std::min(count - start, TABLE_BATCH_SIZE);
+
+        for (size_t index = 0; index < batch; index++)
+        {
+            lua_rawgeti(L, 2, (int)(start + index + 1));
+
+            if (lua_type(L, -1) != LUA_TNUMBER)
+                return luaL_error(L, E_TABLE_ELEMENT_NOT_NUMBER, (int)(start + index + 1));
+
+            numbers[index] = lua_tonumber(L, -1);
+            lua_pop(L, 1);
+        }
+
+        ArrayKernels::fromNumbers(type, elements + start * elementSize, numbers, batch);
+    }
+
+    return 1;
+}
+
 int Wrap_DataModule::newByteData(lua_State* L)
 {
     ByteData* result = nullptr;
@@ -349,7 +991,8 @@ int Wrap_DataModule::newByteData(lua_State* L)
         if (size <= 0)
             return luaL_error(L, E_DATA_SIZE_MUST_BE_POSITIVE);
 
-        luax_catchexcept(L, [&] { result = instance()->newByteData((size_t)size); });
+        bool clear = luax_optboolean(L, 2, true);
+        luax_catchexcept(L, [&] { result = instance()->newByteData((size_t)size, clear); });
     }
 
     luax_pushtype(L, result);
@@ -377,19 +1020,194 @@ int Wrap_DataModule::newDataView(lua_State* L)
     return 1;
 }
 
+int Wrap_DataModule::newChainedData(lua_State* L)
+{
+    ChainedData* result = nullptr;
+    luax_catchexcept(L, [&] { result = instance()->newChainedData(); });
+
+    int count = lua_gettop(L);
+
+    // Pushed first so Lua owns it if an argument turns out to be invalid.
+    luax_pushtype(L, result);
+    result->release();
+
+    for (int index = 1; index <= count; index++)
+        luax_appendtochain(L, result, index, false);
+
+    return 1;
+}
+
+int Wrap_DataModule::newHasher(lua_State* L)
+{
+    auto function            = HashFunction::FUNCTION_MAX_ENUM;
+    const char* formatString = luaL_checkstring(L, 1);
+
+    if (!HashFunction::getConstant(formatString, function))
+        return luax_enumerror(L, "hash function", HashFunction::hashFunctions, formatString);
+
+    Hasher* result = nullptr;
+    luax_catchexcept(L, [&] { result = instance()->newHasher(function); });
+
+    luax_pushtype(L, result);
+    result->release();
+
+    return 1;
+}
+
+int Wrap_DataModule::newPackFormat(lua_State* L)
+{
+    const char* format = luaL_checkstring(L, 1);
+
+    PackFormat* result = nullptr;
+    luax_catchexcept(L, [&] { result = instance()->newPackFormat(format); });
+
+    luax_pushtype(L, result);
+    result->release();
+
+    return 1;
+}
+
+int Wrap_DataModule::newCompressionStream(lua_State* L)
+{
+    auto format            = Compressor::FORMAT_MAX_ENUM;
+    const char* formatName = luaL_checkstring(L, 1);
+
+    if (!Compressor::getConstant(formatName, format))
+        return luax_enumerror(L, "compressed data format", Compressor::formats, formatName);
+
+    int level = luaL_optinteger(L, 2, -1);
+
+    CompressionStream* result = nullptr;
+    luax_catchexcept(L, [&] { result = instance()->newCompressionStream(format, level); });
+
+    luax_pushtype(L, result);
+    result->release();
+
+    return 1;
+}
+
+int Wrap_DataModule::newDecompressionStream(lua_State* L)
+{
+    auto format            = Compressor::FORMAT_MAX_ENUM;
+    const char* formatName = luaL_checkstring(L, 1);
+
+    if (!Compressor::getConstant(formatName, format))
+        return luax_enumerror(L, "compressed data format", Compressor::formats, formatName);
+
+    CompressionStream* result = nullptr;
+    luax_catchexcept(L, [&] { result = instance()->newDecompressionStream(format); });
+
+    luax_pushtype(L, result);
+    result->release();
+
+    return 1;
+}
+
+int Wrap_DataModule::newCompressionDictionary(lua_State* L)
+{
+    auto format            = Compressor::FORMAT_MAX_ENUM;
+    const char* formatName = luaL_checkstring(L, 1);
+
+    if (!Compressor::getConstant(formatName, format))
+        return luax_enumerror(L, "compressed data format", Compressor::formats, formatName);
+
+    CompressionDictionary* result = nullptr;
+
+    if (lua_istable(L, 2))
+    {
+        size_t count = luax_objlen(L, 2);
+        std::vector<std::string_view> samples(count);
+
+        // The table keeps every sample alive until the dictionary has been built.
+        for (size_t index = 0; index < count; index++)
+        {
+            lua_rawgeti(L, 2, index + 1);
+
+            if (lua_type(L, -1) == LUA_TSTRING)
+            {
+                size_t size       = 0;
+                const char* bytes = lua_tolstring(L, -1, &size);
+                samples[index]    = std::string_view(bytes, size);
+            }
+            else
+            {
+                auto* data     = luax_checktype<Data>(L, -1);
+                samples[index] = std::string_view((const char*)data->getData(), data->getSize());
+            }
+
+            lua_pop(L, 1);
+        }
+
+        luax_catchexcept(L, [&] {
+            result = instance()->newCompressionDictionary(format, samples);
+        });
+    }
+    else
+    {
+        size_t size         = 0;
+        const char* content = nullptr;
+
+        if (lua_type(L, 2) == LUA_TSTRING)
+            content = lua_tolstring(L, 2, &size);
+        else
+        {
+            auto* data = luax_checktype<Data>(L, 2);
+            content    = (const char*)data->getData();
+            size       = data->getSize();
+        }
+
+        luax_catchexcept(L, [&] {
+            result = instance()->newCompressionDictionary(format, content, size);
+        });
+    }
+
+    luax_pushtype(L, result);
+    result->release();
+
+    return 1;
+}
+
 // clang-format off
 static constexpr luaL_Reg functions[] =
 {
-    { "compress",      Wrap_DataModule::compress    },
-    { "decompress",    Wrap_DataModule::decompress  },
-    { "encode",        Wrap_DataModule::encode      },
-    { "decode",        Wrap_DataModule::decode      },
-    { "hash",          Wrap_DataModule::hash        },
-    { "pack",          Wrap_DataModule::pack        },
-    { "unpack",        Wrap_DataModule::unpack      },
-    { "getPackedSize", lua53_str_packsize           },
-    { "newByteData",   Wrap_DataModule::newByteData },
-    { "newDataView",   Wrap_DataModule::newDataView }
+    { "compress",                 Wrap_DataModule::compress                 },
+    { "decompress",               Wrap_DataModule::decompress               },
+    { "decompressInto",           Wrap_DataModule::decompressInto           },
+    { "encode",                   Wrap_DataModule::encode                   },
+    { "encodeInto",               Wrap_DataModule::encodeInto               },
+    { "decode",                   Wrap_DataModule::decode                   },
+    { "hash",                     Wrap_DataModule::hash                     },
+    { "hashBatch",                Wrap_DataModule::hashBatch                },
+    { "getHashBackend",           Wrap_DataModule::getHashBackend           },
+    { "getCompressorStats",       Wrap_DataModule::getCompressorStats       },
+    { "getAllocatorStats",        Wrap_DataModule::getAllocatorStats        },
+    { "pack",                     Wrap_DataModule::pack                     },
+    { "unpack",                   Wrap_DataModule::unpack                   },
+    { "getPackedSize",            lua53_str_packsize                        },
+    { "serialize",                Wrap_DataModule::serialize                },
+    { "deserialize",              Wrap_DataModule::deserialize              },
+    { "fill",                     Wrap_DataModule::fill                     },
+    { "add",                      Wrap_DataModule::add                      },
+    { "subtract",                 Wrap_DataModule::subtract                 },
+    { "multiply",                 Wrap_DataModule::multiply                 },
+    { "fma",                      Wrap_DataModule::fma                      },
+    { "clamp",                    Wrap_DataModule::clamp                    },
+    { "convert",                  Wrap_DataModule::convert                  },
+    { "sum",                      Wrap_DataModule::sum                      },
+    { "min",                      Wrap_DataModule::min                      },
+    { "max",                      Wrap_DataModule::max                      },
+    { "dot",                      Wrap_DataModule::dot                      },
+    { "sort",                     Wrap_DataModule::sort                     },
+    { "search",                   Wrap_DataModule::search                   },
+    { "fromTable",                Wrap_DataModule::fromTable                },
+    { "newByteData",              Wrap_DataModule::newByteData              },
+    { "newDataView",              Wrap_DataModule::newDataView              },
+    { "newChainedData",           Wrap_DataModule::newChainedData           },
+    { "newHasher",                Wrap_DataModule::newHasher                },
+    { "newPackFormat",            Wrap_DataModule::newPackFormat            },
+    { "newCompressionStream",     Wrap_DataModule::newCompressionStream     },
+    { "newDecompressionStream",   Wrap_DataModule::newDecompressionStream   },
+    { "newCompressionDictionary", Wrap_DataModule::newCompressionDictionary }
 };
 
 static constexpr lua_CFunction types[] =
@@ -397,7 +1215,12 @@ static constexpr lua_CFunction types[] =
     love::open_data,
     love::open_bytedata,
     love::open_dataview,
-    love::open_compresseddata
+    love::open_chaineddata,
+    love::open_compresseddata,
+    love::open_hasher,
+    love::open_packformat,
+    love::open_compressionstream,
+    love::open_compressiondictionary
 };
 // clang-format on
 
@@ -417,7 +1240,12 @@ int Wrap_DataModule::open(lua_State* L)
     module.functions = functions;
     module.types     = types;
 
-    return luax_register_module(L, module);
+    int result = luax_register_module(L, module);
+
+    love::open_json(L);
+    lua_setfield(L, -2, "json");
+
+    return result;
 }
 
 namespace love
@@ -432,4 +1260,15 @@ namespace love
 
         return containerType;
     }
+
+    ArrayKernels::ElementType luax_checkelementtype(lua_State* L, int index)
+    {
+        const char* typeString = luaL_checkstring(L, index);
+        auto type              = ArrayKernels::ELEMENT_MAX_ENUM;
+
+        if (!ArrayKernels::getConstant(typeString, type))
+            luax_enumerror(L, "element type", ArrayKernels::elementTypes, typeString);
+
+        return type;
+    }
 } // namespace love
@@ -0,0 +1,96 @@
+#include "modules/data/wrap_Hasher.hpp"
+
+#include "modules/data/wrap_ChainedData.hpp"
+#include "modules/data/wrap_Data.hpp"
+#include "modules/data/wrap_DataModule.hpp"
+
+using namespace love;
+
+int Wrap_Hasher::update(lua_State* L)
+{
+    auto* self = luax_checkhasher(L, 1);
+
+    size_t size       = 0;
+    const char* bytes = nullptr;
+
+    if (lua_isstring(L, 2))
+        bytes = luaL_checklstring(L, 2, &size);
+    else if (luax_istype(L, 2, ChainedData::type))
+    {
+        auto* chain = luax_checkchaineddata(L, 2);
+
+        luax_catchexcept(L, [&] {
+            chain->forEachSegment(
+                [&](const char* bytes, size_t size) { self->update(bytes, size); });
+        });
+
+        return 0;
+    }
+    else
+    {
+        auto* data = luax_checkdata(L, 2);
+        bytes      = (const char*)data->getData();
+        size       = data->getSize();
+    }
+
+    luax_catchexcept(L, [&] { self->update(bytes, size); });
+
+    return 0;
+}
+
+int Wrap_Hasher::finish(lua_State* L)
+{
+    auto* self         = luax_checkhasher(L, 1);
+    auto containerType = luax_checkcontainertype(L, 2);
+
+    HashFunction::Value value {};
+    luax_catchexcept(L, [&] { self->finish(value); });
+
+    if (containerType == data::CONTAINER_DATA)
+    {
+        Data* data = nullptr;
+        luax_catchexcept(L, [&] { data = new ByteData(value.data, value.size); });
+
+        luax_pushtype(L, Data::type, data);
+        data->release();
+    }
+    else
+        lua_pushlstring(L, value.data, value.size);
+
+    return 1;
+}
+
+int Wrap_Hasher::getFunction(lua_State* L)
+{
+    auto* self = luax_checkhasher(L, 1);
+
+    std::string_view name {};
+    if (!HashFunction::getConstant(self->getFunction(), name))
+        return luax_enumerror(L, "hash function", HashFunction::hashFunctions, name);
+
+    luax_pushstring(L, name);
+
+    return 1;
+}
+
+// clang-format off
+static constexpr luaL_Reg functions[] =
+{
+    { "update",      Wrap_Hasher::update      },
+    { "finish",      Wrap_Hasher::finish      },
+    { "getFunction", Wrap_Hasher::getFunction }
+};
+// clang-format on
+
+namespace love
+{
+    Hasher* luax_checkhasher(lua_State* L, int index)
+    {
+        return luax_checktype<Hasher>(L, index);
+    }
+
+    int open_hasher(lua_State* L)
+    {
+        return luax_register_type(L, &Hasher::type, functions);
+    }
+} // namespace love
@@ -0,0 +1,345 @@
+#include "common/Exception.hpp"
+#include "common/error.hpp"
+
+#include "modules/data/wrap_Json.hpp"
+
+#include "modules/data/wrap_Data.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace love;
+
+// Builds Lua values from the tokens of a document. Every object and array knows its size by now,
+// so each table is created with room for all of it.
+class JsonReader
+{
+  public:
+    JsonReader(lua_State* L, const char* json, const std::vector<Json::Token>& tokens) :
+        L(L),
+        json(json),
+        tokens(tokens),
+        next(0)
+    {}
+
+    void pushValue()
+    {
+        const auto& token = this->tokens[this->next++];
+
+        switch (this->json[token.position])
+        {
+            case '{':
+                this->checkStack();
+                lua_createtable(this->L, 0, (int)token.count);
+
+                for (uint32_t index = 0; index < token.count; index++)
+                {
+                    this->pushString(this->tokens[this->next++]);
+                    this->pushValue();
+                    lua_rawset(this->L, -3);
+                }
+
+                break;
+            case '[':
+                this->checkStack();
+                lua_createtable(this->L, (int)token.count, 0);
+
+                for (uint32_t index = 0; index < token.count; index++)
+                {
+                    this->pushValue();
+                    lua_rawseti(this->L, -2, (int)index + 1);
+                }
+
+                break;
+            case '"':
+                this->pushString(token);
+                break;
+            default:
+                this->pushScalar(token);
+                break;
+        }
+    }
+
+  private:
+    // Each level of nesting keeps its table and a key on the stack.
+    void checkStack()
+    {
+        if (!lua_checkstack(this->L, 3))
+            throw love::Exception(E_JSON_TOO_DEEP, Json::MAX_DEPTH);
+    }
+
+    void pushString(const Json::Token& token)
+    {
+        auto string = Json::parseString(this->json, token, this->scratch);
+        lua_pushlstring(this->L, string.data(), string.size());
+    }
+
+    void pushScalar(const Json::Token& token)
+    {
+        double number = 0.0;
+
+        switch (Json::parseScalar(this->json, token, number))
+        {
+            case Json::SCALAR_FALSE:
+                lua_pushboolean(this->L, 0);
+                break;
+            case Json::SCALAR_TRUE:
+                lua_pushboolean(this->L, 1);
+                break;
+            case Json::SCALAR_NUMBER:
+                lua_pushnumber(this->L, number);
+                break;
+            case Json::SCALAR_NULL:
+            default:
+                lua_pushnil(this->L);
+                break;
+        }
+    }
+
+    lua_State* L;
+    const char* json;
+
+    const std::vector<Json::Token>& tokens;
+    size_t next;
+
+    std::string scratch;
+};
+
+// Tables whose keys are all integers from 1 to #t become arrays, with null for any nil in
+// between, and empty tables become empty arrays. Every other table becomes an object.
+class JsonWriter
+{
+  public:
+    JsonWriter(lua_State* L, bool pretty, std::string& output) :
+        L(L),
+        pretty(pretty),
+        output(output)
+    {}
+
+    void writeValue(int index, int depth)
+    {
+        size_t length      = 0;
+        const char* string = nullptr;
+
+        switch (lua_type(this->L, index))
+        {
+            case LUA_TNIL:
+                this->output.append("null");
+                break;
+            case LUA_TBOOLEAN:
+                this->output.append(lua_toboolean(this->L, index) ? "true" : "false");
+                break;
+            case LUA_TNUMBER:
+                if (!Json::writeNumber(this->output, lua_tonumber(this->L, index)))
+                    throw love::Exception(E_JSON_INVALID_NUMBER);
+
+                break;
+            case LUA_TSTRING:
+                string = lua_tolstring(this->L, index, &length);
+                Json::writeString(this->output, string, length);
+                break;
+            case LUA_TTABLE:
+                this->writeTable(index, depth);
+                break;
+            default:
+            {
+                const char* name = lua_typename(this->L, lua_type(this->L, index));
+                throw love::Exception(E_JSON_UNSUPPORTED_TYPE, name);
+            }
+        }
+    }
+
+  private:
+    void writeTable(int index, int depth)
+    {
+        const void* pointer = lua_topointer(this->L, index);
+
+        if (std::find(this->visiting.begin(), this->visiting.end(), pointer) !=
+            this->visiting.end())
+        {
+            throw love::Exception(E_TABLE_CYCLE, "encoded as JSON");
+        }
+
+        if (depth >= Json::MAX_DEPTH || !lua_checkstack(this->L, 3))
+            throw love::Exception(E_JSON_TOO_DEEP, Json::MAX_DEPTH);
+
+        this->visiting.push_back(pointer);
+
+        size_t length = lua_objlen(this->L, index);
+
+        if (this->isArray(index, length))
+            this->writeArray(index, length, depth);
+        else
+            this->writeObject(index, depth);
+
+        this->visiting.pop_back();
+    }
+
+    bool isArray(int index, size_t length)
+    {
+        lua_pushnil(this->L);
+
+        while (lua_next(this->L, index))
+        {
+            lua_pop(this->L, 1);
+
+            double key = lua_type(this->L, -1) == LUA_TNUMBER ? lua_tonumber(this->L, -1) : 0.0;
+
+            if (!(key >= 1 && key <= (double)length) || key != (double)(size_t)key)
+            {
+                lua_pop(this->L, 1);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void writeArray(int index, size_t length, int depth)
+    {
+        this->output.push_back('[');
+
+        for (size_t element = 1; element <= length; element++)
+        {
+            if (element > 1)
+                this->output.push_back(',');
+
+            this->writeIndent(depth + 1);
+
+            lua_rawgeti(this->L, index, (int)element);
+            this->writeValue(lua_gettop(this->L), depth + 1);
+            lua_pop(this->L, 1);
+        }
+
+        if (length > 0)
+            this->writeIndent(depth);
+
+        this->output.push_back(']');
+    }
+
+    void writeObject(int index, int depth)
+    {
+        bool first = true;
+
+        this->output.push_back('{');
+        lua_pushnil(this->L);
+
+        while (lua_next(this->L, index))
+        {
+            if (!first)
+                this->output.push_back(',');
+
+            first = false;
+            this->writeIndent(depth + 1);
+
+            // Converting a number key to a string in place would confuse lua_next.
+            if (lua_type(this->L, -2) == LUA_TSTRING)
+            {
+                size_t length   = 0;
+                const char* key = lua_tolstring(this->L, -2, &length);
+
+                Json::writeString(this->output, key, length);
+            }
+            else if (lua_type(this->L, -2) == LUA_TNUMBER)
+            {
+                this->output.push_back('"');
+
+                if (!Json::writeNumber(this->output, lua_tonumber(this->L, -2)))
+                    throw love::Exception(E_JSON_INVALID_NUMBER);
+
+                this->output.push_back('"');
+            }
+            else
+                throw love::Exception(E_JSON_INVALID_KEY);
+
+            this->output.append(this->pretty ? ": " : ":");
+
+            this->writeValue(lua_gettop(this->L), depth + 1);
+            lua_pop(this->L, 1);
+        }
+
+        if (!first)
+            this->writeIndent(depth);
+
+        this->output.push_back('}');
+    }
+
+    void writeIndent(int depth)
+    {
+        if (!this->pretty)
+            return;
+
+        this->output.push_back('\n');
+        this->output.append(depth * 2, ' ');
+    }
+
+    lua_State* L;
+    bool pretty;
+
+    std::string& output;
+    std::vector<const void*> visiting;
+};
+
+int Wrap_Json::decode(lua_State* L)
+{
+    const char* json = nullptr;
+    size_t size      = 0;
+
+    if (luax_istype(L, 1, Data::type))
+    {
+        auto* data = luax_checkdata(L, 1);
+        json       = (const char*)data->getData();
+        size       = data->getSize();
+    }
+    else
+        json = luaL_checklstring(L, 1, &size);
+
+    std::vector<Json::Token> tokens;
+
+    luax_catchexcept(L, [&] {
+        Json::tokenize(json, size, tokens);
+
+        JsonReader reader(L, json, tokens);
+        reader.pushValue();
+    });
+
+    return 1;
+}
+
+int Wrap_Json::encode(lua_State* L)
+{
+    luaL_checkany(L, 1);
+    bool pretty = luax_optboolean(L, 2, false);
+
+    std::string output;
+
+    luax_catchexcept(L, [&] {
+        JsonWriter writer(L, pretty, output);
+        writer.writeValue(1, 0);
+    });
+
+    lua_pushlstring(L, output.data(), output.size());
+
+    return 1;
+}
+
+// clang-format off
+static constexpr luaL_Reg functions[] =
+{
+    { "decode", Wrap_Json::decode },
+    { "encode", Wrap_Json::encode }
+};
+// clang-format on
+
+namespace love
+{
+    int open_json(lua_State* L)
+    {
+        lua_createtable(L, 0, (int)std::size(functions));
+        luax_register_type_inner(L, functions);
+
+        return 1;
+    }
+} // namespace love
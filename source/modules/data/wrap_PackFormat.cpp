@@ -0,0 +1,358 @@
+#include "common/error.hpp"
+
+#include "modules/data/wrap_PackFormat.hpp"
+
+#include "modules/data/wrap_ByteData.hpp"
+#include "modules/data/wrap_Data.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace love;
+
+static void checkInteger(lua_State* L, int index, const PackFormat::Field& field)
+{
+    bool isSigned = field.type == PackFormat::FIELD_INT;
+    double value  = std::trunc(luaL_checknumber(L, index));
+
+    // Fields of 8 bytes or more take anything that fits in 64 bits.
+    int bits     = (int)std::min<size_t>(field.size * 8, 64);
+    double limit = std::ldexp(1.0, isSigned ? bits - 1 : bits);
+
+    if (isSigned && !(value >= -limit && value < limit))
+        luaL_argerror(L, index, "integer overflow");
+    else if (!isSigned && !(value >= 0 && value < limit))
+        luaL_argerror(L, index, "unsigned overflow");
+}
+
+// Checks every argument of the record at `index` and returns the record's size, so that a bad
+// argument raises its error before anything is written.
+static size_t checkRecord(lua_State* L, PackFormat* format, int index)
+{
+    size_t position = 0;
+
+    for (const auto& field : format->getFields())
+    {
+        position += PackFormat::getPadding(position, field.align) + field.size;
+
+        size_t length      = 0;
+        const char* string = nullptr;
+
+        switch (field.type)
+        {
+            case PackFormat::FIELD_INT:
+            case PackFormat::FIELD_UINT:
+                checkInteger(L, index, field);
+                break;
+            case PackFormat::FIELD_FLOAT:
+                luaL_checknumber(L, index);
+                break;
+            case PackFormat::FIELD_CHARS:
+                luaL_checklstring(L, index, &length);
+
+                if (length > field.size)
+                    luaL_argerror(L, index, "string longer than given size");
+
+                break;
+            case PackFormat::FIELD_STRING:
+                luaL_checklstring(L, index, &length);
+
+                if (field.size < sizeof(size_t) && (length >> (field.size * 8)) != 0)
+                    luaL_argerror(L, index, "string length does not fit in given size");
+
+                position += length;
+                break;
+            case PackFormat::FIELD_ZSTRING:
+                string = luaL_checklstring(L, index, &length);
+
+                if (std::memchr(string, '\0', length) != nullptr)
+                    luaL_argerror(L, index, "string contains zeros");
+
+                position += length + 1;
+                break;
+            case PackFormat::FIELD_PADDING:
+            default:
+                continue;
+        }
+
+        index++;
+    }
+
+    return position;
+}
+
+// Packs one record at `record` from arguments checkRecord accepted. The caller made sure there
+// is room for it. Returns its size.
+static size_t packRecord(lua_State* L, PackFormat* format, int index, char* record)
+{
+    size_t position = 0;
+
+    for (const auto& field : format->getFields())
+    {
+        size_t padding = PackFormat::getPadding(position, field.align);
+        std::memset(record + position, 0, padding);
+
+        position += padding;
+        char* destination = record + position;
+
+        size_t length      = 0;
+        const char* string = nullptr;
+
+        switch (field.type)
+        {
+            case PackFormat::FIELD_INT:
+            case PackFormat::FIELD_UINT:
+            {
+                double value   = std::trunc(lua_tonumber(L, index++));
+                uint64_t bytes = field.type == PackFormat::FIELD_INT ? (uint64_t)(int64_t)value
+                                                                     : (uint64_t)value;
+
+                PackFormat::packInteger(destination, bytes, value < 0, field.size, field.little);
+                break;
+            }
+            case PackFormat::FIELD_FLOAT:
+                PackFormat::packFloat(destination, lua_tonumber(L, index++), field.size,
+                                      field.little);
+                break;
+            case PackFormat::FIELD_CHARS:
+                string = lua_tolstring(L, index++, &length);
+
+                std::memcpy(destination, string, length);
+                std::memset(destination + length, 0, field.size - length);
+                break;
+            case PackFormat::FIELD_STRING:
+                string = lua_tolstring(L, index++, &length);
+
+                PackFormat::packInteger(destination, length, false, field.size, field.little);
+                std::memcpy(destination + field.size, string, length);
+
+                position += length;
+                break;
+            case PackFormat::FIELD_ZSTRING:
+                string = lua_tolstring(L, index++, &length);
+                std::memcpy(destination, string, length + 1);
+
+                position += length + 1;
+                break;
+            case PackFormat::FIELD_PADDING:
+            default:
+                std::memset(destination, 0, field.size);
+                break;
+        }
+
+        position += field.size;
+    }
+
+    return position;
+}
+
+int Wrap_PackFormat::pack(lua_State* L)
+{
+    auto* self         = luax_checkpackformat(L, 1);
+    auto* byteData     = luax_checkbytedata(L, 2);
+    lua_Integer offset = luaL_checkinteger(L, 3);
+
+    size_t size     = checkRecord(L, self, 4);
+    size_t dataSize = byteData->getSize();
+
+    if (offset < 0 || (size_t)offset > dataSize || size > dataSize - (size_t)offset)
+        return luaL_error(L, E_DATA_PACK_OFFSET_FORMAT_PARAMS);
+
+    size_t written = packRecord(L, self, 4, (char*)byteData->getData() + offset);
+    lua_pushinteger(L, (lua_Integer)(offset + written));
+
+    return 1;
+}
+
+// Pushes the values of the record at `offset`, storing each in the table at `table` instead when
+// it is not 0. Returns the offset just past the record.
+static size_t unpackRecord(lua_State* L, PackFormat* format, const char* data, size_t size,
+                           size_t offset, int table)
+{
+    size_t position = offset;
+    int count       = 0;
+
+    for (const auto& field : format->getFields())
+    {
+        position += PackFormat::getPadding(position - offset, field.align);
+
+        if (position > size || field.size > size - position)
+            luaL_error(L, E_UNPACK_DATA_TOO_SHORT);
+
+        const char* source = data + position;
+        position += field.size;
+
+        switch (field.type)
+        {
+            case PackFormat::FIELD_INT:
+            case PackFormat::FIELD_UINT:
+            {
+                bool isSigned  = field.type == PackFormat::FIELD_INT;
+                uint64_t value = 0;
+
+                if (!PackFormat::unpackInteger(source, field.size, field.little, isSigned, value))
+                    luaL_error(L, E_UNPACK_INTEGER_TOO_LARGE, (int)field.size);
+
+                lua_pushnumber(L, isSigned ? (lua_Number)(int64_t)value : (lua_Number)value);
+                break;
+            }
+            case PackFormat::FIELD_FLOAT:
+                lua_pushnumber(L, PackFormat::unpackFloat(source, field.size, field.little));
+                break;
+            case PackFormat::FIELD_CHARS:
+                lua_pushlstring(L, source, field.size);
+                break;
+            case PackFormat::FIELD_STRING:
+            {
+                uint64_t length = 0;
+
+                if (!PackFormat::unpackInteger(source, field.size, field.little, false, length) ||
+                    length > size - position)
+                {
+                    luaL_error(L, E_UNPACK_DATA_TOO_SHORT);
+                }
+
+                lua_pushlstring(L, data + position, (size_t)length);
+                position += (size_t)length;
+                break;
+            }
+            case PackFormat::FIELD_ZSTRING:
+            {
+                const void* end = std::memchr(source, '\0', size - position);
+
+                if (end == nullptr)
+                    luaL_error(L, E_UNPACK_DATA_TOO_SHORT);
+
+                size_t length = (const char*)end - source;
+                lua_pushlstring(L, source, length);
+
+                position += length + 1;
+                break;
+            }
+            case PackFormat::FIELD_PADDING:
+            default:
+                continue;
+        }
+
+        if (table != 0)
+            lua_rawseti(L, table, ++count);
+    }
+
+    return position;
+}
+
+static const char* checkSource(lua_State* L, int index, size_t& size)
+{
+    if (lua_type(L, index) == LUA_TSTRING)
+        return lua_tolstring(L, index, &size);
+
+    auto* data = luax_checkdata(L, index);
+    size       = data->getSize();
+
+    return (const char*)data->getData();
+}
+
+static size_t checkOffset(lua_State* L, int index, size_t size)
+{
+    lua_Integer offset = luaL_optinteger(L, index, 0);
+
+    if (offset < 0 || (size_t)offset > size)
+        luaL_error(L, E_UNPACK_DATA_TOO_SHORT);
+
+    return (size_t)offset;
+}
+
+int Wrap_PackFormat::unpack(lua_State* L)
+{
+    auto* self         = luax_checkpackformat(L, 1);
+    size_t size        = 0;
+    const char* source = checkSource(L, 2, size);
+    size_t offset      = checkOffset(L, 3, size);
+
+    int count = (int)self->getValueCount();
+    luaL_checkstack(L, count + 1, "too many results");
+
+    size_t next = unpackRecord(L, self, source, size, offset, 0);
+    lua_pushinteger(L, (lua_Integer)next);
+
+    return count + 1;
+}
+
+int Wrap_PackFormat::unpackMany(lua_State* L)
+{
+    auto* self         = luax_checkpackformat(L, 1);
+    size_t size        = 0;
+    const char* source = checkSource(L, 2, size);
+    size_t offset      = checkOffset(L, 3, size);
+    lua_Integer count  = luaL_checkinteger(L, 4);
+
+    if (count <= 0)
+        return luaL_error(L, E_INVALID_COUNT_PARAMETER);
+
+    // Checks fixed-size records before any is unpacked. Records with strings take at least a
+    // byte, and empty records are counted as one, which keeps a bad count from allocating a huge
+    // table.
+    size_t recordSize = self->isFixedSize() ? std::max<size_t>(self->getSize(), 1) : 1;
+
+    if ((size_t)count > (size - offset) / recordSize)
+        return luaL_error(L, E_UNPACK_DATA_TOO_SHORT);
+
+    int valueCount = (int)self->getValueCount();
+    lua_createtable(L, (int)count, 0);
+
+    for (lua_Integer index = 1; index <= count; index++)
+    {
+        lua_createtable(L, valueCount, 0);
+        offset = unpackRecord(L, self, source, size, offset, lua_gettop(L));
+        lua_rawseti(L, -2, (int)index);
+    }
+
+    lua_pushinteger(L, (lua_Integer)offset);
+
+    return 2;
+}
+
+int Wrap_PackFormat::getSize(lua_State* L)
+{
+    auto* self = luax_checkpackformat(L, 1);
+
+    if (self->isFixedSize())
+        lua_pushinteger(L, (lua_Integer)self->getSize());
+    else
+        lua_pushnil(L);
+
+    return 1;
+}
+
+int Wrap_PackFormat::getFormat(lua_State* L)
+{
+    auto* self = luax_checkpackformat(L, 1);
+    luax_pushstring(L, self->getFormat());
+
+    return 1;
+}
+
+// clang-format off
+static constexpr luaL_Reg functions[] =
+{
+    { "pack",       Wrap_PackFormat::pack       },
+    { "unpack",     Wrap_PackFormat::unpack     },
+    { "unpackMany", Wrap_PackFormat::unpackMany },
+    { "getSize",    Wrap_PackFormat::getSize    },
+    { "getFormat",  Wrap_PackFormat::getFormat  }
+};
+// clang-format on
+
+namespace love
+{
+    PackFormat* luax_checkpackformat(lua_State* L, int index)
+    {
+        return luax_checktype<PackFormat>(L, index);
+    }
+
+    int open_packformat(lua_State* L)
+    {
+        return luax_register_type(L, &PackFormat::type, functions);
+    }
+} // namespace love
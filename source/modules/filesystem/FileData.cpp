@@ -1,3 +1,5 @@
+#include "common/Allocator.hpp"
+
 #include "modules/filesystem/FileData.hpp"
 
 #include <algorithm>
@@ -6,21 +8,14 @@
 
 namespace love
 {
-    Type FileData::type("FileData", &Data::type);
+    Type FileData::type("FileData", Type::ID_FILE_DATA);
 
     FileData::FileData(uint64_t size, std::string_view filename) :
         data(nullptr),
         size(size),
         filename(filename)
     {
-        try
-        {
-            this->data = new char[(size_t)size];
-        }
-        catch (std::bad_alloc&)
-        {
-            throw love::Exception(E_OUT_OF_MEMORY);
-        }
+        this->data = (char*)Allocator::allocate((size_t)size);
 
         const auto path = std::filesystem::path(filename);
 
@@ -40,21 +35,14 @@ namespace love
         extension(other.extension),
         name(other.name)
     {
-        try
-        {
-            this->data = new char[(size_t)this->size];
-        }
-        catch (std::bad_alloc&)
-        {
-            throw love::Exception(E_OUT_OF_MEMORY);
-        }
+        this->data = (char*)Allocator::allocate((size_t)this->size);
 
         std::copy_n((char*)other.data, this->size, (char*)this->data);
     }
 
     FileData::~FileData()
     {
-        delete[] this->data;
+        Allocator::deallocate(this->data, (size_t)this->size);
     }
 
     FileData* FileData::clone() const
@@ -4,6 +4,7 @@
 #include "common/Exception.hpp"
 #include "common/int.hpp"
 
+#include "modules/data/ChainedData.hpp"
 #include "modules/data/wrap_DataModule.hpp"
 
 #include <utility/logfile.hpp>
@@ -133,6 +134,30 @@ int Wrap_File::write(lua_State* L)
             return luax_ioerror(L, "%s", e.what());
         }
     }
+    else if (luax_istype(L, 2, ChainedData::type))
+    {
+        try
+        {
+            auto* chain       = luax_totype<ChainedData>(L, 2);
+            int64_t remaining = luaL_optinteger(L, 3, chain->getSize());
+
+            // Writes the segments in place rather than flattening the chain first.
+            result = true;
+            chain->forEachSegment([&](const char* bytes, size_t size) {
+                int64_t count = std::min(remaining, (int64_t)size);
+
+                if (result && count > 0)
+                {
+                    result = self->write(bytes, count);
+                    remaining -= count;
+                }
+            });
+        }
+        catch (love::Exception& e)
+        {
+            return luax_ioerror(L, "%s", e.what());
+        }
+    }
     else if (luax_istype(L, 2, Data::type))
     {
         try